@@ -34,7 +34,7 @@
 
 const char* MOD_SOURCES = "none|LFO1|LFO2|ADSR1|ADSR2|ModWheel";
 const char* MOD_TARGETS = "none|Bandwidth|Damp|Harmonics|Scale|Volume|Frequency|Panning|Detune|Spread|Drive|Noise|LP Cutoff|LP Resonance|HP Cutoff|HP Resonance|BP Cutoff|BP Q|NT Cutoff|NT Q|ADSR1 Decay|ADSR2 Decay|Mod1|Mod2|Mod3|Mod4|Mod5|Mod6|Mod7|Mod8|LFO1 Depth|LFO2 Depth";
-const char* FX_SECTIONS = "none|Distortion|Delay|Chorus|Flanger|Reverb|Formant|EQ";
+const char* FX_SECTIONS = "none|Distortion|Delay|Chorus|Flanger|Reverb|Formant|EQ|FDN Reverb";
 
 
 const Colour COL_WINDOW_BG                  = Colour::fromRGB(40, 40, 40);
@@ -89,22 +89,24 @@ void eTfGroupComponent::paint (Graphics& g)
 //==============================================================================
 eTfFreqView::eTfFreqView() :
     m_synth(nullptr),
-    m_instr(nullptr), 
     m_processor(nullptr)
 {
-    m_voice = new eTfVoice(eFALSE);
+    m_instr = new eTfInstrument;
+    eTfInstrumentInit(*m_instr);
+    m_voice = new eTfVoice;
 }
 
 eTfFreqView::~eTfFreqView()
 {
+    eTfInstrumentFree(*m_instr);
+    eDelete(m_instr);
     eDelete(m_voice);
 }
 
-void eTfFreqView::setSynth(Tunefish4AudioProcessor *processor, eTfSynth *synth, eTfInstrument *instr)
+void eTfFreqView::setSynth(Tunefish4AudioProcessor *processor, eTfSynth *synth)
 {
     m_processor = processor;
     m_synth = synth;
-    m_instr = instr;
 }
 
 void eTfFreqView::paint (Graphics& g)
@@ -120,31 +122,40 @@ void eTfFreqView::paint (Graphics& g)
     g.setGradientFill (ColourGradient (COL_FREQVIEW_BG_GRADIENT1, 0, static_cast<float>(getHeight())/2.0f, COL_FREQVIEW_BG_GRADIENT2, static_cast<float>(getWidth()), static_cast<float>(getHeight()), false));
     g.fillRect(0, getHeight()/2, getWidth(), getHeight()/2);
 
-    if (m_synth != nullptr && m_instr != nullptr)
+    if (m_synth != nullptr && m_processor != nullptr)
     {
         g.setColour(Colours::white);
 
-        // lock the synth and copy the current voice data
+        // the parameters come from the processor's atomics, the
+        // audio thread writes its instrument's ones while we paint
         // -----------------------------------------------------------
-        m_processor->getSynthCriticalSection().enter();
+        eF32 params[TF_PARAM_COUNT];
 
-        if (m_instr->latestTriggeredVoice) {
-            eTfVoice *voice = m_instr->latestTriggeredVoice;
-            m_voice->modMatrix = voice->modMatrix;
-            m_voice->generator.modulation = voice->generator.modulation;
+        for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+            params[i] = m_processor->getParameter(i);
+
+        eMemCopy(m_instr->params, params, sizeof(params));
+        eTfInstrumentParamsChanged(*m_instr);
+
+        // copy the voice data the audio thread published last
+        // -----------------------------------------------------------
+        const eTfVoiceSnapshot &snapshot = m_processor->getVoiceSnapshot();
+
+        if (snapshot.valid) {
+            m_voice->modMatrix = snapshot.modMatrix;
+            m_voice->generator.modulation = snapshot.modulation;
         }
-        
-        m_processor->getSynthCriticalSection().exit();
 
         // calculate the waveform
         // -----------------------------------------------------------
         eTfVoiceReset(*m_voice);
-        eTfGeneratorUpdate(*m_synth, *m_instr, *m_voice, m_voice->generator, 1.0f);
-        eF32 *freqTable = m_voice->generator.freqTable;
+        eTfGeneratorUpdate(*m_instr, *m_voice, m_voice->generator);
+        eF32 modTable[TF_IFFT_FRAMESIZE*2];
+        const eF32 *freqTable = eTfGeneratorSpectrum(*m_synth, m_voice->generator);
 
-        if (eTfGeneratorModulate(*m_synth, *m_instr, m_voice->generator)) 
+        if (eTfGeneratorModulate(*m_synth, *m_instr, m_voice->generator, freqTable, modTable)) 
         {
-            freqTable = m_voice->generator.freqModTable;
+            freqTable = modTable;
         }
 
         eF32 next_sep = 0.1f;
@@ -172,10 +183,10 @@ void eTfFreqView::paint (Graphics& g)
             g.drawLine(fx, halfViewHeight, fx, halfViewHeight - (value * halfViewHeight));
         }
 
-        eTfGeneratorFft(IFFT, TF_IFFT_FRAMESIZE, freqTable);
-        eTfGeneratorNormalize(freqTable, TF_IFFT_FRAMESIZE);
+        eF32 *resultTable = m_voice->generator.resultTable;
+        eTfGeneratorIfft(m_synth->ifftPlan, freqTable, resultTable, 0.0f);
 
-        eF32 drive = m_instr->params[TF_GEN_DRIVE];
+        eF32 drive = params[TF_GEN_DRIVE];
         drive *= 32.0f;
         drive += 1.0f;
 
@@ -187,7 +198,7 @@ void eTfFreqView::paint (Graphics& g)
             eF32 pos = fx / viewWidth;
 
             eU32 offset = static_cast<eU32>(pos * TF_IFFT_FRAMESIZE);
-            eF32 value = freqTable[offset*2];
+            eF32 value = resultTable[offset];
             eF32 valueDrv = value * drive;
 
             value = eClamp<eF32>(-1.0f, value, 1.0f);
@@ -347,7 +358,7 @@ Tunefish4AudioProcessorEditor::Tunefish4AudioProcessorEditor (Tunefish4AudioProc
     m_grpGenerator.addChildComponent(&m_freqView);
     m_freqView.setVisible(true);
     m_freqView.setBounds(10, 140, 570, 210);
-    m_freqView.setSynth(ownerFilter, synth, synth->instr[0]);
+    m_freqView.setSynth(ownerFilter, synth);
 
     // -------------------------------------
     //  FILTER GROUPS
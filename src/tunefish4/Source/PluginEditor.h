@@ -39,11 +39,11 @@ public:
     ~eTfFreqView();
 
     void paint (Graphics& g);
-    void setSynth(Tunefish4AudioProcessor *processor, eTfSynth *synth, eTfInstrument *instr);
+    void setSynth(Tunefish4AudioProcessor *processor, eTfSynth *synth);
 
 private:
     eTfSynth *                  m_synth;
-    eTfInstrument *             m_instr;
+    eTfInstrument *             m_instr;    // the view's own, the audio thread's one isn't read here
     eTfVoice *                  m_voice;
     Tunefish4AudioProcessor *   m_processor;
 };
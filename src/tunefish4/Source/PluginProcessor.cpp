@@ -47,9 +47,7 @@ Tunefish4AudioProcessor::Tunefish4AudioProcessor() :
     tf(nullptr),
     synth(nullptr),
     paramDirtyAny(false),
-    currentProgramIndex(0),
-    adapterWriteOffset(0),
-    adapterDataAvailable(0)
+    currentProgramIndex(0)
 {
     meterLevels[0] = 0;
     meterLevels[1] = 0;
@@ -57,11 +55,9 @@ Tunefish4AudioProcessor::Tunefish4AudioProcessor() :
     
     pluginLocation = File::getSpecialLocation(File::currentApplicationFile).getParentDirectory().getFullPathName();
 
-    adapterBuffer[0] = new eF32[TF_BUFFERSIZE];
-    adapterBuffer[1] = new eF32[TF_BUFFERSIZE];
-
     synth = new eTfSynth();
     eTfSynthInit(*synth);
+    eTfSynthStartSpectrumWorker(*synth);
     synth->sampleRate = 44100;
 
     synth->instr[0] = tf = new eTfInstrument();
@@ -71,7 +67,8 @@ Tunefish4AudioProcessor::Tunefish4AudioProcessor() :
         programs[i].loadFactory(i);
 
     loadProgramAll();
-    programs[0].applyToSynth(tf);
+    publishProgram(programs[0]);
+    applyParameterChanges();
     resetParamDirty(eTRUE);
 
     recorderIndex = eTfRecorder::getInstance().addSynth(this);
@@ -81,9 +78,8 @@ Tunefish4AudioProcessor::~Tunefish4AudioProcessor()
 {
     eTfRecorder::getInstance().removeSynth(this);
 
-    eDelete(adapterBuffer[0]);
-    eDelete(adapterBuffer[1]);
     eTfInstrumentFree(*tf);
+    eTfSynthStopSpectrumWorker(*synth);
     eDelete(tf);
     eDelete(synth);
 }
@@ -101,14 +97,14 @@ int Tunefish4AudioProcessor::getNumParameters()
 
 float Tunefish4AudioProcessor::getParameterMod(int index)
 {
-    eTfVoice *voice = tf->latestTriggeredVoice;
-    if (!voice)
+    eTfVoiceSnapshot &voice = getVoiceSnapshot();
+    if (!voice.valid)
         return 0.0f;
 
-    if (!voice->playing)
+    if (!voice.playing)
         return 0.0f;
 
-    eF32 value = eTfModMatrixGet(voice->modMatrix, static_cast<eTfModMatrix::Output>(index));
+    eF32 value = eTfModMatrixGet(voice.modMatrix, static_cast<eTfModMatrix::Output>(index));
     if (value == 1.0f)
         return 0.0f;
 
@@ -118,13 +114,17 @@ float Tunefish4AudioProcessor::getParameterMod(int index)
 float Tunefish4AudioProcessor::getParameter (int index)
 {
     eASSERT(index >= 0 && index < TF_PARAM_COUNT);
-    return tf->params[index];
+    return paramValues[index].get();
 }
 
+// may be called from any thread, the audio thread takes the value
+// over at the start of its next block
 void Tunefish4AudioProcessor::setParameter (int index, float newValue)
 {
     eASSERT(index >= 0 && index < TF_PARAM_COUNT);
-    tf->params[index] = newValue;
+    paramValues[index].set(newValue);
+    paramPending[index].set(1);
+    paramsPending.set(1);
     paramDirty[index] = eTRUE;
     paramDirtyAny = eTRUE;
 }
@@ -181,13 +181,13 @@ void Tunefish4AudioProcessor::setCurrentProgram (int index)
     eASSERT(index >= 0 && index < TF_PLUG_NUM_PROGRAMS);
 
     // write program from tunefish to program list before switching
-    programs[currentProgramIndex].loadFromSynth(tf);
+    storeProgram(programs[currentProgramIndex]);
 
     currentProgramIndex = index;
     resetParamDirty(eTRUE);
 
     // load new program to into tunefish
-    programs[currentProgramIndex].applyToSynth(tf);
+    publishProgram(programs[currentProgramIndex]);
 
     updateHostDisplay();
 }
@@ -214,9 +214,78 @@ eTfSynth* Tunefish4AudioProcessor::getSynth() const
     return synth;
 }
 
-CriticalSection & Tunefish4AudioProcessor::getSynthCriticalSection()
+// only to be called on the message thread
+eTfVoiceSnapshot & Tunefish4AudioProcessor::getVoiceSnapshot()
+{
+    voiceSnapshots.update();
+    return voiceSnapshots.getRead();
+}
+
+// message thread only. the audio thread switches to the whole
+// program at once at the start of its next block
+void Tunefish4AudioProcessor::publishProgram(const eTfSynthProgram &program)
 {
-    return csSynth;
+    eTfProgramParams &next = programSwap.getWrite();
+
+    for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+    {
+        next.params[i] = program.getParam(i);
+        paramValues[i].set(next.params[i]);
+    }
+
+    programSwap.publish();
+}
+
+void Tunefish4AudioProcessor::storeProgram(eTfSynthProgram &program) const
+{
+    for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+        program.setParam(i, paramValues[i].get());
+}
+
+// audio thread, a program switch goes first so single parameters set
+// after it aren't lost
+void Tunefish4AudioProcessor::applyParameterChanges()
+{
+    eBool changed = eFALSE;
+
+    if (programSwap.update())
+    {
+        eMemCopy(tf->params, programSwap.getRead().params, sizeof(tf->params));
+        changed = eTRUE;
+    }
+
+    if (paramsPending.exchange(0))
+    {
+        for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+        {
+            if (paramPending[i].exchange(0))
+            {
+                tf->params[i] = paramValues[i].get();
+                changed = eTRUE;
+            }
+        }
+    }
+
+    if (changed)
+        eTfInstrumentParamsChanged(*tf);
+}
+
+// audio thread, lets the editor show the modulation of the last voice
+void Tunefish4AudioProcessor::publishVoiceSnapshot()
+{
+    eTfVoiceSnapshot &snapshot = voiceSnapshots.getWrite();
+    const eTfVoice *voice = tf->latestTriggeredVoice;
+
+    snapshot.valid = (voice != nullptr);
+
+    if (voice)
+    {
+        snapshot.playing = voice->playing;
+        snapshot.modMatrix = voice->modMatrix;
+        snapshot.modulation = voice->generator.modulation;
+    }
+
+    voiceSnapshots.publish();
 }
 
 void Tunefish4AudioProcessor::setMetering (bool on)
@@ -253,58 +322,44 @@ void Tunefish4AudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffe
 {
     keyboardState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(), true);
 
-    MidiBuffer::Iterator it(midiMessages);
-    MidiMessage midiMessage;
-    eU32 messageOffset = 0;
-
     eU32 requestedLen = buffer.getNumSamples();
 
     eU32 sampleRate = static_cast<eU32>(getSampleRate());
     if (sampleRate > 0)
         synth->sampleRate = sampleRate;
 
+    applyParameterChanges();
+
     for (int i = 0; i < getTotalNumOutputChannels(); ++i)
     {
         buffer.clear(i, 0, buffer.getNumSamples());
     }
 
-    if (buffer.getNumChannels() == 2)
-    {
-        eU32 len = requestedLen;
-        eF32 **signal = buffer.getArrayOfWritePointers();
-        eF32 *destL = signal[0];
-        eF32 *destR = signal[1];
+    // transport is fetched once per block, the host may not provide one
+    AudioPlayHead::CurrentPositionInfo cpi;
+    cpi.resetToDefault();
+    if (AudioPlayHead *playHead = getPlayHead())
+        playHead->getCurrentPosition(cpi);
+    eTfRecorder::getInstance().setTempo(static_cast<eU16>(cpi.bpm));
 
-        while(len)
-        {
-            if (!adapterDataAvailable)
-            {
-                csSynth.enter();
-                eMemSet(adapterBuffer[0], 0, TF_BUFFERSIZE * sizeof(eF32));
-                eMemSet(adapterBuffer[1], 0, TF_BUFFERSIZE * sizeof(eF32));
-                processEvents(midiMessages, messageOffset, TF_BUFFERSIZE);
-                eTfInstrumentProcess(*synth, *tf, adapterBuffer, TF_BUFFERSIZE);
-                messageOffset += TF_BUFFERSIZE;
-                adapterDataAvailable = TF_BUFFERSIZE;
-                csSynth.exit();
-            }
-
-            eF32 *srcL = &adapterBuffer[0][TF_BUFFERSIZE - adapterDataAvailable];
-            eF32 *srcR = &adapterBuffer[1][TF_BUFFERSIZE - adapterDataAvailable];
-
-            while (len && adapterDataAvailable)
-            {
-                *destL++ += *srcL++;
-                *destR++ += *srcR++;
+    // the instrument renders straight into the host's buffer and walks
+    // the parsed events with a cursor, so there's no added latency
+    eU32 eventCount = parseMidi(midiMessages, cpi);
 
-                len--;
-                adapterDataAvailable--;
-            }
-        }
+    if (buffer.getNumChannels() == 2)
+    {
+        eTfInstrumentProcess(*synth, *tf, buffer.getArrayOfWritePointers(), requestedLen, events, eventCount);
+    }
+    else
+    {
+        for (eU32 i=0; i<eventCount; i++)
+            eTfInstrumentApplyEvent(*tf, events[i]);
     }
 
-    processEvents(midiMessages, messageOffset, requestedLen);
+    applyMidiOverflow(midiMessages, eventCount);
+
     midiMessages.clear();
+    publishVoiceSnapshot();
     
     // Master Volume & Pan, Metering
     if (buffer.getNumChannels() == 2)
@@ -317,81 +372,112 @@ void Tunefish4AudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffe
     }
 }
 
-void Tunefish4AudioProcessor::processEvents(MidiBuffer &midiMessages, eU32 messageOffset, eU32 frameSize)
+// converts a raw midi message, messages the instrument
+// doesn't use return false
+static bool midiToEvent(const MidiMessageMetadata &metadata, eTfInstrumentEvent &event)
 {
-    MidiBuffer::Iterator it(midiMessages);
-    MidiMessage midiMessage;
-    int samplePosition;
+    if (metadata.numBytes < 3)
+        return false;
 
-    // get the samplerate
-    eF32 sampleRate = static_cast<eF32>(getSampleRate());
+    const uint8 *data = metadata.data;
+    eU8 status = data[0] & 0xf0;
 
-    // get the current tempo
-    juce::AudioPlayHead::CurrentPositionInfo cpi;
-    getPlayHead()->getCurrentPosition(cpi);
-    eU32 tempo = static_cast<eU32>(cpi.bpm);
-    eTfRecorder::getInstance().setTempo(static_cast<eU16>(tempo));
+    event.offset = eMax<eS32>(metadata.samplePosition, 0);
+    event.index = event.velocity = 0;
+    event.value = event.value2 = 0.0f;
 
-    it.setNextSamplePosition(messageOffset);
+    if (status == 0x90 && data[2] != 0)
+    {
+        event.type = eTfInstrumentEvent::NOTE_ON;
+        event.index = data[1] & 0x7f;
+        event.velocity = data[2] & 0x7f;
+    }
+    else if (status == 0x80 || status == 0x90)
+    {
+        // the voices only see the note off when the chunk is rendered,
+        // a note off without a playing note does nothing on playback
+        event.type = eTfInstrumentEvent::NOTE_OFF;
+        event.index = data[1] & 0x7f;
+    }
+    else if (status == 0xb0 && data[1] == 123)
+    {
+        event.type = eTfInstrumentEvent::ALL_NOTES_OFF;
+    }
+    else if (status == 0xe0)
+    {
+        eS32 bend_lsb = data[1] & 0x7f;
+        eS32 bend_msb = data[2] & 0x7f;
 
-    while (it.getNextEvent(midiMessage, samplePosition))
+        event.type = eTfInstrumentEvent::PITCH_BEND;
+        event.value = ((eF32(bend_msb) / 127.0f) - 0.5f) * 2.0f;
+        event.value2 = ((eF32(bend_lsb) / 127.0f) - 0.5f) * 2.0f;
+    }
+    else if (status == 0xb0 && data[1] == 1)
     {
-        if (samplePosition >= static_cast<int>(messageOffset + frameSize))
-            break;
+        event.type = eTfInstrumentEvent::MOD_WHEEL;
+        event.value = (data[2] & 0x7f) / 127.0f;
+    }
+    else
+        return false;
 
-        eF32 time = static_cast<eF32>(cpi.timeInSeconds) + (static_cast<eF32>(samplePosition) / sampleRate);
-        
-        if (midiMessage.isNoteOn())
-        {
-            eU8 velocity = static_cast<eU8>(midiMessage.getVelocity());
-            eU8 note = static_cast<eU8>(midiMessage.getNoteNumber());
+    return true;
+}
 
-            eTfInstrumentNoteOn(*tf, note, velocity);
+eU32 Tunefish4AudioProcessor::parseMidi(const MidiBuffer &midiMessages, const AudioPlayHead::CurrentPositionInfo &cpi)
+{
+    eTfRecorder &recorder = eTfRecorder::getInstance();
+    eF32 sampleRate = static_cast<eF32>(getSampleRate());
+    eF32 startTime = static_cast<eF32>(cpi.timeInSeconds);
+    eU32 eventCount = 0;
 
-            eTfRecorder::getInstance().recordEvent(eTfEvent(time, static_cast<eU8>(recorderIndex), note, velocity));
-        }
-        else if (midiMessage.isNoteOff())
-        {
-            eU8 note = static_cast<eU8>(midiMessage.getNoteNumber());
+    // one pass over the raw bytes, the buffer is sorted by sample position
+    for (const MidiMessageMetadata metadata : midiMessages)
+    {
+        eTfInstrumentEvent event;
+        if (!midiToEvent(metadata, event))
+            continue;
 
-            if (eTfInstrumentNoteOff(*tf, note))
-            {
-                eTfRecorder::getInstance().recordEvent(eTfEvent(time, static_cast<eU8>(recorderIndex), note, 0));                
-            }
-        }
-        else if (midiMessage.isAllNotesOff())
-        {
-            eTfInstrumentAllNotesOff(*tf);
-        }
-        else if (midiMessage.isPitchWheel())
-        {
-            eS32 bend_lsb = midiMessage.getRawData()[1] & 0x7f;
-            eS32 bend_msb = midiMessage.getRawData()[2] & 0x7f;
+        eF32 time = startTime + (static_cast<eF32>(metadata.samplePosition) / sampleRate);
 
-            auto semitones = ((eF32(bend_msb) / 127.0f) - 0.5f) * 2.0f;
-            auto cents = ((eF32(bend_lsb) / 127.0f) - 0.5f) * 2.0f;
+        if (event.type == eTfInstrumentEvent::NOTE_ON || event.type == eTfInstrumentEvent::NOTE_OFF)
+            recorder.recordEvent(eTfEvent(time, static_cast<eU8>(recorderIndex), static_cast<eU8>(event.index), static_cast<eU8>(event.velocity)));
 
-            eTfInstrumentPitchBend(*tf, semitones, cents);
-        }
-        else if (midiMessage.isController())
-        {
-            const auto controllerNumber = midiMessage.getControllerNumber();
-            const auto controllerValue = midiMessage.getControllerValue();
+        // out of room, applyMidiOverflow() picks it up after the block
+        if (eventCount < TF_PLUG_MAXEVENTS)
+            events[eventCount++] = event;
+    }
 
-            if (controllerNumber == 1)
-                eTfInstrumentModWheel(*tf, controllerValue / 127.0f);
-        }
+    return eventCount;
+}
+
+// events which didn't fit into the queue come after all queued
+// ones, so they're applied once the block is rendered
+void Tunefish4AudioProcessor::applyMidiOverflow(const MidiBuffer &midiMessages, eU32 queued)
+{
+    if (queued < TF_PLUG_MAXEVENTS)
+        return;
+
+    for (const MidiMessageMetadata metadata : midiMessages)
+    {
+        eTfInstrumentEvent event;
+        if (!midiToEvent(metadata, event))
+            continue;
+
+        if (queued)
+            queued--;
+        else
+            eTfInstrumentApplyEvent(*tf, event);
     }
 }
 
 void Tunefish4AudioProcessor::writeProgramToPresets()
 {
-    programs[currentProgramIndex].loadFromSynth(tf);
+    storeProgram(programs[currentProgramIndex]);
 }
 
-void Tunefish4AudioProcessor::loadProgramFromPresets() const
+void Tunefish4AudioProcessor::loadProgramFromPresets()
 {
-    programs[currentProgramIndex].applyToSynth(tf);
+    publishProgram(programs[currentProgramIndex]);
 }
 
 bool Tunefish4AudioProcessor::loadProgram()
@@ -470,7 +556,7 @@ bool Tunefish4AudioProcessor::saveProgramAll() const
 
 bool Tunefish4AudioProcessor::copyProgram()
 {
-    copiedProgram.loadFromSynth(tf);
+    storeProgram(copiedProgram);
     copiedProgram.setName(programs[currentProgramIndex].getName());
     return true;
 }
@@ -478,7 +564,7 @@ bool Tunefish4AudioProcessor::copyProgram()
 bool Tunefish4AudioProcessor::pasteProgram()
 {
     programs[currentProgramIndex] = copiedProgram;
-    programs[currentProgramIndex].applyToSynth(tf);
+    publishProgram(programs[currentProgramIndex]);
     saveProgram();
     return true;
 }
@@ -596,7 +682,7 @@ bool Tunefish4AudioProcessor::loadPresetFile(File file, bool applyToSynth, int i
 
 	if (applyToSynth)
 	{
-		programs[index].applyToSynth(tf);
+		publishProgram(programs[index]);
 		saveProgram();
 		resetParamDirty(true);
 	}
@@ -622,7 +708,7 @@ void Tunefish4AudioProcessor::getStateInformation (MemoryBlock& destData)
 
     for (eU32 i=0; i<TF_PARAM_COUNT; i++)
     {
-        xml.setAttribute (TF_NAMES[i], tf->params[i]);
+        xml.setAttribute (TF_NAMES[i], paramValues[i].get());
     }
 
     copyXmlToBinary (xml, destData);
@@ -637,10 +723,14 @@ void Tunefish4AudioProcessor::setStateInformation (const void* data, int sizeInB
         // make sure that it's actually our type of XML object..
         if (xmlState->hasTagName ("TF4SETTINGS"))
         {
+            eTfSynthProgram state;
+
             for (eU32 i=0; i<TF_PARAM_COUNT; i++)
             {
-                tf->params[i] = static_cast<float>(xmlState->getDoubleAttribute (TF_NAMES[i], tf->params[i]));
+                state.setParam(i, static_cast<float>(xmlState->getDoubleAttribute (TF_NAMES[i], paramValues[i].get())));
             }
+
+            publishProgram(state);
         }
     }
 }
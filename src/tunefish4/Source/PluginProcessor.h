@@ -28,10 +28,11 @@
 #include "runtime/system.hpp"
 #include "tfsynthprogram.hpp"
 #include "tflookandfeel.h"
+#include "tfhandoff.hpp"
 #include "synth/tf4.hpp"
 
 const eU32 TF_PLUG_NUM_PROGRAMS = 1000;
-
+const eU32 TF_PLUG_MAXEVENTS = 512;    // midi events per block
 
 //==============================================================================
 /**
@@ -48,7 +49,8 @@ public:
     void                    releaseResources() override;
 
     void                    processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
-    void                    processEvents(MidiBuffer &midiMessages, eU32 messageOffset, eU32 frameSize);
+    eU32                    parseMidi(const MidiBuffer &midiMessages, const AudioPlayHead::CurrentPositionInfo &cpi);
+    void                    applyMidiOverflow(const MidiBuffer &midiMessages, eU32 queued);
 
     //==============================================================================
     AudioProcessorEditor*   createEditor() override;
@@ -80,14 +82,14 @@ public:
 	const String            getCurrentProgramName() const;
 
     eTfSynth *              getSynth() const;
-    CriticalSection &       getSynthCriticalSection();
+    eTfVoiceSnapshot &      getVoiceSnapshot();
 
     //==============================================================================
     void                    getStateInformation (MemoryBlock& destData) override;
     void                    setStateInformation (const void* data, int sizeInBytes) override;
 
     void                    writeProgramToPresets();
-    void                    loadProgramFromPresets() const;
+    void                    loadProgramFromPresets();
     bool                    loadProgram();
     bool                    loadProgram(eU32 index);
     bool                    loadProgramAll();
@@ -112,6 +114,11 @@ public:
     MidiKeyboardState       keyboardState;
 
 private:
+    void                    publishProgram(const eTfSynthProgram &program);
+    void                    storeProgram(eTfSynthProgram &program) const;
+    void                    applyParameterChanges();
+    void                    publishVoiceSnapshot();
+
     eTfInstrument *         tf;
     eTfSynth *              synth;
     eTfSynthProgram         programs[TF_PLUG_NUM_PROGRAMS];
@@ -122,15 +129,20 @@ private:
     eTfSynthProgram         copiedProgram;
     eU32                    currentProgramIndex;
     String                  pluginLocation;
-    CriticalSection         csSynth;
     eS32                    recorderIndex;
     
     Atomic<float>           meterLevels[2];
     Atomic<int>             metering;
 
-    eF32 *                  adapterBuffer[2];
-    eU32                    adapterWriteOffset;
-    eU32                    adapterDataAvailable;
+    eTfInstrumentEvent      events[TF_PLUG_MAXEVENTS];    // midi of the current block, parsed once
+
+    // the audio thread owns tf->params. everyone else goes through
+    // paramValues, changes are picked up at the start of a block
+    Atomic<float>           paramValues[TF_PARAM_COUNT];
+    Atomic<int>             paramPending[TF_PARAM_COUNT];
+    Atomic<int>             paramsPending;
+    eTfTripleBuffer<eTfProgramParams> programSwap;      // written on the message thread
+    eTfTripleBuffer<eTfVoiceSnapshot> voiceSnapshots;   // read on the message thread
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Tunefish4AudioProcessor)
 };
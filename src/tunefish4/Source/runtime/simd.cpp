@@ -21,8 +21,26 @@
 
 #include "system.hpp"
 
+#if defined(eSIMD_DISPATCH)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static eSimdIsa g_simdIsa = eSIMD_ISA_COUNT;
+
 #if defined(__APPLE__) && defined(__MACH__)
 
+eSimdIsa eSimdDetectIsa()
+{
+    return eSIMD_ISA_BASE;
+}
+
 #else
 
 // DZ   bit 6 = 1       denormals are zero
@@ -46,5 +64,106 @@ void eSimdSetArithmeticFlags(eInt flags)
     _mm_setcsr(mxcsr);
 }
 
+#if defined(eSIMD_DISPATCH)
+
+static void eSimdCpuid(eU32 leaf, eU32 *regs)
+{
+#if defined(_MSC_VER)
+    __cpuidex(reinterpret_cast<int *>(regs), leaf, 0);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
 #endif
+}
+
+// register state the os saves on context switches (xcr0)
+static eU32 eSimdOsSavedState()
+{
+#if defined(_MSC_VER)
+    return (eU32)_xgetbv(0);
+#else
+    eU32 eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+#endif
+}
+
+eSimdIsa eSimdDetectIsa()
+{
+    eU32 regs[4];
+    eSimdCpuid(0, regs);
+    const eU32 maxLeaf = regs[0];
+
+    if (maxLeaf < 7)
+        return eSIMD_ISA_BASE;
+
+    eSimdCpuid(1, regs);
+    const eBool fma = (regs[2] & (1 << 12)) != 0;
+    const eBool osxsave = (regs[2] & (1 << 27)) != 0;
+    const eBool avx = (regs[2] & (1 << 28)) != 0;
+
+    if (!osxsave || !avx || !fma)
+        return eSIMD_ISA_BASE;
+
+    // xmm, ymm and for avx-512 the opmask and zmm registers
+    // have to be enabled by the os, not only by the cpu
+    const eU32 xcr0 = eSimdOsSavedState();
+    if ((xcr0 & 0x06) != 0x06)
+        return eSIMD_ISA_BASE;
+
+    eSimdCpuid(7, regs);
+    const eBool avx2 = (regs[1] & (1 << 5)) != 0;
+    const eBool avx512f = (regs[1] & (1 << 16)) != 0;
+    const eBool avx512bw = (regs[1] & (1 << 30)) != 0;
+
+    if (!avx2)
+        return eSIMD_ISA_BASE;
+    if (avx512f && avx512bw && (xcr0 & 0xe6) == 0xe6)
+        return eSIMD_ISA_AVX512;
+
+    return eSIMD_ISA_AVX2;
+}
+
+#else
+
+eSimdIsa eSimdDetectIsa()
+{
+    return eSIMD_ISA_BASE;
+}
+
+#endif
+
+#endif
+
+eSimdIsa eSimdGetIsa()
+{
+    if (g_simdIsa == eSIMD_ISA_COUNT)
+    {
+        g_simdIsa = eSimdDetectIsa();
+
+#if defined(eSIMD_DISPATCH)
+        const char *forced = getenv("TF_SIMD_ISA");
+        if (forced)
+        {
+            if (!strcmp(forced, "base") || !strcmp(forced, "sse2"))
+                eSimdForceIsa(eSIMD_ISA_BASE);
+            else if (!strcmp(forced, "avx2"))
+                eSimdForceIsa(eSIMD_ISA_AVX2);
+            else if (!strcmp(forced, "avx512"))
+                eSimdForceIsa(eSIMD_ISA_AVX512);
+            else
+                fprintf(stderr, "TF_SIMD_ISA: unknown instruction set '%s', using the detected one\n", forced);
+        }
+#endif
+    }
+
+    return g_simdIsa;
+}
+
+// can only lower the instruction set, never
+// enable one the cpu doesn't support
+void eSimdForceIsa(eSimdIsa isa)
+{
+    const eSimdIsa detected = eSimdDetectIsa();
+    g_simdIsa = (isa < detected ? isa : detected);
+}
 
@@ -40,6 +40,38 @@ typedef simd::float2 eF32x2;
 #define eSimdNfma(sub, mul0, mul1)                  (sub - (mul0 * mul1))
 #define eSimdStore2(v, v0, v1)                      v0 = v.x; v1 = v.y;
 
+typedef simd::float4 eF32x4;
+
+#define eSimdZero()                                 simd::float4{0.0f, 0.0f, 0.0f, 0.0f}
+#define eSimdSetAll4(val)                           simd::float4{val, val, val, val}
+#define eSimdLoad(vals)                             (*reinterpret_cast<const simd::packed::float4 *>(vals))
+#define eSimdStore(v, buf)                          (*reinterpret_cast<simd::packed::float4 *>(buf) = (v))
+#define eSimdAbs(v)                                 simd::fabs(v)
+#define eSimdFloor(v)                               simd::floor(v)
+#define eSimdUnpackLo(v0, v1)                       simd::float4{(v0).x, (v1).x, (v0).y, (v1).y}
+#define eSimdUnpackHi(v0, v1)                       simd::float4{(v0).z, (v1).z, (v0).w, (v1).w}
+
+typedef simd::uint4 eU32x4;
+
+#define eSimdLoadU32(vals)                          (*reinterpret_cast<const simd::packed::uint4 *>(vals))
+#define eSimdStoreU32(v, buf)                       (*reinterpret_cast<simd::packed::uint4 *>(buf) = (v))
+#define eSimdAddU32(v0, v1)                         ((v0) + (v1))
+#define eSimdShlU32(v, count)                       ((v) << (count))
+#define eSimdShrU32(v, count)                       ((v) >> (count))
+#define eSimdU32ToF32(v)                            simd_float(v)
+
+inline void eSimdTranspose(eF32x4 &row0, eF32x4 &row1, eF32x4 &row2, eF32x4 &row3)
+{
+    const eF32x4 t0 = eSimdUnpackLo(row0, row1);
+    const eF32x4 t1 = eSimdUnpackLo(row2, row3);
+    const eF32x4 t2 = eSimdUnpackHi(row0, row1);
+    const eF32x4 t3 = eSimdUnpackHi(row2, row3);
+    row0 = simd::float4{t0.x, t0.y, t1.x, t1.y};
+    row1 = simd::float4{t0.z, t0.w, t1.z, t1.w};
+    row2 = simd::float4{t2.x, t2.y, t3.x, t3.y};
+    row3 = simd::float4{t2.z, t2.w, t3.z, t3.w};
+}
+
 enum eSimdArithmeticFlags
 {
     eSAF_FTZ =  1, // flush to zero
@@ -58,6 +90,20 @@ inline void eSimdSetArithmeticFlags(eInt flags) {}
 #include <emmintrin.h>
 #include <smmintrin.h>
 
+// kernels for wider instruction sets are compiled into the same binary
+// and picked at runtime, the player stays on the baseline to keep small
+#if !defined(ePLAYER) && (defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__))
+#define eSIMD_DISPATCH
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define eSIMD_TARGET_AVX2                           __attribute__((target("avx2,fma")))
+#define eSIMD_TARGET_AVX512                         __attribute__((target("avx512f,avx512bw,avx2,fma")))
+#else
+#define eSIMD_TARGET_AVX2
+#define eSIMD_TARGET_AVX512
+#endif
+#endif
+
 #define eSimdSelect(v, i0, i1, i2, i3)              _mm_shuffle_ps(v, v, _MM_SHUFFLE(i0, i1, i2, i3))
 #define eSimdShuffle(v0, v1, i00, i01, i10, i11)    _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(i00, i01, i10, i11))
 #define eSimdBlend(v0, v1, i0, i1, i2, i3)          _mm_blend_ps(v0, v1, ((i0)|(i1)<<1|(i2)<<2|(i3)<<3))
@@ -66,6 +112,7 @@ inline void eSimdSetArithmeticFlags(eInt flags) {}
 #define eSimdLoad(vals)                             _mm_loadu_ps(vals)
 #define eSimdLoadAligned(vals)                      _mm_load_ps(vals)
 #define eSimdSetAll(val)                            _mm_set1_ps(val)
+#define eSimdSetAll4(val)                           _mm_set1_ps(val)
 #define eSimdSet(val0, val1, val2, val3)            _mm_set_ps(val0, val1, val2, val3)
 #define eSimdSet2(val0, val1)                       _mm_set_ps(val0, val1, 0.0f, 0.0f)
 #define eSimdMul(v0, v1)                            _mm_mul_ps(v0, v1)
@@ -79,11 +126,14 @@ inline void eSimdSetArithmeticFlags(eInt flags) {}
 #define eSimdSqrt(v)                                _mm_sqrt_ps(v)
 #define eSimdMax(v0, v1)                            _mm_max_ps(v0, v1)
 #define eSimdMin(v0, v1)                            _mm_min_ps(v0, v1)
-#define eSimdAbs(v)                                 _mm_andnot_ps(v, _mm_castsi128_ps(_mm_set1_epi32(eSIMD_MSB1_REST0)))
+#define eSimdAbs(v)                                 _mm_andnot_ps(_mm_castsi128_ps(_mm_set1_epi32(eSIMD_MSB1_REST0)), v)
+#define eSimdFloor(v)                               eSimdFloorSse2(v)
 #define eSimdNeg(v)                                 _mm_xor_ps(v, _mm_castsi128_ps(_mm_set1_epi32(eSIMD_MSB1_REST0)))
 #define eSimdXor(v0, v1)                            _mm_xor_ps(v0, v1)
 #define eSimdStore(v, buf)                          _mm_storeu_ps(buf, v)
 #define eSimdStoreAligned(v, buf)                   _mm_store_ps(buf, v)
+#define eSimdUnpackLo(v0, v1)                       _mm_unpacklo_ps(v0, v1) // returns v0[0] v1[0] v0[1] v1[1]
+#define eSimdUnpackHi(v0, v1)                       _mm_unpackhi_ps(v0, v1) // returns v0[2] v1[2] v0[3] v1[3]
 #define eSimdFma(add, mul0, mul1)                   _mm_add_ps(add, _mm_mul_ps(mul0, mul1)) // returns add+mul0*mul1
 #define eSimdNfma(sub, mul0, mul1)                  _mm_sub_ps(sub, _mm_mul_ps(mul0, mul1)) // returns add-mul0*mul1
 #define eSimdRSqrt(v)                               _mm_rsqrt_ps(v) // returns 1/sqrt(v)
@@ -104,6 +154,79 @@ inline void eSimdSetArithmeticFlags(eInt flags) {}
 
 typedef __m128 eF32x2;
 typedef __m128 eF32x4;
+typedef __m128i eU32x4;
+
+#define eSimdLoadU32(vals)                          _mm_loadu_si128(reinterpret_cast<const __m128i *>(vals))
+#define eSimdStoreU32(v, buf)                       _mm_storeu_si128(reinterpret_cast<__m128i *>(buf), v)
+#define eSimdAddU32(v0, v1)                         _mm_add_epi32(v0, v1) // wraps around
+#define eSimdShlU32(v, count)                       _mm_sll_epi32(v, _mm_cvtsi32_si128(count))
+#define eSimdShrU32(v, count)                       _mm_srl_epi32(v, _mm_cvtsi32_si128(count))
+#define eSimdU32ToF32(v)                            _mm_cvtepi32_ps(v) // values must be below 2^31
+
+// sse2 only, _mm_floor_ps needs sse4.1. valid for |v| < 2^31
+inline __m128 eSimdFloorSse2(__m128 v)
+{
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+
+// loads up to four stereo samples as one vector per sample, with
+// the left channel in lane 3 and the right one in lane 2 like eSimdSet2
+inline void eSimdLoadStereo(const eF32 *left, const eF32 *right, eU32 count, __m128 *samples)
+{
+    __m128 l, r;
+
+    if (count == 4)
+    {
+        l = _mm_loadu_ps(left);
+        r = _mm_loadu_ps(right);
+    }
+    else
+    {
+        eF32 bufL[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        eF32 bufR[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (eU32 i=0; i<count; i++)
+        {
+            bufL[i] = left[i];
+            bufR[i] = right[i];
+        }
+        l = _mm_loadu_ps(bufL);
+        r = _mm_loadu_ps(bufR);
+    }
+
+    const __m128 t01 = _mm_unpacklo_ps(r, l);
+    const __m128 t23 = _mm_unpackhi_ps(r, l);
+    samples[0] = _mm_movelh_ps(t01, t01);
+    samples[1] = t01;
+    samples[2] = _mm_movelh_ps(t23, t23);
+    samples[3] = t23;
+}
+
+// inverse of eSimdLoadStereo
+inline void eSimdStoreStereo(const __m128 *samples, eU32 count, eF32 *left, eF32 *right)
+{
+    const __m128 u01 = _mm_unpackhi_ps(samples[0], samples[1]);
+    const __m128 u23 = _mm_unpackhi_ps(samples[2], samples[3]);
+    const __m128 l = _mm_movehl_ps(u23, u01);
+    const __m128 r = _mm_movelh_ps(u01, u23);
+
+    if (count == 4)
+    {
+        _mm_storeu_ps(left, l);
+        _mm_storeu_ps(right, r);
+    }
+    else
+    {
+        eF32 bufL[4], bufR[4];
+        _mm_storeu_ps(bufL, l);
+        _mm_storeu_ps(bufR, r);
+        for (eU32 i=0; i<count; i++)
+        {
+            left[i] = bufL[i];
+            right[i] = bufR[i];
+        }
+    }
+}
 
 enum eSimdConsts
 {
@@ -131,4 +254,19 @@ void eSimdSetArithmeticFlags(eInt flags);
 
 #endif
 
+enum eSimdIsa
+{
+    eSIMD_ISA_BASE,     // sse2 on x86, neon on arm
+    eSIMD_ISA_AVX2,     // avx2 + fma
+    eSIMD_ISA_AVX512,   // avx-512 f + bw
+    eSIMD_ISA_COUNT
+};
+
+// widest instruction set usable on this cpu, can be lowered
+// for testing by eSimdForceIsa() or the TF_SIMD_ISA environment
+// variable (base, avx2 or avx512)
+eSimdIsa eSimdGetIsa();
+eSimdIsa eSimdDetectIsa();
+void eSimdForceIsa(eSimdIsa isa);
+
 #endif
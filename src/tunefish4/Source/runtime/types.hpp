@@ -48,7 +48,7 @@
 #define eDEBUGBREAK             __debugbreak
 #else
 #define eFASTCALL
-#define eFORCEINLINE            __inline
+#define eFORCEINLINE            inline __attribute__((always_inline))
 #define eINLINE                 __inline
 #define eNORETURN
 #define eALIGN16
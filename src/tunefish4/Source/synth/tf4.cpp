@@ -38,6 +38,13 @@
 #include "tf4.hpp"
 #endif
 
+#ifdef eTF_ASYNC_SPECTRUM
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#endif
+
 #ifndef eCFG_NO_TF
 
 // ------------------------------------------------------------------------------------
@@ -57,26 +64,14 @@ void eTfSignalMix16(eS16 *master, eS16 *in, eU32 length)
 	}
 }
 
-eBool eTfSignalMix(eF32 **master, eF32 **in, eU32 length, eF32 volume)
+static eF32 eTfSignalMixBase(eF32 **master, eF32 **in, eU32 length, eF32 gain)
 {
     eF32 *signal1 = master[0];
     eF32 *signal2 = master[1];
     eF32 *mix1 = in[0];
     eF32 *mix2 = in[1];
 
-    if (volume <= 0.5f)
-    {
-        volume *= 2.0f;
-        volume *= volume;
-    }
-    else
-    {
-        volume -= 0.5f;
-        volume *= 20.0f;
-        volume += 1.0f;
-    }
-
-    eF32x2 const_vol = eSimdSetAll(volume);
+    eF32x2 const_vol = eSimdSetAll(gain);
     eF32 hasSignal = 0.0f;
 
     while(length--)
@@ -98,10 +93,104 @@ eBool eTfSignalMix(eF32 **master, eF32 **in, eU32 length, eF32 volume)
         signal2++;
     }
 
-    return hasSignal > 1.0f;
+    return hasSignal;
 }
 
-void eTfSignalToS16(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
+#ifdef eSIMD_DISPATCH
+
+static eSIMD_TARGET_AVX2 eF32 eTfSignalMixAvx2(eF32 **master, eF32 **in, eU32 length, eF32 gain)
+{
+    eF32 *signal1 = master[0];
+    eF32 *signal2 = master[1];
+    const eF32 *mix1 = in[0];
+    const eF32 *mix2 = in[1];
+
+    const __m256 mgain = _mm256_set1_ps(gain);
+    const __m256 mabs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 msum = _mm256_setzero_ps();
+    eU32 i = 0;
+
+    for (; i+8<=length; i+=8)
+    {
+        const __m256 val1 = _mm256_loadu_ps(&mix1[i]);
+        const __m256 val2 = _mm256_loadu_ps(&mix2[i]);
+        msum = _mm256_add_ps(msum, _mm256_add_ps(_mm256_and_ps(val1, mabs), _mm256_and_ps(val2, mabs)));
+        _mm256_storeu_ps(&signal1[i], _mm256_fmadd_ps(val1, mgain, _mm256_loadu_ps(&signal1[i])));
+        _mm256_storeu_ps(&signal2[i], _mm256_fmadd_ps(val2, mgain, _mm256_loadu_ps(&signal2[i])));
+    }
+
+    eF32 sums[4];
+    _mm_storeu_ps(sums, _mm_add_ps(_mm256_castps256_ps128(msum), _mm256_extractf128_ps(msum, 1)));
+    eF32 hasSignal = sums[0] + sums[1] + sums[2] + sums[3];
+
+    for (; i<length; i++)
+    {
+        hasSignal += eAbs(mix1[i]) + eAbs(mix2[i]);
+        signal1[i] += mix1[i] * gain;
+        signal2[i] += mix2[i] * gain;
+    }
+
+    return hasSignal;
+}
+
+static eSIMD_TARGET_AVX512 eF32 eTfSignalMixAvx512(eF32 **master, eF32 **in, eU32 length, eF32 gain)
+{
+    eF32 *signal1 = master[0];
+    eF32 *signal2 = master[1];
+    const eF32 *mix1 = in[0];
+    const eF32 *mix2 = in[1];
+
+    const __m512 mgain = _mm512_set1_ps(gain);
+    __m512 msum = _mm512_setzero_ps();
+    eU32 i = 0;
+
+    for (; i+16<=length; i+=16)
+    {
+        const __m512 val1 = _mm512_loadu_ps(&mix1[i]);
+        const __m512 val2 = _mm512_loadu_ps(&mix2[i]);
+        msum = _mm512_add_ps(msum, _mm512_add_ps(_mm512_abs_ps(val1), _mm512_abs_ps(val2)));
+        _mm512_storeu_ps(&signal1[i], _mm512_fmadd_ps(val1, mgain, _mm512_loadu_ps(&signal1[i])));
+        _mm512_storeu_ps(&signal2[i], _mm512_fmadd_ps(val2, mgain, _mm512_loadu_ps(&signal2[i])));
+    }
+
+    eF32 hasSignal = _mm512_reduce_add_ps(msum);
+
+    for (; i<length; i++)
+    {
+        hasSignal += eAbs(mix1[i]) + eAbs(mix2[i]);
+        signal1[i] += mix1[i] * gain;
+        signal2[i] += mix2[i] * gain;
+    }
+
+    return hasSignal;
+}
+
+#endif
+
+// returns the summed magnitude of the mixed in signal
+static eF32 eTfSignalMixLevel(eF32 **master, eF32 **in, eU32 length, eF32 volume)
+{
+    if (volume <= 0.5f)
+    {
+        volume *= 2.0f;
+        volume *= volume;
+    }
+    else
+    {
+        volume -= 0.5f;
+        volume *= 20.0f;
+        volume += 1.0f;
+    }
+
+    return TF_KERNELS.signalMix(master, in, length, volume);
+}
+
+eBool eTfSignalMix(eF32 **master, eF32 **in, eU32 length, eF32 volume)
+{
+    return eTfSignalMixLevel(master, in, length, volume) > 1.0f;
+}
+
+static void eTfSignalToS16Base(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
 {
     eS16 *dest = out;
     eF32 *srcLeft = sig[0];
@@ -122,6 +211,64 @@ void eTfSignalToS16(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
     }
 }
 
+#ifdef eSIMD_DISPATCH
+
+// the 32 bit pack works per 128 bit lane, with left and right
+// unpacked per lane first the samples come out in order
+static eSIMD_TARGET_AVX2 void eTfSignalToS16Avx2(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
+{
+    const eF32 *srcLeft = sig[0];
+    const eF32 *srcRight = sig[1];
+
+    const __m256 mgain = _mm256_set1_ps(gain);
+    const __m256 mmin = _mm256_set1_ps(-32768.0f);
+    const __m256 mmax = _mm256_set1_ps(32767.0f);
+    eU32 i = 0;
+
+    for (; i+8<=length; i+=8)
+    {
+        const __m256i left = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&srcLeft[i]), mgain), mmin), mmax));
+        const __m256i right = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&srcRight[i]), mgain), mmin), mmax));
+        const __m256i packed = _mm256_packs_epi32(_mm256_unpacklo_epi32(left, right), _mm256_unpackhi_epi32(left, right));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&out[i*2]), packed);
+    }
+
+    for (; i<length; i++)
+    {
+        out[i*2] = static_cast<eS16>(eFtoL(eClamp(-32768.0f, srcLeft[i] * gain, 32767.0f)));
+        out[i*2+1] = static_cast<eS16>(eFtoL(eClamp(-32768.0f, srcRight[i] * gain, 32767.0f)));
+    }
+}
+
+static eSIMD_TARGET_AVX512 void eTfSignalToS16Avx512(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
+{
+    const eF32 *srcLeft = sig[0];
+    const eF32 *srcRight = sig[1];
+
+    const __m512 mgain = _mm512_set1_ps(gain);
+    const __m512 mmin = _mm512_set1_ps(-32768.0f);
+    const __m512 mmax = _mm512_set1_ps(32767.0f);
+    eU32 i = 0;
+
+    for (; i+16<=length; i+=16)
+    {
+        const __m512i left = _mm512_cvttps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_loadu_ps(&srcLeft[i]), mgain), mmin), mmax));
+        const __m512i right = _mm512_cvttps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_loadu_ps(&srcRight[i]), mgain), mmin), mmax));
+        const __m512i packed = _mm512_packs_epi32(_mm512_unpacklo_epi32(left, right), _mm512_unpackhi_epi32(left, right));
+        _mm512_storeu_si512(&out[i*2], packed);
+    }
+
+    eF32 *rest[2] = { sig[0] + i, sig[1] + i };
+    eTfSignalToS16Avx2(rest, out + i*2, gain, length - i);
+}
+
+#endif
+
+void eTfSignalToS16(eF32 **sig, eS16 *out, const eF32 gain, eU32 length)
+{
+    TF_KERNELS.signalToS16(sig, out, gain, length);
+}
+
 void eTfSignalToPeak(eF32 **sig, eF32 *peak_left, eF32 *peak_right, eU32 length)
 {
     eF32 *srcLeft = sig[0];
@@ -247,22 +394,29 @@ void eTfEnvelopeNoteOff(eTfEnvelope &state)
     state.phase = eTfEnvelope::RELEASE;
 }
 
-eF32 eTfEnvelopeProcess(eTfSynth &synth, eTfInstrument &instr, eTfEnvelope &envState, eF32 decayMod, eU32 paramOffset, eU32 frameSize)
+static eF32 eTfEnvelopeDecay(eF32 d, eF32 decayMod, eF32 scale)
 {
-    eF32 a = instr.params[paramOffset];
-    eF32 d = instr.params[paramOffset+1];
-    eF32 s = instr.params[paramOffset+2];
-    eF32 r = instr.params[paramOffset+3];
-    eF32 slope = instr.params[paramOffset+4];
-
-    eF32 scale = 0.00050f * frameSize * (synth.sampleRate / 44100.0f);
-    eF32 attack = -eLog10(eMax(0.000000001f, ePow(a, 3)) * .94f) * scale;
 	d = eMax(0.000000001f, ePow(d * decayMod, 3));
-    eF32 decay = eLog10(d * .94f) * 0.25f * scale;
-    eF32 sustain = eMin(s, 0.99f);
-    eF32 release = eLog10(eMax(ePow(r, 3), 0.000000001f) * .94f) * 0.25f * scale;
+    return eLog10(d * .94f) * 0.25f * scale;
+}
+
+// the rates come from the instrument's control values,
+// only a modulated decay is computed per voice
+eF32 eTfEnvelopeProcess(eTfInstrument &instr, eTfEnvelope &envState, eF32 decayMod, eU32 paramOffset, eU32 frameSize)
+{
+    const eTfInstrumentControl &control = instr.control;
+    const eU32 env = (paramOffset == TF_ADSR1_ATTACK ? 0 : 1);
+
+    eF32 slope = instr.params[paramOffset+4];
+    eF32 attack = control.envAttack[env] * frameSize;
+    eF32 decay = control.envDecay[env] * frameSize;
+    eF32 sustain = control.envSustain[env];
+    eF32 release = control.envRelease[env] * frameSize;
     eF32 volume = envState.volume;
 
+    if (decayMod != 1.0f)
+        decay = eTfEnvelopeDecay(instr.params[paramOffset+1], decayMod, control.envScale * frameSize);
+
     switch (envState.phase)
     {
     case eTfEnvelope::ATTACK:
@@ -348,13 +502,13 @@ void eTfLfoReset(eTfLfo &state, eF32 phase)
 
 eF32 eTfLfoProcess(eTfSynth &synth, eTfInstrument &instr, eTfLfo &lfoState, eF32 depthMod, eU32 paramOffset, eU32 frameSize, eF32 *depthOut)
 {
-    eF32 freq = instr.params[paramOffset];
+    const eU32 lfo = (paramOffset == TF_LFO1_RATE ? 0 : 1);
+    eF32 freq = instr.control.lfoFreq[lfo] * frameSize;
     eF32 depth = instr.params[paramOffset+1] * depthMod;
-    eU32 shape = eFtoL(eRoundNearest(instr.params[paramOffset + 2] * (TF_LFOSHAPECOUNT - 1)));
+    eU32 shape = instr.decoded.lfoShape[lfo];
 
     eF32 result = 1.0f;
     depth = depth * depth;
-    freq = (freq * freq) / synth.sampleRate * frameSize * 50.0f;
 
     switch (shape)
     {
@@ -394,15 +548,26 @@ eBool eTfModMatrixIsActive(eTfModMatrix &state)
     return eFALSE;
 }
 
-eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &state, eU32 frameSize)
+// clamped, so a parameter outside 0..1 can't index outside of a table
+static eU32 eTfParamToIndex(eF32 value, eU32 count)
 {
-    eBool playing1 = eFALSE;
-	eBool playing2 = eFALSE;
+    return eFtoL(eRoundNearest(eClamp(0.0f, value, 1.0f) * (count-1)));
+}
 
-    eBool adsr1_done = eFALSE;
-    eBool adsr2_done = eFALSE;
-    eBool lfo1_done = eFALSE;
-    eBool lfo2_done = eFALSE;
+// the routing only changes with the TF_MM* parameters, so it is decoded
+// by eTfInstrumentDecode() for the instrument instead of per voice
+void eTfModMatrixCompile(eTfInstrument &instr)
+{
+    eTfModMatrixPlan &plan = instr.modPlan;
+    const eF32 *params = &instr.params[TF_MM1_SOURCE];
+
+    if (plan.compiled && eMemEqual(plan.params, params, sizeof(plan.params)))
+        return;
+
+    eMemCopy(plan.params, params, sizeof(plan.params));
+    eMemSet(plan.entryCount, 0, sizeof(plan.entryCount));
+    plan.routedCount = 0;
+    plan.compiled = eTRUE;
 
     for(eU32 i=0;i<TF_MODMATRIXENTRIES;i++)
     {
@@ -418,9 +583,47 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
             mod = 1.0f + mod * (TF_MM_MODRANGE-1.0f);
         }
 
-        state.entries[i].src        = (eTfModMatrix::Input)eFtoL(eRoundNearest(instr.params[TF_MM1_SOURCE + i*3] * (eTfModMatrix::INPUT_COUNT-1)));
-        state.entries[i].dst        = (eTfModMatrix::Output)eFtoL(eRoundNearest(instr.params[TF_MM1_TARGET + i*3] * (eTfModMatrix::OUTPUT_COUNT-1)));
-        state.entries[i].mod        = mod;
+        eTfModMatrix::Output dst = (eTfModMatrix::Output)eTfParamToIndex(instr.params[TF_MM1_TARGET + i*3], eTfModMatrix::OUTPUT_COUNT);
+
+        plan.src[i] = (eTfModMatrix::Input)eTfParamToIndex(instr.params[TF_MM1_SOURCE + i*3], eTfModMatrix::INPUT_COUNT);
+        plan.dst[i] = dst;
+        plan.mod[i] = mod;
+
+        if (plan.entryCount[dst] == 0)
+            plan.routed[plan.routedCount++] = dst;
+
+        plan.entries[dst][plan.entryCount[dst]++] = i;
+    }
+}
+
+// product of the entries routed to the output, in entry order
+static eFORCEINLINE eF32 eTfModMatrixCollect(const eTfModMatrixPlan &plan, const eTfModMatrix &state, eTfModMatrix::Output output)
+{
+    eF32 value = 1.0f;
+
+    for(eU32 i=0; i<plan.entryCount[output]; i++)
+        value *= state.entries[plan.entries[output][i]].result;
+
+    return value;
+}
+
+eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &state, eU32 frameSize)
+{
+    const eTfModMatrixPlan &plan = instr.modPlan;
+
+    eBool playing1 = eFALSE;
+	eBool playing2 = eFALSE;
+
+    eBool adsr1_done = eFALSE;
+    eBool adsr2_done = eFALSE;
+    eBool lfo1_done = eFALSE;
+    eBool lfo2_done = eFALSE;
+
+    for(eU32 i=0;i<TF_MODMATRIXENTRIES;i++)
+    {
+        state.entries[i].src        = plan.src[i];
+        state.entries[i].dst        = plan.dst[i];
+        state.entries[i].mod        = plan.mod[i];
         state.entries[i].result     = 1.0f;
         state.entries[i].srcDepth   = 1.0f;
 
@@ -429,7 +632,7 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
         case eTfModMatrix::INPUT_LFO1:
             if (!lfo1_done)
             {
-                eF32 depthMod = eTfModMatrixGet(state, eTfModMatrix::OUTPUT_LFO1_DEPTH);
+                eF32 depthMod = eTfModMatrixCollect(plan, state, eTfModMatrix::OUTPUT_LFO1_DEPTH);
                 state.values[eTfModMatrix::INPUT_LFO1] = eTfLfoProcess(synth, instr, state.lfoState[0], depthMod, TF_LFO1_RATE, frameSize, &state.entries[i].srcDepth);
                 lfo1_done = eTRUE;
             }
@@ -439,7 +642,7 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
         case eTfModMatrix::INPUT_LFO2:
             if (!lfo2_done)
             {
-                eF32 depthMod = eTfModMatrixGet(state, eTfModMatrix::OUTPUT_LFO2_DEPTH);
+                eF32 depthMod = eTfModMatrixCollect(plan, state, eTfModMatrix::OUTPUT_LFO2_DEPTH);
                 state.values[eTfModMatrix::INPUT_LFO2] = eTfLfoProcess(synth, instr, state.lfoState[1], depthMod, TF_LFO2_RATE, frameSize, &state.entries[i].srcDepth);
                 lfo2_done = eTRUE;
             }
@@ -450,9 +653,9 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
         case eTfModMatrix::INPUT_ADSR1:
             if (!adsr1_done)
             {
-                eF32 mmo_decay = eTfModMatrixGet(state, eTfModMatrix::OUTPUT_ADSR1_DECAY);
+                eF32 mmo_decay = eTfModMatrixCollect(plan, state, eTfModMatrix::OUTPUT_ADSR1_DECAY);
 				playing1 = !eTfEnvelopeIsEnd(state.envState[0]);
-                state.values[eTfModMatrix::INPUT_ADSR1] = eTfEnvelopeProcess(synth, instr, state.envState[0], mmo_decay, TF_ADSR1_ATTACK, frameSize);
+                state.values[eTfModMatrix::INPUT_ADSR1] = eTfEnvelopeProcess(instr, state.envState[0], mmo_decay, TF_ADSR1_ATTACK, frameSize);
                 adsr1_done = eTRUE;
             }
 
@@ -462,9 +665,9 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
         case eTfModMatrix::INPUT_ADSR2:
             if (!adsr2_done)
             {
-                eF32 mmo_decay = eTfModMatrixGet(state, eTfModMatrix::OUTPUT_ADSR2_DECAY);
+                eF32 mmo_decay = eTfModMatrixCollect(plan, state, eTfModMatrix::OUTPUT_ADSR2_DECAY);
 				playing2 = !eTfEnvelopeIsEnd(state.envState[1]);
-                state.values[eTfModMatrix::INPUT_ADSR2] = eTfEnvelopeProcess(synth, instr, state.envState[1], mmo_decay, TF_ADSR2_ATTACK, frameSize);
+                state.values[eTfModMatrix::INPUT_ADSR2] = eTfEnvelopeProcess(instr, state.envState[1], mmo_decay, TF_ADSR2_ATTACK, frameSize);
                 adsr2_done = eTRUE;
             }
 
@@ -483,7 +686,17 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
     // determine values for self-modulation of mod matrix
     for(eU32 i=0;i<TF_MODMATRIXENTRIES;i++)
     {
-        state.modulation[i] = eTfModMatrixGet(state, (eTfModMatrix::Output)(eTfModMatrix::OUTPUT_MOD1 + i));
+        state.modulation[i] = eTfModMatrixCollect(plan, state, (eTfModMatrix::Output)(eTfModMatrix::OUTPUT_MOD1 + i));
+    }
+
+    // dense outputs for the consumers, unrouted ones stay at one
+    for(eU32 i=0;i<eTfModMatrix::OUTPUT_COUNT;i++)
+        state.outputs[i] = 1.0f;
+
+    for(eU32 i=0;i<plan.routedCount;i++)
+    {
+        eTfModMatrix::Output output = (eTfModMatrix::Output)plan.routed[i];
+        state.outputs[output] = eTfModMatrixCollect(plan, state, output);
     }
 
 	return playing1 || playing2;
@@ -491,6 +704,9 @@ eBool eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &s
 
 eF32 eTfModMatrixGet(eTfModMatrix &state, eTfModMatrix::Output output, eTfModMatrix::Range range)
 {
+    if (range == eTfModMatrix::MMR_ONE_TO_ZERO)
+        return state.outputs[output];
+
     eF32 value = 1.0f;
 
     for(eU32 i=0; i<TF_MODMATRIXENTRIES; i++)
@@ -549,6 +765,14 @@ void eTfModMatrixPanic(eTfModMatrix &state)
 // GENERATOR
 // ------------------------------------------------------------------------------------
 
+// converts a phase (increment) in cycles to 32 bit fixed point,
+// where 2^32 is one full cycle.
+static eU32 eTfPhaseToFixed(eF32 phase)
+{
+    phase -= (eF32)eFtoL(phase);
+    return (eU32)eFtoL(phase * 2147483648.0f) << 1;
+}
+
 void eTfGeneratorReset(eTfGenerator &state)
 {
     eRandom rand;
@@ -558,259 +782,1409 @@ void eTfGeneratorReset(eTfGenerator &state)
 	{
         eF32 base = rand.NextFloat();
 		eF32 off = rand.NextFloat()*0.1f;
-        state.phase[i*2] = base;
-		state.phase[i*2+1] = base+off;
+        state.phase[i*2] = eTfPhaseToFixed(base);
+		state.phase[i*2+1] = eTfPhaseToFixed(base+off);
 	}
 
     state.modulation = rand.NextFloat(0.0f, 100.0f);
     state.freq1 = state.freq2 = 0.0f;
+
+#ifdef eTF_ASYNC_SPECTRUM
+    state.serial++;
+#endif
 }
 
-void eTfGeneratorNormalize(eF32 *buffer, eU32 frameSize)
+void eTfFftPlanInit(eTfFftPlan &plan, eU32 size)
 {
-    eF32 max = 0.0;
-    eF32 *smp = buffer;
-    eU32 len = frameSize;
+    eASSERT(size >= 32 && size <= TF_FFT_MAXSIZE);
 
-	// normalize the signal
-	// ------------------------------------------
-    while(len--)
+    const eU32 half = size / 2;
+    eU32 bits = 0;
+    while ((1U << bits) < half)
+        bits++;
+
+    plan.size = size;
+
+    for (eU32 i=0; i<half; i++)
     {
-        eF32 abs_smp = eAbs(*smp);
-        if (abs_smp > max) max = abs_smp;
-        smp += 2;
+        eU32 rev = 0;
+        for (eU32 b=0; b<bits; b++)
+        {
+            if (i & (1 << b))
+                rev |= 1 << (bits - 1 - b);
+        }
+
+        plan.bitReverse[i] = rev;
+        eSinCos(eTWOPI * (eF32)i / (eF32)size, plan.postIm[i], plan.postRe[i]);
     }
 
-    if (max<1e-5f) max=1e-5f;
-    max = 1.0f/max;
-    smp = buffer;
-    len = frameSize;
+    // twiddles of the radix-4 passes (stage pairs h and 2h) followed
+    // by the ones of a trailing radix-2 pass, if the stage count is odd
+    eF32 *twr = plan.twiddleRe;
+    eF32 *twi = plan.twiddleIm;
+    eU32 h = 4;
 
-	eF32 avg = 0.0f;
-    while(len--)
+    for (; h*4 <= half; h *= 4)
     {
-        *smp *= max;
-		avg += *smp;
-        smp += 2;
-    }
+        for (eU32 j=0; j<h; j++)
+        {
+            eSinCos(ePI * (eF32)j / (eF32)h, twi[j], twr[j]);
+            eSinCos(ePI * (eF32)j / (eF32)(h*2), twi[h+j], twr[h+j]);
+        }
 
-	// center the signal
-	// ------------------------------------------
-	avg /= frameSize;
-	smp = buffer;
-	len = frameSize;
+        twr += h*2;
+        twi += h*2;
+    }
 
-	while(len--)
-	{
-		*smp -= avg;
-		smp += 2;
-	}
+    for (eU32 j=0; j<h && h<half; j++)
+        eSinCos(ePI * (eF32)j / (eF32)h, twi[j], twr[j]);
 }
 
-void eTfGeneratorFft(eTfFftType type, eU32 frameSize, eF32 *fftBuffer)
+// real-valued inverse FFT of an interleaved complex spectrum. only
+// the real part of the output is ever read, so the spectrum is folded
+// into its hermitian part and transformed as a half size complex FFT.
+// the output is centered around zero and scaled by the given gain,
+// or normalized to [-1..1] if it's zero. returns the applied gain.
+eF32 eTfGeneratorIfft(const eTfFftPlan &plan, const eF32 *spectrum, eF32 *result, eF32 gain)
 {
-    eInt sign = (eInt)type;
-    eF32 wr, wi, arg, *p1, *p2, temp;
-    eF32 tr, ti, ur, ui, *p1r, *p1i, *p2r, *p2i;
-    eInt i, bitm, j, le, le2, k;
-    eF32 fsign = (eF32)sign;
-    eF32 sine, cosine;
-    eInt count = eFtoL(eLog10((eF32)frameSize)/eLog10(2.0f));
+    const eU32 size = plan.size;
+    const eU32 half = size / 2;
+    eF32 re[TF_FFT_MAXSIZE/2];
+    eF32 im[TF_FFT_MAXSIZE/2];
+
+	// fold & pack the spectrum in bit-reversed order
+	// ------------------------------------------
+    for (eU32 k=0; k<half; k++)
+    {
+        const eF32 *x0 = &spectrum[k*2];
+        const eF32 *x1 = &spectrum[((size - k) & (size - 1))*2];
+        const eF32 *x2 = &spectrum[(k + half)*2];
+        const eF32 *x3 = &spectrum[(half - k)*2];
+
+        // H[k] = X[k] + conj(X[N-k]), H[k+N/2] = X[k+N/2] + conj(X[N/2-k])
+        eF32 hr0 = x0[0] + x1[0];
+        eF32 hi0 = x0[1] - x1[1];
+        eF32 hr1 = x2[0] + x3[0];
+        eF32 hi1 = x2[1] - x3[1];
+
+        // even part H[k]+H[k+N/2], odd part (H[k]-H[k+N/2])*e^(2*pi*i*k/N)
+        eF32 evenRe = hr0 + hr1;
+        eF32 evenIm = hi0 + hi1;
+        eF32 diffRe = hr0 - hr1;
+        eF32 diffIm = hi0 - hi1;
+        eF32 oddRe = diffRe * plan.postRe[k] - diffIm * plan.postIm[k];
+        eF32 oddIm = diffRe * plan.postIm[k] + diffIm * plan.postRe[k];
+
+        eU32 dst = plan.bitReverse[k];
+        re[dst] = (evenRe - oddIm) * 0.5f;
+        im[dst] = (evenIm + oddRe) * 0.5f;
+    }
+
+	// first two stages as radix-4 on groups of four
+	// ------------------------------------------
+    for (eU32 i=0; i<half; i+=16)
+    {
+        eF32x4 r0 = eSimdLoad(&re[i]);
+        eF32x4 r1 = eSimdLoad(&re[i+4]);
+        eF32x4 r2 = eSimdLoad(&re[i+8]);
+        eF32x4 r3 = eSimdLoad(&re[i+12]);
+        eF32x4 i0 = eSimdLoad(&im[i]);
+        eF32x4 i1 = eSimdLoad(&im[i+4]);
+        eF32x4 i2 = eSimdLoad(&im[i+8]);
+        eF32x4 i3 = eSimdLoad(&im[i+12]);
+        eSimdTranspose(r0, r1, r2, r3);
+        eSimdTranspose(i0, i1, i2, i3);
+
+        eF32x4 tr0 = eSimdAdd(r0, r1), ti0 = eSimdAdd(i0, i1);
+        eF32x4 tr1 = eSimdSub(r0, r1), ti1 = eSimdSub(i0, i1);
+        eF32x4 tr2 = eSimdAdd(r2, r3), ti2 = eSimdAdd(i2, i3);
+        eF32x4 tr3 = eSimdSub(r2, r3), ti3 = eSimdSub(i2, i3);
+
+        r0 = eSimdAdd(tr0, tr2); i0 = eSimdAdd(ti0, ti2);
+        r2 = eSimdSub(tr0, tr2); i2 = eSimdSub(ti0, ti2);
+        r1 = eSimdSub(tr1, ti3); i1 = eSimdAdd(ti1, tr3);
+        r3 = eSimdAdd(tr1, ti3); i3 = eSimdSub(ti1, tr3);
+
+        eSimdTranspose(r0, r1, r2, r3);
+        eSimdTranspose(i0, i1, i2, i3);
+        eSimdStore(r0, &re[i]);
+        eSimdStore(r1, &re[i+4]);
+        eSimdStore(r2, &re[i+8]);
+        eSimdStore(r3, &re[i+12]);
+        eSimdStore(i0, &im[i]);
+        eSimdStore(i1, &im[i+4]);
+        eSimdStore(i2, &im[i+8]);
+        eSimdStore(i3, &im[i+12]);
+    }
+
+	// remaining stages as radix-4 passes
+	// ------------------------------------------
+    const eF32 *twr = plan.twiddleRe;
+    const eF32 *twi = plan.twiddleIm;
+    eU32 h = 4;
 
-    for (i = 2; i < (eInt)(2*frameSize-2); i += 2)
+    for (; h*4 <= half; h *= 4)
     {
-        for (bitm = 2, j = 0; bitm < (eInt)(2*frameSize); bitm <<= 1)
+        for (eU32 base=0; base<half; base+=h*4)
         {
-            if (i & bitm) j++;
-            j <<= 1;
+            for (eU32 j=0; j<h; j+=4)
+            {
+                eF32 *ar = &re[base+j];
+                eF32 *ai = &im[base+j];
+
+                eF32x4 w1r = eSimdLoad(&twr[j]);
+                eF32x4 w1i = eSimdLoad(&twi[j]);
+                eF32x4 w2r = eSimdLoad(&twr[h+j]);
+                eF32x4 w2i = eSimdLoad(&twi[h+j]);
+
+                eF32x4 xr0 = eSimdLoad(ar);
+                eF32x4 xi0 = eSimdLoad(ai);
+                eF32x4 xr1 = eSimdLoad(ar+h);
+                eF32x4 xi1 = eSimdLoad(ai+h);
+                eF32x4 xr2 = eSimdLoad(ar+h*2);
+                eF32x4 xi2 = eSimdLoad(ai+h*2);
+                eF32x4 xr3 = eSimdLoad(ar+h*3);
+                eF32x4 xi3 = eSimdLoad(ai+h*3);
+
+                // stage h: pairs (0,1) and (2,3)
+                eF32x4 br = eSimdNfma(eSimdMul(w1r, xr1), w1i, xi1);
+                eF32x4 bi = eSimdFma(eSimdMul(w1r, xi1), w1i, xr1);
+                eF32x4 dr = eSimdNfma(eSimdMul(w1r, xr3), w1i, xi3);
+                eF32x4 di = eSimdFma(eSimdMul(w1r, xi3), w1i, xr3);
+
+                xr1 = eSimdSub(xr0, br); xi1 = eSimdSub(xi0, bi);
+                xr0 = eSimdAdd(xr0, br); xi0 = eSimdAdd(xi0, bi);
+                xr3 = eSimdSub(xr2, dr); xi3 = eSimdSub(xi2, di);
+                xr2 = eSimdAdd(xr2, dr); xi2 = eSimdAdd(xi2, di);
+
+                // stage 2h: pairs (0,2) and (1,3), the latter with i*w2
+                eF32x4 cr = eSimdNfma(eSimdMul(w2r, xr2), w2i, xi2);
+                eF32x4 ci = eSimdFma(eSimdMul(w2r, xi2), w2i, xr2);
+                dr = eSimdNfma(eSimdMul(w2r, xr3), w2i, xi3);
+                di = eSimdFma(eSimdMul(w2r, xi3), w2i, xr3);
+
+                eSimdStore(eSimdAdd(xr0, cr), ar);
+                eSimdStore(eSimdAdd(xi0, ci), ai);
+                eSimdStore(eSimdSub(xr1, di), ar+h);
+                eSimdStore(eSimdAdd(xi1, dr), ai+h);
+                eSimdStore(eSimdSub(xr0, cr), ar+h*2);
+                eSimdStore(eSimdSub(xi0, ci), ai+h*2);
+                eSimdStore(eSimdAdd(xr1, di), ar+h*3);
+                eSimdStore(eSimdSub(xi1, dr), ai+h*3);
+            }
         }
 
-        if (i < j)
+        twr += h*2;
+        twi += h*2;
+    }
+
+	// trailing radix-2 stage (odd stage count only)
+	// ------------------------------------------
+    if (h < half)
+    {
+        for (eU32 j=0; j<h; j+=4)
         {
-            p1 = fftBuffer+i; p2 = fftBuffer+j;
-            temp = *p1; *(p1++) = *p2;
-            *(p2++) = temp; temp = *p1;
-            *p1 = *p2; *p2 = temp;
+            eF32x4 wr = eSimdLoad(&twr[j]);
+            eF32x4 wi = eSimdLoad(&twi[j]);
+            eF32x4 xr0 = eSimdLoad(&re[j]);
+            eF32x4 xi0 = eSimdLoad(&im[j]);
+            eF32x4 xr1 = eSimdLoad(&re[j+h]);
+            eF32x4 xi1 = eSimdLoad(&im[j+h]);
+
+            eF32x4 tr = eSimdNfma(eSimdMul(wr, xr1), wi, xi1);
+            eF32x4 ti = eSimdFma(eSimdMul(wr, xi1), wi, xr1);
+
+            eSimdStore(eSimdAdd(xr0, tr), &re[j]);
+            eSimdStore(eSimdAdd(xi0, ti), &im[j]);
+            eSimdStore(eSimdSub(xr0, tr), &re[j+h]);
+            eSimdStore(eSimdSub(xi0, ti), &im[j+h]);
         }
     }
-    for (k = 0, le = 2; k < count; k++)
+
+	// unpack even/odd samples, then normalize
+	// and center the signal in one more pass
+	// ------------------------------------------
+    eF32x4 peak = eSimdZero();
+    eF32x4 sum = eSimdZero();
+
+    for (eU32 i=0; i<half; i+=4)
     {
-        le <<= 1;
-        le2 = le>>1;
-        ur = 1.0;
-        ui = 0.0;
-        arg = ePI / (le2>>1);
+        eF32x4 r = eSimdLoad(&re[i]);
+        eF32x4 m = eSimdLoad(&im[i]);
+        eF32x4 lo = eSimdUnpackLo(r, m);
+        eF32x4 hi = eSimdUnpackHi(r, m);
 
-        eSinCos(arg, sine, cosine);
-        wr = cosine;
-        wi = fsign * sine;
+        peak = eSimdMax(peak, eSimdMax(eSimdAbs(lo), eSimdAbs(hi)));
+        sum = eSimdAdd(sum, eSimdAdd(lo, hi));
 
-        for (j = 0; j < le2; j += 2)
-        {
-            p1r = fftBuffer+j; p1i = p1r+1;
-            p2r = p1r+le2; p2i = p2r+1;
+        eSimdStore(lo, &result[i*2]);
+        eSimdStore(hi, &result[i*2+4]);
+    }
 
-            for (i = j; i < (eInt)(2*frameSize); i += le)
-            {
-                tr = *p2r * ur - *p2i * ui;
-                ti = *p2r * ui + *p2i * ur;
-                *p2r = *p1r - tr; *p2i = *p1i - ti;
-                *p1r += tr; *p1i += ti;
-                p1r += le; p1i += le;
-                p2r += le; p2i += le;
-            }
+    eF32 peaks[4], sums[4];
+    eSimdStore(peak, peaks);
+    eSimdStore(sum, sums);
 
-            tr = ur*wr - ui*wi;
-            ui = ur*wi + ui*wr;
-            ur = tr;
-        }
+    if (gain <= 0.0f)
+    {
+        eF32 max = eMax(eMax(peaks[0], peaks[1]), eMax(peaks[2], peaks[3]));
+        if (max < 1e-5f) max = 1e-5f;
+        gain = 1.0f / max;
     }
+
+    eF32 avg = (sums[0] + sums[1] + sums[2] + sums[3]) * gain / (eF32)size;
+    eF32x4 mscale = eSimdSetAll4(gain);
+    eF32x4 mavg = eSimdSetAll4(avg);
+
+    for (eU32 i=0; i<size; i+=4)
+        eSimdStore(eSimdSub(eSimdMul(eSimdLoad(&result[i]), mscale), mavg), &result[i]);
+
+    return gain;
 }
 
-void eTfGeneratorUpdate(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 frequencyRange)
+// builds all mip levels of a wavetable. every level is the inverse FFT
+// of the spectrum cut off above its highest harmonic (after folding),
+// with the bins wrapped into the level's table size. all levels share
+// the gain of the first one, so switching levels keeps the loudness.
+void eTfGeneratorBuildMips(eTfSynth &synth, const eF32 *spectrum, eF32 *mips)
 {
-    eU32 frameSize = TF_IFFT_FRAMESIZE * 2;
-    eU32 frameSizeHalf = frameSize / 2;
-    eU32 genFrameSize = eFtoL(eF32(frameSizeHalf) * frequencyRange);
-
-    if (genFrameSize < 4)
-        genFrameSize = 4;
+    eF32 gain = eTfGeneratorIfft(synth.ifftPlan, spectrum, mips, 0.0f);
+    eF32 levelSpectrum[TF_IFFT_FRAMESIZE*2];
 
-    eF32 harmonics  = instr.params[TF_GEN_NUMHARMONICS];
-    eF32 bandwidth  = instr.params[TF_GEN_BANDWIDTH];
-    eF32 scale      = instr.params[TF_GEN_SCALE]* 4.0f;
-    eF32 damp       = instr.params[TF_GEN_DAMP];
+    for (eU32 level=1; level<TF_WAVETABLE_MIPLEVELS; level++)
+    {
+        eU32 size = TF_WAVETABLE_MIPLENGTH[level];
+        eU32 cutoff = (TF_IFFT_FRAMESIZE/2) >> level;
+        const eTfFftPlan &plan = (size == TF_IFFT_FRAMESIZE) ? synth.ifftPlan :
+                                 (size == TF_IFFT_FRAMESIZE/2) ? synth.mipPlans[0] :
+                                 (size == TF_IFFT_FRAMESIZE/4) ? synth.mipPlans[1] : synth.mipPlans[2];
 
-    harmonics   *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_NUMHARMONICS);
-    bandwidth   *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_BANDWIDTH);
-    damp        *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_DAMP);
-    scale       *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_SCALE);
+        eMemSet(levelSpectrum, 0, sizeof(eF32) * size * 2);
+        eMemCopy(levelSpectrum, spectrum, sizeof(eF32) * (cutoff+1) * 2);
+        eMemCopy(&levelSpectrum[(size-cutoff)*2], &spectrum[(TF_IFFT_FRAMESIZE-cutoff)*2], sizeof(eF32) * cutoff * 2);
 
-    harmonics   = eClamp<eF32>(0.0f, harmonics, 1.0f);
-    bandwidth   = eClamp<eF32>(0.0f, bandwidth, 1.0f);
-    damp        = eClamp<eF32>(0.0f, damp, 1.0f);
-    scale       = eClamp<eF32>(0.0f, scale, 4.0f);
+        eTfGeneratorIfft(plan, levelSpectrum, &mips[TF_WAVETABLE_MIPOFFSET[level]], gain);
+    }
+}
 
-    eU32 numHarmonics = 1+eMin((eU32)eFtoL(harmonics * TF_MAX_HARMONICS), TF_MAX_HARMONICS);
+// eTfGeneratorBuildMips() for all wavetables of a batch at once
+static void eTfGeneratorBuildMipsBatch(eTfSynth &synth, eTfSpectrumBatch &batch)
+{
+    eF32 *results[TF_SPECTRUM_BATCH];
+    eF32 gains[TF_SPECTRUM_BATCH];
 
-    if (generator.activeNumHarmonics != numHarmonics ||
-        generator.activeGenSize != genFrameSize ||
-        !eIsFloatZero(generator.activeDamp - damp) ||
-        !eIsFloatZero(generator.activeScale - scale) ||
-        !eIsFloatZero(generator.activeBandwidth - bandwidth))
+    // interleave the spectra, unused lanes stay silent
+    for (eU32 l=0; l<TF_SPECTRUM_BATCH; l++)
     {
-        eMemSet(generator.freqTable, 0, sizeof(eF32) * frameSize * 2);
-
-        eF32 harmonicOffset[256];
-        eF32 harmonicBandwidth[256];
-        eF32 harmonicVolume[256];
+        const eF32 *spectrum = batch.spectra[l];
+        eBool used = (l < batch.count);
 
-        for (eU32 harmonicIndex=1; harmonicIndex < numHarmonics + 1; harmonicIndex++)
+        for (eU32 i=0; i<TF_IFFT_FRAMESIZE; i++)
         {
-            eF32 invHarmonicFrequency = (1.0f / TF_IFFT_FRAMESIZE) * harmonicIndex;
-            harmonicOffset[harmonicIndex-1] = (((invHarmonicFrequency * frameSize) - 1.0f) * scale) + 1.0f;
-            harmonicBandwidth[harmonicIndex-1] = 0.3f + (bandwidth * harmonicIndex);
-            harmonicVolume[harmonicIndex-1] = 1.0f / ePow((eF32)harmonicIndex, 1.0f + damp);
+            batch.lanes[i*8+l] = used ? spectrum[i*2] : 0.0f;
+            batch.lanes[i*8+4+l] = used ? spectrum[i*2+1] : 0.0f;
         }
 
-        eF32 *writePtr = generator.freqTable;
-        for (eU32 i=0; i<genFrameSize; i++)
-        {
-            eF32 amp = 0.0f;
-
-            eF32 *offsetPtr = harmonicOffset;
-            eF32 *bandwidthPtr = harmonicBandwidth;
-            eF32 *volumePtr = harmonicVolume;
-
-            for (eU32 harmonicIndex=0; harmonicIndex < numHarmonics; harmonicIndex++)
-            {
-                eF32 dist = eAbs(*offsetPtr - (eF32)i);
-                dist /= *bandwidthPtr;
+        results[l] = used ? batch.targets[l] : nullptr;
+        gains[l] = 0.0f;
+    }
 
-                if (dist < 5.0f)
-                {
-                    eU32 expLookup = eFtoL(dist / 5.0f * (TF_MAXFRAMESIZE-1));
-                    eF32 exp = synth.expBuffer[expLookup];
-                    exp *= *volumePtr;
-                    amp += exp;
-                }
+    eTfGeneratorIfftBatch(synth.ifftPlan, batch.lanes, results, gains);
 
-                offsetPtr++;
-                bandwidthPtr++;
-                volumePtr++;
-            }
+    for (eU32 level=1; level<TF_WAVETABLE_MIPLEVELS; level++)
+    {
+        eU32 size = TF_WAVETABLE_MIPLENGTH[level];
+        eU32 cutoff = (TF_IFFT_FRAMESIZE/2) >> level;
+        const eTfFftPlan &plan = (size == TF_IFFT_FRAMESIZE) ? synth.ifftPlan :
+                                 (size == TF_IFFT_FRAMESIZE/2) ? synth.mipPlans[0] :
+                                 (size == TF_IFFT_FRAMESIZE/4) ? synth.mipPlans[1] : synth.mipPlans[2];
 
-            *writePtr++ = amp;
-            *writePtr++ = amp;
-        }
+        eMemSet(batch.levelLanes, 0, sizeof(eF32) * size * 8);
+        eMemCopy(batch.levelLanes, batch.lanes, sizeof(eF32) * (cutoff+1) * 8);
+        eMemCopy(&batch.levelLanes[(size-cutoff)*8], &batch.lanes[(TF_IFFT_FRAMESIZE-cutoff)*8], sizeof(eF32) * cutoff * 8);
 
-        generator.freqTable[0] = 1.0f;
-        generator.freqTable[1] = 0.0f;
+        eF32 *levelResults[TF_SPECTRUM_BATCH];
+        for (eU32 l=0; l<TF_SPECTRUM_BATCH; l++)
+            levelResults[l] = results[l] ? results[l] + TF_WAVETABLE_MIPOFFSET[level] : nullptr;
 
-        generator.activeBandwidth = bandwidth;
-        generator.activeDamp = damp;
-        generator.activeScale = scale;
-        generator.activeNumHarmonics = numHarmonics;
-        generator.activeGenSize = genFrameSize;
+        eTfGeneratorIfftBatch(plan, batch.levelLanes, levelResults, gains);
     }
 }
 
-eBool eTfGeneratorModulate(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator)
+// renders the wavetables collected in the batch. a single one
+// goes through the plain transform, more run lane parallel.
+void eTfSpectrumBatchRender(eTfSynth &synth, eTfSpectrumBatch &batch)
 {
-    if (eIsFloatZero(generator.modulation))
-        return eFALSE;
+    if (batch.count == 1)
+        eTfGeneratorBuildMips(synth, batch.spectra[0], batch.targets[0]);
+    else if (batch.count > 1)
+        eTfGeneratorBuildMipsBatch(synth, batch);
 
-    eU32 frameSize = TF_IFFT_FRAMESIZE * 2;
-    eU32 frameSizeHalf = frameSize / 2;
+    batch.count = 0;
+}
 
-    eF32 random = instr.params[TF_GEN_MODULATION];
-    eBool randomizationOn = !eIsFloatZero(instr.params[TF_GEN_MODULATION]);
-    eF32 modulation = ePow(random, 3);
+// returns the spectrum to fill in for a wavetable that's rendered
+// into target by the next eTfSpectrumBatchRender(). full batches
+// are rendered right away.
+static eF32 * eTfSpectrumBatchAdd(eTfSynth &synth, eTfSpectrumBatch &batch, eF32 *target)
+{
+    if (batch.count == TF_SPECTRUM_BATCH)
+        eTfSpectrumBatchRender(synth, batch);
 
-    eF32 *readPtr = generator.freqTable;
-    eF32 *writePtr = generator.freqModTable;
-    eF32 *randPtr = synth.randomBuffer;
+    batch.targets[batch.count] = target;
+    return batch.spectra[batch.count++];
+}
 
-    for (eU32 i=0; i<frameSizeHalf; i++)
-    {
-        eF32 modulationStrength = static_cast<eF32>(i) / static_cast<eF32>(frameSizeHalf);
+// the same inverse FFT as above for TF_SPECTRUM_BATCH spectra at
+// once. the spectra are lane interleaved (bin, re/im, lane), so every
+// step is plain vector code with one spectrum per lane. gains holds
+// the gain of every lane, zero to normalize it, and receives the
+// applied ones. results of lanes without output may be nullptr.
+void eTfGeneratorIfftBatch(const eTfFftPlan &plan, const eF32 *spectra, eF32 **results, eF32 *gains)
+{
+    const eU32 size = plan.size;
+    const eU32 half = size / 2;
+    eF32 re[TF_IFFT_FRAMESIZE/2*TF_SPECTRUM_BATCH];
+    eF32 im[TF_IFFT_FRAMESIZE/2*TF_SPECTRUM_BATCH];
 
-        eF32 sineOffset = 0.0f;
-        if (randomizationOn)
-            sineOffset = (generator.modulation * TF_FRAMESIZE) * (1.0f - (random * *randPtr++));
+    eASSERT(size <= TF_IFFT_FRAMESIZE);
 
-        eU32 sinLookup = eFtoL(sineOffset * modulationStrength) % TF_FRAMESIZE;
-        eU32 cosLookup = (sinLookup + TF_FRAMESIZE/4) % TF_FRAMESIZE;
+	// fold & pack the spectra in bit-reversed order
+	// ------------------------------------------
+    const eF32x4 mhalf = eSimdSetAll4(0.5f);
 
-        *writePtr++ = *readPtr++ * synth.sinBuffer[sinLookup];
-        *writePtr++ = *readPtr++ * synth.sinBuffer[cosLookup];
+    for (eU32 k=0; k<half; k++)
+    {
+        const eF32 *x0 = &spectra[k*8];
+        const eF32 *x1 = &spectra[((size - k) & (size - 1))*8];
+        const eF32 *x2 = &spectra[(k + half)*8];
+        const eF32 *x3 = &spectra[(half - k)*8];
+
+        eF32x4 hr0 = eSimdAdd(eSimdLoad(x0), eSimdLoad(x1));
+        eF32x4 hi0 = eSimdSub(eSimdLoad(x0+4), eSimdLoad(x1+4));
+        eF32x4 hr1 = eSimdAdd(eSimdLoad(x2), eSimdLoad(x3));
+        eF32x4 hi1 = eSimdSub(eSimdLoad(x2+4), eSimdLoad(x3+4));
+
+        eF32x4 postRe = eSimdSetAll4(plan.postRe[k]);
+        eF32x4 postIm = eSimdSetAll4(plan.postIm[k]);
+        eF32x4 evenRe = eSimdAdd(hr0, hr1);
+        eF32x4 evenIm = eSimdAdd(hi0, hi1);
+        eF32x4 diffRe = eSimdSub(hr0, hr1);
+        eF32x4 diffIm = eSimdSub(hi0, hi1);
+        eF32x4 oddRe = eSimdSub(eSimdMul(diffRe, postRe), eSimdMul(diffIm, postIm));
+        eF32x4 oddIm = eSimdAdd(eSimdMul(diffRe, postIm), eSimdMul(diffIm, postRe));
+
+        eU32 dst = plan.bitReverse[k]*4;
+        eSimdStore(eSimdMul(eSimdSub(evenRe, oddIm), mhalf), &re[dst]);
+        eSimdStore(eSimdMul(eSimdAdd(evenIm, oddRe), mhalf), &im[dst]);
     }
 
-    generator.freqModTable[0] = 1.0f;
-    generator.freqModTable[1] = 0.0f;
+	// first two stages as radix-4 on groups of four
+	// ------------------------------------------
+    for (eU32 i=0; i<half*4; i+=16)
+    {
+        eF32x4 r0 = eSimdLoad(&re[i]), i0 = eSimdLoad(&im[i]);
+        eF32x4 r1 = eSimdLoad(&re[i+4]), i1 = eSimdLoad(&im[i+4]);
+        eF32x4 r2 = eSimdLoad(&re[i+8]), i2 = eSimdLoad(&im[i+8]);
+        eF32x4 r3 = eSimdLoad(&re[i+12]), i3 = eSimdLoad(&im[i+12]);
+
+        eF32x4 tr0 = eSimdAdd(r0, r1), ti0 = eSimdAdd(i0, i1);
+        eF32x4 tr1 = eSimdSub(r0, r1), ti1 = eSimdSub(i0, i1);
+        eF32x4 tr2 = eSimdAdd(r2, r3), ti2 = eSimdAdd(i2, i3);
+        eF32x4 tr3 = eSimdSub(r2, r3), ti3 = eSimdSub(i2, i3);
+
+        eSimdStore(eSimdAdd(tr0, tr2), &re[i]);
+        eSimdStore(eSimdAdd(ti0, ti2), &im[i]);
+        eSimdStore(eSimdSub(tr1, ti3), &re[i+4]);
+        eSimdStore(eSimdAdd(ti1, tr3), &im[i+4]);
+        eSimdStore(eSimdSub(tr0, tr2), &re[i+8]);
+        eSimdStore(eSimdSub(ti0, ti2), &im[i+8]);
+        eSimdStore(eSimdAdd(tr1, ti3), &re[i+12]);
+        eSimdStore(eSimdSub(ti1, tr3), &im[i+12]);
+    }
 
-    generator.modulation += modulation / 100.0f;
-    if (generator.modulation >= 100.0f)
-        generator.modulation -= 100.0f;
+	// remaining stages as radix-4 passes
+	// ------------------------------------------
+    const eF32 *twr = plan.twiddleRe;
+    const eF32 *twi = plan.twiddleIm;
+    eU32 h = 4;
 
-    return eTRUE;
-}
+    for (; h*4 <= half; h *= 4)
+    {
+        for (eU32 base=0; base<half; base+=h*4)
+        {
+            for (eU32 j=0; j<h; j++)
+            {
+                eF32 *ar = &re[(base+j)*4];
+                eF32 *ai = &im[(base+j)*4];
+                const eU32 step = h*4;
+
+                eF32x4 w1r = eSimdSetAll4(twr[j]);
+                eF32x4 w1i = eSimdSetAll4(twi[j]);
+                eF32x4 w2r = eSimdSetAll4(twr[h+j]);
+                eF32x4 w2i = eSimdSetAll4(twi[h+j]);
+
+                eF32x4 xr0 = eSimdLoad(ar);
+                eF32x4 xi0 = eSimdLoad(ai);
+                eF32x4 xr1 = eSimdLoad(ar+step);
+                eF32x4 xi1 = eSimdLoad(ai+step);
+                eF32x4 xr2 = eSimdLoad(ar+step*2);
+                eF32x4 xi2 = eSimdLoad(ai+step*2);
+                eF32x4 xr3 = eSimdLoad(ar+step*3);
+                eF32x4 xi3 = eSimdLoad(ai+step*3);
+
+                eF32x4 br = eSimdNfma(eSimdMul(w1r, xr1), w1i, xi1);
+                eF32x4 bi = eSimdFma(eSimdMul(w1r, xi1), w1i, xr1);
+                eF32x4 dr = eSimdNfma(eSimdMul(w1r, xr3), w1i, xi3);
+                eF32x4 di = eSimdFma(eSimdMul(w1r, xi3), w1i, xr3);
+
+                xr1 = eSimdSub(xr0, br); xi1 = eSimdSub(xi0, bi);
+                xr0 = eSimdAdd(xr0, br); xi0 = eSimdAdd(xi0, bi);
+                xr3 = eSimdSub(xr2, dr); xi3 = eSimdSub(xi2, di);
+                xr2 = eSimdAdd(xr2, dr); xi2 = eSimdAdd(xi2, di);
+
+                eF32x4 cr = eSimdNfma(eSimdMul(w2r, xr2), w2i, xi2);
+                eF32x4 ci = eSimdFma(eSimdMul(w2r, xi2), w2i, xr2);
+                dr = eSimdNfma(eSimdMul(w2r, xr3), w2i, xi3);
+                di = eSimdFma(eSimdMul(w2r, xi3), w2i, xr3);
+
+                eSimdStore(eSimdAdd(xr0, cr), ar);
+                eSimdStore(eSimdAdd(xi0, ci), ai);
+                eSimdStore(eSimdSub(xr1, di), ar+step);
+                eSimdStore(eSimdAdd(xi1, dr), ai+step);
+                eSimdStore(eSimdSub(xr0, cr), ar+step*2);
+                eSimdStore(eSimdSub(xi0, ci), ai+step*2);
+                eSimdStore(eSimdAdd(xr1, di), ar+step*3);
+                eSimdStore(eSimdSub(xi1, dr), ai+step*3);
+            }
+        }
 
-eBool eTfGeneratorProcess(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 velocity, eF32 **signal, eU32 frameSize)
-{
-    eF32 vol = instr.params[TF_GEN_VOLUME] * 4.0f * velocity;
-    eF32 maxCurrentVolume = eMax(voice.lastVolL, voice.lastVolR);
-    eF32 maxFrameVolume = eMax(maxCurrentVolume, vol);
+        twr += h*2;
+        twi += h*2;
+    }
 
-    if (maxFrameVolume > 0.0f)
+	// trailing radix-2 stage (odd stage count only)
+	// ------------------------------------------
+    if (h < half)
     {
-        eF32 freq       = instr.params[TF_GEN_FREQ];
-        eF32 panning    = instr.params[TF_GEN_PANNING];
-        eF32 drive      = instr.params[TF_GEN_DRIVE];
+        for (eU32 j=0; j<h; j++)
+        {
+            eF32x4 wr = eSimdSetAll4(twr[j]);
+            eF32x4 wi = eSimdSetAll4(twi[j]);
+            eF32x4 xr0 = eSimdLoad(&re[j*4]);
+            eF32x4 xi0 = eSimdLoad(&im[j*4]);
+            eF32x4 xr1 = eSimdLoad(&re[(j+h)*4]);
+            eF32x4 xi1 = eSimdLoad(&im[(j+h)*4]);
+
+            eF32x4 tr = eSimdNfma(eSimdMul(wr, xr1), wi, xi1);
+            eF32x4 ti = eSimdFma(eSimdMul(wr, xi1), wi, xr1);
+
+            eSimdStore(eSimdAdd(xr0, tr), &re[j*4]);
+            eSimdStore(eSimdAdd(xi0, ti), &im[j*4]);
+            eSimdStore(eSimdSub(xr0, tr), &re[(j+h)*4]);
+            eSimdStore(eSimdSub(xi0, ti), &im[(j+h)*4]);
+        }
+    }
+
+	// per lane peak and sum, then normalize, center and
+	// transpose every four samples back to the tables
+	// ------------------------------------------
+    eF32x4 peak = eSimdZero();
+    eF32x4 sum = eSimdZero();
+
+    for (eU32 i=0; i<half*4; i+=4)
+    {
+        eF32x4 r = eSimdLoad(&re[i]);
+        eF32x4 m = eSimdLoad(&im[i]);
+        peak = eSimdMax(peak, eSimdMax(eSimdAbs(r), eSimdAbs(m)));
+        sum = eSimdAdd(sum, eSimdAdd(r, m));
+    }
+
+    eF32 peaks[4], sums[4];
+    eSimdStore(peak, peaks);
+    eSimdStore(sum, sums);
+
+    for (eU32 l=0; l<TF_SPECTRUM_BATCH; l++)
+    {
+        if (gains[l] <= 0.0f)
+            gains[l] = 1.0f / eMax(peaks[l], 1e-5f);
+
+        sums[l] *= gains[l] / (eF32)size;
+    }
+
+    eF32x4 mscale = eSimdLoad(gains);
+    eF32x4 mavg = eSimdLoad(sums);
+
+    for (eU32 i=0; i<half; i+=2)
+    {
+        eF32x4 s0 = eSimdSub(eSimdMul(eSimdLoad(&re[i*4]), mscale), mavg);
+        eF32x4 s1 = eSimdSub(eSimdMul(eSimdLoad(&im[i*4]), mscale), mavg);
+        eF32x4 s2 = eSimdSub(eSimdMul(eSimdLoad(&re[i*4+4]), mscale), mavg);
+        eF32x4 s3 = eSimdSub(eSimdMul(eSimdLoad(&im[i*4+4]), mscale), mavg);
+        eSimdTranspose(s0, s1, s2, s3);
+
+        if (results[0]) eSimdStore(s0, &results[0][i*2]);
+        if (results[1]) eSimdStore(s1, &results[1][i*2]);
+        if (results[2]) eSimdStore(s2, &results[2][i*2]);
+        if (results[3]) eSimdStore(s3, &results[3][i*2]);
+    }
+}
+
+static eALIGN16 const eF32 TF_SIMD_LANEINDEX[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+// exp(-x) for 0 <= x <= 8 as (taylor polynomial of exp(-x/16))^16,
+// relative error below 1e-6.
+static eFORCEINLINE eF32x4 eTfSimdExpNeg(eF32x4 x)
+{
+    eF32x4 y = eSimdMul(x, eSimdSetAll4(-1.0f / 16.0f));
+    eF32x4 p = eSimdFma(eSimdSetAll4(1.0f / 120.0f), y, eSimdSetAll4(1.0f / 720.0f));
+    p = eSimdFma(eSimdSetAll4(1.0f / 24.0f), y, p);
+    p = eSimdFma(eSimdSetAll4(1.0f / 6.0f), y, p);
+    p = eSimdFma(eSimdSetAll4(1.0f / 2.0f), y, p);
+    p = eSimdFma(eSimdSetAll4(1.0f), y, p);
+    p = eSimdFma(eSimdSetAll4(1.0f), y, p);
+    p = eSimdMul(p, p);
+    p = eSimdMul(p, p);
+    p = eSimdMul(p, p);
+    return eSimdMul(p, p);
+}
+
+static eFORCEINLINE eF32 eTfExpNeg(eF32 x)
+{
+    eF32 y = x * (-1.0f / 16.0f);
+    eF32 p = 1.0f + y * (1.0f + y * (1.0f / 2.0f + y * (1.0f / 6.0f + y * (1.0f / 24.0f + y * (1.0f / 120.0f + y * (1.0f / 720.0f))))));
+    p *= p;
+    p *= p;
+    p *= p;
+    return p * p;
+}
+
+// sin(x) for 0 <= x <= pi/4, absolute error below 1e-6.
+static eFORCEINLINE eF32x4 eTfSimdSin(eF32x4 x)
+{
+    eF32x4 x2 = eSimdMul(x, x);
+    eF32x4 p = eSimdFma(eSimdSetAll4(1.0f / 120.0f), x2, eSimdSetAll4(-1.0f / 5040.0f));
+    p = eSimdFma(eSimdSetAll4(-1.0f / 6.0f), x2, p);
+    p = eSimdFma(eSimdSetAll4(1.0f), x2, p);
+    return eSimdMul(x, p);
+}
+
+void eTfGeneratorUpdate(eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator)
+{
+    eF32 harmonics  = instr.params[TF_GEN_NUMHARMONICS];
+    eF32 bandwidth  = instr.params[TF_GEN_BANDWIDTH];
+    eF32 scale      = instr.params[TF_GEN_SCALE]* 4.0f;
+    eF32 damp       = instr.params[TF_GEN_DAMP];
+
+    harmonics   *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_NUMHARMONICS);
+    bandwidth   *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_BANDWIDTH);
+    damp        *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_DAMP);
+    scale       *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_SCALE);
+
+    harmonics   = eClamp<eF32>(0.0f, harmonics, 1.0f);
+    bandwidth   = eClamp<eF32>(0.0f, bandwidth, 1.0f);
+    damp        = eClamp<eF32>(0.0f, damp, 1.0f);
+    scale       = eClamp<eF32>(0.0f, scale, 4.0f);
+
+    eU32 numHarmonics = 1+eMin((eU32)eFtoL(harmonics * TF_MAX_HARMONICS), TF_MAX_HARMONICS);
+
+    if (generator.activeNumHarmonics != numHarmonics ||
+        !eIsFloatZero(generator.activeDamp - damp) ||
+        !eIsFloatZero(generator.activeScale - scale) ||
+        !eIsFloatZero(generator.activeBandwidth - bandwidth))
+    {
+        generator.activeBandwidth = bandwidth;
+        generator.activeDamp = damp;
+        generator.activeScale = scale;
+        generator.activeNumHarmonics = numHarmonics;
+        generator.freqTableDirty = eTRUE;
+    }
+}
+
+static void eTfGeneratorBuildSpectrum(eTfSynth &synth, const eTfWavetableKey &key, eF32 *freqTable)
+{
+    eU32 numHarmonics = key.numHarmonics;
+    eF32x4 bandwidth = eSimdSetAll4(key.bandwidth);
+    eF32x4 scale = eSimdSetAll4(key.scale);
+    eF32x4 damp = eSimdSetAll4(key.damp);
+
+    eALIGN16 eF32 harmonicOffset[TF_MAX_HARMONICS+4];
+    eALIGN16 eF32 harmonicBandwidth[TF_MAX_HARMONICS+4];
+    eALIGN16 eF32 harmonicInvBandwidth[TF_MAX_HARMONICS+4];
+    eALIGN16 eF32 harmonicVolume[TF_MAX_HARMONICS+4];
+    eALIGN16 eF32 amps[TF_IFFT_FRAMESIZE+4];
+
+    // offset = (2n-1)*scale+1, bandwidth = 0.3+bw*n, volume = 1/n^(1+damp)
+    for (eU32 i=0; i<numHarmonics; i+=4)
+    {
+        eF32x4 n = eSimdLoad(&synth.harmonicIndex[i]);
+        eF32x4 bw = eSimdFma(eSimdSetAll4(0.3f), bandwidth, n);
+
+        eSimdStore(eSimdFma(eSimdSetAll4(1.0f), eSimdSub(eSimdAdd(n, n), eSimdSetAll4(1.0f)), scale), &harmonicOffset[i]);
+        eSimdStore(bw, &harmonicBandwidth[i]);
+        eSimdStore(eSimdDiv(eSimdSetAll4(1.0f), bw), &harmonicInvBandwidth[i]);
+        eSimdStore(eSimdMul(eSimdLoad(&synth.harmonicInv[i]), eTfSimdExpNeg(eSimdMul(damp, eSimdLoad(&synth.harmonicLog[i])))), &harmonicVolume[i]);
+    }
+
+    eMemSet(amps, 0, sizeof(amps));
+
+    // every harmonic is a exp(-dist/bandwidth) peak which is cut off
+    // at 5 bandwidths, so only the bins inside that window are touched.
+    for (eU32 h=0; h<numHarmonics; h++)
+    {
+        eF32 offset = harmonicOffset[h];
+        eF32 bw = harmonicBandwidth[h];
+        eF32 radius = 5.0f * bw;
+
+        if (offset - radius >= (eF32)TF_IFFT_FRAMESIZE)
+            continue;
+
+        eS32 first = (offset > radius) ? eFtoL(offset - radius) : 0;
+        eS32 last = eMin(eFtoL(offset + radius), (eInt)TF_IFFT_FRAMESIZE - 1);
+
+        // match the bin range exactly to the dist < 5 condition
+        while (first <= last && eAbs(offset - (eF32)first) / bw >= 5.0f)
+            first++;
+        while (first > 0 && eAbs(offset - (eF32)(first-1)) / bw < 5.0f)
+            first--;
+        while (last >= first && eAbs(offset - (eF32)last) / bw >= 5.0f)
+            last--;
+        while (last < (eS32)TF_IFFT_FRAMESIZE - 1 && eAbs(offset - (eF32)(last+1)) / bw < 5.0f)
+            last++;
+
+        eF32x4 mOffset = eSimdSetAll4(offset);
+        eF32x4 mInvBw = eSimdSetAll4(harmonicInvBandwidth[h]);
+        eF32x4 mVolume = eSimdSetAll4(harmonicVolume[h]);
+        eS32 i = first;
+
+        for (; i+3<=last; i+=4)
+        {
+            eF32x4 bins = eSimdAdd(eSimdSetAll4((eF32)i), eSimdLoad(TF_SIMD_LANEINDEX));
+            eF32x4 dist = eSimdMul(eSimdAbs(eSimdSub(mOffset, bins)), mInvBw);
+            eSimdStore(eSimdFma(eSimdLoad(&amps[i]), eTfSimdExpNeg(dist), mVolume), &amps[i]);
+        }
+
+        for (; i<=last; i++)
+            amps[i] += eTfExpNeg(eAbs(offset - (eF32)i) * harmonicInvBandwidth[h]) * harmonicVolume[h];
+    }
+
+    for (eU32 i=0; i<TF_IFFT_FRAMESIZE; i+=4)
+    {
+        eF32x4 amp = eSimdLoad(&amps[i]);
+        eSimdStore(eSimdUnpackLo(amp, amp), &freqTable[i*2]);
+        eSimdStore(eSimdUnpackHi(amp, amp), &freqTable[i*2+4]);
+    }
+
+    freqTable[0] = 1.0f;
+    freqTable[1] = 0.0f;
+}
+
+static void eTfGeneratorGetKey(const eTfGenerator &generator, eTfWavetableKey &key)
+{
+    key.numHarmonics = generator.activeNumHarmonics;
+    key.damp = generator.activeDamp;
+    key.scale = generator.activeScale;
+    key.bandwidth = generator.activeBandwidth;
+    key.modulated = !eIsFloatZero(generator.modulation);
+}
+
+// builds the spectrum of the parameters resolved in the last
+// eTfGeneratorUpdate() call, if it's not up to date already.
+const eF32 * eTfGeneratorSpectrum(eTfSynth &synth, eTfGenerator &generator)
+{
+    if (!generator.freqTableDirty)
+        return generator.freqTable;
+
+    eTfWavetableKey key;
+    eTfGeneratorGetKey(generator, key);
+    eTfGeneratorBuildSpectrum(synth, key, generator.freqTable);
+    generator.freqTableDirty = eFALSE;
+
+    return generator.freqTable;
+}
+
+// applies the phase modulation at the given modulation offset,
+// random is the instrument's TF_GEN_MODULATION parameter.
+static void eTfGeneratorModulateSpectrum(eTfSynth &synth, eF32 offset, eF32 random, const eF32 *spectrum, eF32 *modTable)
+{
+    eU32 frameSizeHalf = TF_IFFT_FRAMESIZE;
+    eBool randomizationOn = !eIsFloatZero(random);
+
+    if (!randomizationOn)
+    {
+        // all phase offsets are zero, so every bin gets the same factors
+        eF32x4 sinCos = eSimdUnpackLo(eSimdZero(), eTfSimdSin(eSimdSetAll4(eTWOPI * (TF_FRAMESIZE/4) / TF_MAXFRAMESIZE)));
+
+        for (eU32 i=0; i<frameSizeHalf*2; i+=4)
+            eSimdStore(eSimdMul(eSimdLoad(&spectrum[i]), sinCos), &modTable[i]);
+    }
+    else
+    {
+        // the phase offset of every bin wraps around TF_FRAMESIZE and
+        // maps that range onto the first eighth of a sine period.
+        eF32x4 offsetScale = eSimdSetAll4(offset * TF_FRAMESIZE / (eF32)frameSizeHalf);
+        eF32x4 mRandom = eSimdSetAll4(random);
+        eF32x4 wrap = eSimdSetAll4((eF32)TF_FRAMESIZE);
+        eF32x4 invWrap = eSimdSetAll4(1.0f / TF_FRAMESIZE);
+        eF32x4 quarter = eSimdSetAll4((eF32)(TF_FRAMESIZE/4));
+        eF32x4 toRadians = eSimdSetAll4(eTWOPI / TF_MAXFRAMESIZE);
+        eF32x4 one = eSimdSetAll4(1.0f);
+
+        for (eU32 i=0; i<frameSizeHalf; i+=4)
+        {
+            eF32x4 bins = eSimdAdd(eSimdSetAll4((eF32)i), eSimdLoad(TF_SIMD_LANEINDEX));
+            eF32x4 spread = eSimdNfma(one, mRandom, eSimdLoad(&synth.randomBuffer[i]));
+            eF32x4 phase = eSimdMul(eSimdMul(bins, offsetScale), spread);
+
+            eF32x4 sinPhase = eSimdNfma(phase, eSimdFloor(eSimdMul(phase, invWrap)), wrap);
+            eF32x4 cosPhase = eSimdAdd(sinPhase, quarter);
+            cosPhase = eSimdNfma(cosPhase, eSimdFloor(eSimdMul(cosPhase, invWrap)), wrap);
+
+            eF32x4 sinVal = eTfSimdSin(eSimdMul(sinPhase, toRadians));
+            eF32x4 cosVal = eTfSimdSin(eSimdMul(cosPhase, toRadians));
+
+            eSimdStore(eSimdMul(eSimdLoad(&spectrum[i*2]), eSimdUnpackLo(sinVal, cosVal)), &modTable[i*2]);
+            eSimdStore(eSimdMul(eSimdLoad(&spectrum[i*2+4]), eSimdUnpackHi(sinVal, cosVal)), &modTable[i*2+4]);
+        }
+    }
+
+    modTable[0] = 1.0f;
+    modTable[1] = 0.0f;
+}
+
+// moves the modulation on by one block, at the speed it had
+// when wavetables were rebuilt on every 4th block
+static void eTfGeneratorAdvanceModulation(eTfGenerator &generator, eF32 step)
+{
+    if (eIsFloatZero(generator.modulation))
+        return;
+
+    generator.modulation += step;
+    if (generator.modulation >= 100.0f)
+        generator.modulation -= 100.0f;
+}
+
+eBool eTfGeneratorModulate(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator, const eF32 *spectrum, eF32 *modTable)
+{
+    if (eIsFloatZero(generator.modulation))
+        return eFALSE;
+
+    eTfGeneratorModulateSpectrum(synth, generator.modulation, instr.params[TF_GEN_MODULATION], spectrum, modTable);
+    return eTRUE;
+}
+
+// how far the spectrum moved since the last rebuild, roughly in
+// parameter range for the shape and in radians at the highest bin
+// for the randomized phases.
+static eF32 eTfGeneratorChange(const eTfGenerator &generator, eF32 random)
+{
+    const eTfWavetableKey &built = generator.builtKey;
+    eBool modulated = !eIsFloatZero(generator.modulation);
+
+    if (modulated != built.modulated)
+        return 1.0f;
+
+    eF32 change = eAbs((eF32)generator.activeNumHarmonics - (eF32)built.numHarmonics) / TF_MAX_HARMONICS;
+    change = eMax(change, eAbs(generator.activeBandwidth - built.bandwidth));
+    change = eMax(change, eAbs(generator.activeDamp - built.damp));
+    change = eMax(change, eAbs(generator.activeScale - built.scale) * 0.25f);
+
+    if (modulated && !eIsFloatZero(random))
+    {
+        eF32 dist = eAbs(generator.modulation - generator.builtModulation);
+        change = eMax(change, eMin(dist, 100.0f - dist) * 1.5f);
+    }
+
+    return change;
+}
+
+// decides if the wavetable of a voice is rebuilt in this tick. voices
+// get a slot every spectrumMinInterval samples, the slots of the voices
+// of an instrument are staggered so they don't all rebuild at once.
+// frameSize is how far the tick moves the control state on.
+static eBool eTfGeneratorScheduled(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eU32 voiceIndex, eU32 frameSize)
+{
+    eTfGenerator &generator = voice.generator;
+
+    if (!frameSize)
+        return eFALSE;
+
+    eU32 stride = eMax<eU32>(1, (synth.spectrumMinInterval + frameSize/2) / frameSize);
+
+    generator.spectrumAge += frameSize;
+
+    // the voices of one batch share a slot so their rebuilds render together
+    if ((voice.time + voiceIndex / TF_SPECTRUM_BATCH) % stride != 0)
+        return eFALSE;
+
+    eF32 change = eTfGeneratorChange(generator, instr.params[TF_GEN_MODULATION]);
+    return change >= synth.spectrumThreshold || (change > 0.0f && generator.spectrumAge >= synth.spectrumMaxInterval);
+}
+
+// makes table the current wavetable. with crossfade the old one
+// is kept for one more tick to fade over to the new one.
+static void eTfGeneratorSwap(eTfGenerator &generator, const eF32 *table, eTfWavetableCacheEntry *entry, eBool crossfade)
+{
+    eTfWavetableCacheRelease(generator.prevEntry);
+    generator.prevTable = nullptr;
+    generator.fading = eFALSE;
+
+    if (crossfade && table != generator.waveTable)
+    {
+        generator.prevTable = generator.waveTable;
+        generator.prevEntry = generator.cacheEntry;
+        generator.cacheEntry = nullptr;
+    }
+
+    eTfWavetableCacheRelease(generator.cacheEntry);
+    generator.waveTable = table;
+    generator.cacheEntry = entry;
+}
+
+static void eTfGeneratorEndCrossfade(eTfGenerator &generator)
+{
+    eTfWavetableCacheRelease(generator.prevEntry);
+    generator.prevTable = nullptr;
+    generator.fading = eFALSE;
+}
+
+static void eTfGeneratorBuilt(eTfGenerator &generator, const eTfWavetableKey &key)
+{
+    generator.builtKey = key;
+    generator.builtModulation = generator.modulation;
+    generator.spectrumAge = 0;
+}
+
+#ifdef eTF_ASYNC_SPECTRUM
+
+const eU32 TF_SPECTRUM_QUEUESIZE = 1024;    // more than generators can be queued at once
+const eU32 TF_EFFECT_QUEUESIZE = TF_MAX_INSTR*TF_MAXEFFECTS;
+
+// rebuilds wavetables in the background. the audio thread pushes
+// generators with a queued job into a single producer/consumer
+// ring, every generator is in there at most once. effect slot
+// changes go through a second ring the same way.
+struct eTfSpectrumWorker
+{
+    eTfSynth *                  synth;
+    std::thread                 thread;
+    std::mutex                  cacheLock;  // guards the synth's wavetable cache
+    std::mutex                  wakeLock;
+    std::condition_variable     wake;
+    std::atomic<eBool>          running;
+    std::atomic<eU32>           head;
+    std::atomic<eU32>           tail;
+    eTfGenerator *              queue[TF_SPECTRUM_QUEUESIZE];
+    std::atomic<eU32>           fxHead;
+    std::atomic<eU32>           fxTail;
+    eTfEffectJob *              fxQueue[TF_EFFECT_QUEUESIZE];
+    eTfSpectrumBatch            batch;
+};
+
+// the audio thread never waits for the cache. if the worker
+// holds it, the wavetable is built without going through it.
+static eBool eTfSpectrumLockCache(eTfSynth &synth)
+{
+    return !synth.spectrumWorker || synth.spectrumWorker->cacheLock.try_lock();
+}
+
+static void eTfSpectrumUnlockCache(eTfSynth &synth)
+{
+    if (synth.spectrumWorker)
+        synth.spectrumWorker->cacheLock.unlock();
+}
+
+#else
+
+static eFORCEINLINE eBool eTfSpectrumLockCache(eTfSynth &synth)
+{
+    return eTRUE;
+}
+
+static eFORCEINLINE void eTfSpectrumUnlockCache(eTfSynth &synth)
+{
+}
+
+#endif
+
+// puts the spectrum of a voice's current wavetable into dst
+static void eTfGeneratorFillSpectrum(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator, eF32 *dst)
+{
+    const eF32 *spectrum = eTfGeneratorSpectrum(synth, generator);
+
+    if (!eTfGeneratorModulate(synth, instr, generator, spectrum, dst))
+        eMemCopy(dst, spectrum, sizeof(eF32)*TF_IFFT_FRAMESIZE*2);
+}
+
+// rebuilds the current wavetable of a voice. without spectral
+// randomization the table is only a function of the spectrum
+// parameters and is shared through the synth's wavetable cache.
+// new tables are rendered together by eTfGeneratorFlush(), which
+// has to be called before the voice is processed.
+void eTfGeneratorRefresh(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator, eBool crossfade)
+{
+    eTfWavetableKey key;
+    eTfGeneratorGetKey(generator, key);
+    eTfGeneratorBuilt(generator, key);
+
+    eBool randomized = key.modulated && !eIsFloatZero(instr.params[TF_GEN_MODULATION]);
+
+#ifdef eTF_ASYNC_SPECTRUM
+    eTfGeneratorCollect(generator);
+#endif
+
+    eF32 *resultTable = (generator.waveTable == generator.resultTable) ? generator.backTable : generator.resultTable;
+
+#ifdef eTF_ASYNC_SPECTRUM
+    // stay away from the table a pending job renders into
+    if (generator.job.state.load(std::memory_order_acquire) != TF_SPECTRUM_IDLE && generator.job.target == resultTable)
+    {
+        resultTable = (resultTable == generator.resultTable) ? generator.backTable : generator.resultTable;
+        crossfade = eFALSE;
+    }
+#endif
+
+    // new cache entries are only filled when the batch is
+    // rendered, so the cache stays locked until then
+    eTfSpectrumBatch &batch = synth.spectrumBatch;
+
+    if (!randomized && !batch.locked)
+        batch.locked = eTfSpectrumLockCache(synth);
+
+    if (!randomized && batch.locked)
+    {
+        eBool found = eFALSE;
+        eTfWavetableCacheEntry *entry = eTfWavetableCacheAcquire(synth.wavetableCache, key, found);
+
+        if (entry)
+        {
+            if (!found)
+                eTfGeneratorFillSpectrum(synth, instr, generator, eTfSpectrumBatchAdd(synth, batch, entry->resultTable));
+
+            eTfGeneratorSwap(generator, entry->resultTable, entry, crossfade);
+            return;
+        }
+    }
+
+    eTfGeneratorFillSpectrum(synth, instr, generator, eTfSpectrumBatchAdd(synth, batch, resultTable));
+    eTfGeneratorSwap(generator, resultTable, nullptr, crossfade);
+}
+
+void eTfGeneratorFlush(eTfSynth &synth)
+{
+    eTfSpectrumBatch &batch = synth.spectrumBatch;
+    eTfSpectrumBatchRender(synth, batch);
+
+    if (batch.locked)
+    {
+        eTfSpectrumUnlockCache(synth);
+        batch.locked = eFALSE;
+    }
+}
+
+void eTfGeneratorRelease(eTfGenerator &generator)
+{
+#ifdef eTF_ASYNC_SPECTRUM
+    // the result of a pending job is dropped when it comes in
+    generator.serial++;
+    eTfGeneratorCollect(generator);
+#endif
+
+    eTfGeneratorSwap(generator, generator.resultTable, nullptr, eFALSE);
+}
+
+#ifdef eTF_ASYNC_SPECTRUM
+
+// hands the rebuild of the wavetable to the spectrum worker. returns
+// false if the previous job of the generator isn't picked up yet.
+eBool eTfGeneratorQueue(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator)
+{
+    eTfSpectrumWorker *worker = synth.spectrumWorker;
+    eTfSpectrumJob &job = generator.job;
+
+    if (job.state.load(std::memory_order_acquire) != TF_SPECTRUM_IDLE)
+        return eFALSE;
+
+    // the target is neither played nor faded out, as faded out
+    // tables are only kept during the block of a swap
+    eTfGeneratorGetKey(generator, job.key);
+    eTfGeneratorBuilt(generator, job.key);
+    job.serial = generator.serial;
+    job.modulation = generator.modulation;
+    job.random = instr.params[TF_GEN_MODULATION];
+    job.target = (generator.waveTable == generator.resultTable) ? generator.backTable : generator.resultTable;
+    job.result = nullptr;
+    job.entry = nullptr;
+    job.state.store(TF_SPECTRUM_QUEUED, std::memory_order_relaxed);
+
+    eU32 head = worker->head.load(std::memory_order_relaxed);
+    worker->queue[head % TF_SPECTRUM_QUEUESIZE] = &generator;
+    worker->head.store(head+1, std::memory_order_release);
+    worker->wake.notify_one();
+    return eTRUE;
+}
+
+// swaps in the wavetable of a finished job
+void eTfGeneratorCollect(eTfGenerator &generator)
+{
+    eTfSpectrumJob &job = generator.job;
+
+    if (job.state.load(std::memory_order_acquire) != TF_SPECTRUM_READY)
+        return;
+
+    if (job.serial == generator.serial)
+    {
+        eTfGeneratorSwap(generator, job.result, job.entry, eTRUE);
+        job.entry = nullptr;
+    }
+    else
+        eTfWavetableCacheRelease(job.entry);
+
+    job.state.store(TF_SPECTRUM_IDLE, std::memory_order_relaxed);
+}
+
+// hands a change of the effect in a slot to the worker. returns
+// false while the previous change of the slot isn't picked up.
+static eBool eTfEffectQueue(eTfSynth &synth, eTfInstrument &instr, eU32 slot, eU32 fxIndex)
+{
+    eTfSpectrumWorker *worker = synth.spectrumWorker;
+    eTfEffectJob &job = instr.effectJobs[slot];
+
+    if (job.state.load(std::memory_order_acquire) != TF_SPECTRUM_IDLE)
+        return eFALSE;
+
+    job.fxIndex = fxIndex;
+    job.sampleRate = synth.sampleRate;
+    job.created = nullptr;
+    job.retiredIndex = instr.effectIndex[slot];
+    job.retired = instr.effects[slot];
+    job.state.store(TF_SPECTRUM_QUEUED, std::memory_order_relaxed);
+
+    instr.effects[slot] = nullptr;
+    instr.effectIndex[slot] = 0;
+
+    eU32 head = worker->fxHead.load(std::memory_order_relaxed);
+    worker->fxQueue[head % TF_EFFECT_QUEUESIZE] = &job;
+    worker->fxHead.store(head+1, std::memory_order_release);
+    worker->wake.notify_one();
+    return eTRUE;
+}
+
+// puts the effect of a finished change into its slot
+static void eTfEffectCollect(eTfInstrument &instr, eU32 slot)
+{
+    eTfEffectJob &job = instr.effectJobs[slot];
+
+    if (job.state.load(std::memory_order_acquire) != TF_SPECTRUM_READY)
+        return;
+
+    if (job.created)
+    {
+        instr.effects[slot] = job.created;
+        instr.effectIndex[slot] = job.fxIndex;
+        instr.effectRate[slot] = job.sampleRate;
+        job.created = nullptr;
+    }
+
+    job.state.store(TF_SPECTRUM_IDLE, std::memory_order_relaxed);
+}
+
+static void eTfSpectrumWorkerSwapEffect(eTfEffectJob &job)
+{
+    if (job.retired)
+        s_effectDelete[job.retiredIndex](job.retired);
+
+    job.retired = nullptr;
+
+    if (job.fxIndex != 0)
+        job.created = s_effectCreate[job.fxIndex](job.sampleRate);
+}
+
+static void eTfSpectrumWorkerBuild(eTfSpectrumWorker &worker, eTfSpectrumJob &job)
+{
+    eTfSynth &synth = *worker.synth;
+    eTfSpectrumBatch &batch = worker.batch;
+    eBool randomized = job.key.modulated && !eIsFloatZero(job.random);
+    eF32 *resultTable = job.target;
+
+    if (!randomized)
+    {
+        // new entries are filled before the lock is given back
+        if (!batch.locked)
+        {
+            worker.cacheLock.lock();
+            batch.locked = eTRUE;
+        }
+
+        eBool found = eFALSE;
+        job.entry = eTfWavetableCacheAcquire(synth.wavetableCache, job.key, found);
+
+        if (job.entry)
+        {
+            job.result = job.entry->resultTable;
+
+            if (found)
+                return;
+
+            resultTable = job.entry->resultTable;
+        }
+    }
+
+    eF32 *spectrum = eTfSpectrumBatchAdd(synth, batch, resultTable);
+    eTfGeneratorBuildSpectrum(synth, job.key, spectrum);
+
+    if (job.key.modulated)
+        eTfGeneratorModulateSpectrum(synth, job.modulation, job.random, spectrum, spectrum);
+
+    job.result = resultTable;
+}
+
+static void eTfSpectrumWorkerRun(eTfSpectrumWorker *worker)
+{
+    eSimdSetArithmeticFlags(eSAF_FTZ);
+
+    for (;;)
+    {
+        // effect changes are cheap to wait for but audible, so they go first
+        eU32 fxTail = worker->fxTail.load(std::memory_order_relaxed);
+        eU32 fxHead = worker->fxHead.load(std::memory_order_acquire);
+
+        if (fxTail != fxHead)
+        {
+            eTfEffectJob *job = worker->fxQueue[fxTail % TF_EFFECT_QUEUESIZE];
+            eTfSpectrumWorkerSwapEffect(*job);
+            job->state.store(TF_SPECTRUM_READY, std::memory_order_release);
+            worker->fxTail.store(fxTail+1, std::memory_order_relaxed);
+            continue;
+        }
+
+        eU32 tail = worker->tail.load(std::memory_order_relaxed);
+
+        eU32 head = worker->head.load(std::memory_order_acquire);
+
+        // takes a few jobs at once to render them as batches,
+        // but not so many that the cache is locked for too long
+        if (tail != head)
+        {
+            eU32 count = eMin<eU32>(head - tail, TF_SPECTRUM_BATCH*2);
+
+            for (eU32 i=0; i<count; i++)
+                eTfSpectrumWorkerBuild(*worker, worker->queue[(tail+i) % TF_SPECTRUM_QUEUESIZE]->job);
+
+            eTfSpectrumBatchRender(*worker->synth, worker->batch);
+
+            if (worker->batch.locked)
+            {
+                worker->cacheLock.unlock();
+                worker->batch.locked = eFALSE;
+            }
+
+            for (eU32 i=0; i<count; i++)
+            {
+                eTfGenerator *generator = worker->queue[(tail+i) % TF_SPECTRUM_QUEUESIZE];
+                generator->job.state.store(TF_SPECTRUM_READY, std::memory_order_release);
+            }
+
+            worker->tail.store(tail+count, std::memory_order_relaxed);
+            continue;
+        }
+
+        // the queue is always emptied before the worker quits
+        if (!worker->running.load())
+            break;
+
+        // wake ups can get lost as the audio thread doesn't lock, so don't sleep for long
+        std::unique_lock<std::mutex> lock(worker->wakeLock);
+        worker->wake.wait_for(lock, std::chrono::milliseconds(2));
+    }
+}
+
+#endif
+
+// lanes are L R L R, adds them up per channel and sample
+// and mixes the result with the volume ramp into the signal
+static eFORCEINLINE void eTfGeneratorWriteBlock(const eF32x4 *acc, eF32x4 volL, eF32x4 volR, eF32 *sig1, eF32 *sig2, eU32 count)
+{
+    eF32x4 sum02 = eSimdAdd(eSimdUnpackLo(acc[0], acc[2]), eSimdUnpackHi(acc[0], acc[2]));
+    eF32x4 sum13 = eSimdAdd(eSimdUnpackLo(acc[1], acc[3]), eSimdUnpackHi(acc[1], acc[3]));
+    eF32x4 left = eSimdMul(eSimdUnpackLo(sum02, sum13), volL);
+    eF32x4 right = eSimdMul(eSimdUnpackHi(sum02, sum13), volR);
+
+    if (count == 4)
+    {
+        eSimdStore(eSimdAdd(eSimdLoad(sig1), left), sig1);
+        eSimdStore(eSimdAdd(eSimdLoad(sig2), right), sig2);
+    }
+    else
+    {
+        eALIGN16 eF32 outL[4];
+        eALIGN16 eF32 outR[4];
+        eSimdStore(left, outL);
+        eSimdStore(right, outR);
+
+        for (eU32 n=0; n<count; n++)
+        {
+            sig1[n] += outL[n];
+            sig2[n] += outR[n];
+        }
+    }
+}
+
+static void eTfGeneratorReadBase(const eTfGeneratorBank &bank, eF32 **signal, eU32 frameSize)
+{
+    eU32 lanes = (bank.lanes + 3) & ~3;
+    eU32 tableBits = bank.tableBits;
+    eU32 tableMask = (1 << tableBits) - 1;
+    const eF32 *table = bank.table;
+
+    eF32x4 mdrive = eSimdSetAll4(bank.drive);
+    eF32x4 mmin = eSimdSetAll4(-1.0f);
+    eF32x4 mmax = eSimdSetAll4(1.0f);
+    eF32x4 mfracScale = eSimdSetAll4(1.0f / (1 << 23));
+    eF32x4 mlane = eSimdLoad(TF_SIMD_LANEINDEX);
+
+    // the volume ramp is computed from the position in the tick,
+    // so it doesn't depend on how the tick is split up
+    eF32x4 mvolL = eSimdSetAll4(bank.volL);
+    eF32x4 mvolR = eSimdSetAll4(bank.volR);
+    eF32x4 mvolStepL = eSimdSetAll4(bank.volStepL);
+    eF32x4 mvolStepR = eSimdSetAll4(bank.volStepR);
+    eF32x4 mpos = eSimdAdd(mlane, eSimdSetAll4(static_cast<eF32>(bank.offset)));
+    eF32x4 mfour = eSimdSetAll4(4.0f);
+
+    for (eU32 i=0; i<frameSize; i+=4)
+    {
+        eU32 count = eMin<eU32>(frameSize - i, 4);
+        eF32x4 acc[4];
+
+        for (eU32 n=0; n<4; n++)
+        {
+            eF32x4 sum = eSimdZero();
+
+            for (eU32 k=0; k<lanes && n<count; k+=4)
+            {
+                eALIGN16 eU32 offs[4];
+                eALIGN16 eF32 vals[8];
+
+                // integer part of the phase indexes the table, the
+                // next 23 bits are the interpolation fraction
+                eU32x4 phase = eSimdLoadU32(&bank.phase[k]);
+                eSimdStoreU32(eSimdShrU32(phase, 32 - tableBits), offs);
+                eF32x4 frac = eSimdMul(eSimdU32ToF32(eSimdShrU32(eSimdShlU32(phase, tableBits), 9)), mfracScale);
+
+                for (eU32 l=0; l<4; l++)
+                {
+                    vals[l] = table[offs[l]];
+                    vals[l+4] = table[(offs[l] + 1) & tableMask];
+                }
+
+                eF32x4 val = eSimdLoad(&vals[0]);
+                val = eSimdFma(val, eSimdSub(eSimdLoad(&vals[4]), val), frac);
+                val = eSimdMax(eSimdMin(eSimdMul(val, mdrive), mmax), mmin);
+                sum = eSimdFma(sum, val, eSimdLoad(&bank.lanesOn[k]));
+
+                // the phases wrap around on their own
+                eSimdStoreU32(eSimdAddU32(phase, eSimdLoadU32(&bank.incs[k])), &bank.phase[k]);
+            }
+
+            acc[n] = sum;
+        }
+
+        eTfGeneratorWriteBlock(acc, eSimdFma(mvolL, mpos, mvolStepL), eSimdFma(mvolR, mpos, mvolStepR), &signal[0][i], &signal[1][i], count);
+        mpos = eSimdAdd(mpos, mfour);
+    }
+}
+
+#ifdef eSIMD_DISPATCH
+
+// eight oscillators per register and the table reads done by gathers
+static eSIMD_TARGET_AVX2 void eTfGeneratorReadAvx2(const eTfGeneratorBank &bank, eF32 **signal, eU32 frameSize)
+{
+    const eU32 lanes = (bank.lanes + 7) & ~7;
+    const __m128i shiftIndex = _mm_cvtsi32_si128(32 - bank.tableBits);
+    const __m128i shiftFrac = _mm_cvtsi32_si128(bank.tableBits);
+    const __m256i mmask = _mm256_set1_epi32((1 << bank.tableBits) - 1);
+    const __m256i mone = _mm256_set1_epi32(1);
+    const eF32 *table = bank.table;
+
+    const __m256 mdrive = _mm256_set1_ps(bank.drive);
+    const __m256 mmin = _mm256_set1_ps(-1.0f);
+    const __m256 mmax = _mm256_set1_ps(1.0f);
+    const __m256 mfracScale = _mm256_set1_ps(1.0f / (1 << 23));
+    const __m128 mlane = _mm_loadu_ps(TF_SIMD_LANEINDEX);
+
+    const __m128 mvolL = _mm_set1_ps(bank.volL);
+    const __m128 mvolR = _mm_set1_ps(bank.volR);
+    const __m128 mvolStepL = _mm_set1_ps(bank.volStepL);
+    const __m128 mvolStepR = _mm_set1_ps(bank.volStepR);
+    const __m128 mfour = _mm_set1_ps(4.0f);
+    __m128 mpos = _mm_add_ps(mlane, _mm_set1_ps(static_cast<eF32>(bank.offset)));
+
+    for (eU32 i=0; i<frameSize; i+=4)
+    {
+        eU32 count = eMin<eU32>(frameSize - i, 4);
+        __m128 acc[4];
+
+        for (eU32 n=0; n<4; n++)
+        {
+            __m256 sum = _mm256_setzero_ps();
+
+            for (eU32 k=0; k<lanes && n<count; k+=8)
+            {
+                const __m256i phase = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bank.phase[k]));
+                const __m256i index = _mm256_srl_epi32(phase, shiftIndex);
+                const __m256i next = _mm256_and_si256(_mm256_add_epi32(index, mone), mmask);
+                const __m256 frac = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(_mm256_sll_epi32(phase, shiftFrac), 9)), mfracScale);
+
+                const __m256 val0 = _mm256_i32gather_ps(table, index, 4);
+                const __m256 val1 = _mm256_i32gather_ps(table, next, 4);
+                __m256 val = _mm256_fmadd_ps(_mm256_sub_ps(val1, val0), frac, val0);
+                val = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(val, mdrive), mmax), mmin);
+                sum = _mm256_fmadd_ps(val, _mm256_loadu_ps(&bank.lanesOn[k]), sum);
+
+                const __m256i inc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bank.incs[k]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&bank.phase[k]), _mm256_add_epi32(phase, inc));
+            }
+
+            acc[n] = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        }
+
+        eTfGeneratorWriteBlock(acc, _mm_fmadd_ps(mpos, mvolStepL, mvolL), _mm_fmadd_ps(mpos, mvolStepR, mvolR), &signal[0][i], &signal[1][i], count);
+        mpos = _mm_add_ps(mpos, mfour);
+    }
+}
+
+#endif
+
+// reads all oscillators of the bank from one mip level and adds
+// them to the signal, with the left and right oscillator of every
+// unison voice interleaved in the lanes
+void eTfGeneratorRead(const eTfGeneratorBank &bank, eF32 **signal, eU32 frameSize)
+{
+    TF_KERNELS.generatorRead(bank, signal, frameSize);
+}
+
+// sets the oscillator bank up for a control tick of frameSize
+// samples, it's rendered by eTfGeneratorRender()
+eBool eTfGeneratorProcess(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 velocity, eU32 frameSize)
+{
+    eF32 vol = instr.params[TF_GEN_VOLUME] * 4.0f * velocity;
+
+    generator.tickActive = eFALSE;
+
+    eF32 maxCurrentVolume = eMax(voice.lastVolL, voice.lastVolR);
+    if (generator.fading)
+        maxCurrentVolume = eMax(maxCurrentVolume, eMax(generator.fadeVolL, generator.fadeVolR));
+    eF32 maxFrameVolume = eMax(maxCurrentVolume, vol);
+
+    if (maxFrameVolume > 0.0f)
+    {
+        eF32 freq       = instr.params[TF_GEN_FREQ];
+        eF32 panning    = instr.params[TF_GEN_PANNING];
+        eF32 drive      = instr.params[TF_GEN_DRIVE];
         eF32 detune     = instr.params[TF_GEN_DETUNE];
-        eF32 octave     = instr.params[TF_GEN_OCTAVE];
         eF32 spread     = instr.params[TF_GEN_SPREAD];
-        eU32 unisono    = eFtoL(eRoundNearest(instr.params[TF_GEN_UNISONO] * (TF_MAXUNISONO-1))) + 1;
+        eU32 unisono    = instr.decoded.unisono;
         eBool notefreq  = freq < 0.00001f;
 
         // process modulation matrix
@@ -829,361 +2203,1238 @@ eBool eTfGeneratorProcess(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice
         if (maxFrameVolume < 0.001f)
             return eFALSE;
 
-        // scale some of the values
+        // scale some of the values, the ones without
+        // modulation were scaled once for all voices
         // -------------------------------------------------
-        detune  = ePow(detune, 3.0f) * 10.0f;
+        const eTfModMatrixPlan &plan = instr.modPlan;
+        detune  = plan.entryCount[eTfModMatrix::OUTPUT_DETUNE] ? ePow(detune, 3.0f) * 10.0f : instr.control.genDetune;
         drive   *= 32.0f;
         drive   += 1.0f;
-        freq    = ePow(freq, 2.0f) * 1000.0f;
-        spread  = ePow(spread, 4.0f) / static_cast<eF32>(synth.sampleRate) * 10.0f;
+        freq    = instr.control.genFreq;
+        spread  = plan.entryCount[eTfModMatrix::OUTPUT_SPREAD] ? ePow(spread, 4.0f) / static_cast<eF32>(synth.sampleRate) * 10.0f : instr.control.genSpread;
+
+        // calculate octave multiplicator
+        // -------------------------------------------------
+        eF32 octave_mul = TF_OCTAVES[instr.decoded.octave];
+
+        // calculate final frequency
+        // -------------------------------------------------
+        generator.freq1 = voice.currentFreq * octave_mul + detune;
+        generator.freq2 = voice.currentFreq * octave_mul - detune;
+
+        if (!notefreq)
+        {
+            generator.freq1 = freq;
+            generator.freq2 = freq;
+        }
+
+        generator.freq1 = generator.freq1 * freqMod / synth.sampleRate;
+        generator.freq2 = generator.freq2 * freqMod / synth.sampleRate;
+
+        // calculate volume & panning
+        // -------------------------------------------------
+        vol *= 0.1f;
+        eF32 vol_left = panning <= 0.5f ? vol : vol * (1.0f - ((panning-0.5f)*2.0f));
+        eF32 vol_right = panning >= 0.5f ? vol : vol * (panning*2.0f);
+
+        // set up the oscillators
+        // -------------------------------------------------
+        // all oscillators run as one bank with the left and right
+        // oscillator of every unison voice interleaved in the lanes
+        eU32 *incs = generator.tickIncs;
+        eF32 *lanesOn = generator.tickLanesOn;
+        eF32 maxFreq = 0.0f;
+
+        for (eU32 j=2*TF_MAXUNISONO; j<TF_UNISONO_LANES; j++)
+        {
+            incs[j] = 0;
+            lanesOn[j] = 0.0f;
+        }
+
+        for (eU32 j=0; j<TF_MAXUNISONO; j++)
+        {
+            // make sure we do not get in negative value (for example with LFO modulation)
+            eF32 freq1 = eAbs(generator.freq1 + spread * (eF32)j);
+            eF32 freq2 = eAbs(generator.freq2 - spread * (eF32)j);
+            eBool on = (j < unisono);
+
+            if (on)
+                maxFreq = eMax(maxFreq, eMax(freq1, freq2));
+
+            incs[j*2] = on ? eTfPhaseToFixed(freq1) : 0;
+            incs[j*2+1] = on ? eTfPhaseToFixed(freq2) : 0;
+            lanesOn[j*2] = lanesOn[j*2+1] = on ? 1.0f : 0.0f;
+        }
+
+        // pick the first mip level whose highest harmonic stays below nyquist
+        eU32 level = 0;
+        while (level < TF_WAVETABLE_MIPLEVELS-1 && (eF32)((TF_IFFT_FRAMESIZE/2) >> level) * maxFreq > 0.5f)
+            level++;
+
+        generator.tickLanes = unisono*2;
+        generator.tickLevel = level;
+        generator.tickDrive = drive;
+        generator.tickActive = eTRUE;
+
+        // a rebuilt wavetable fades in while the previous
+        // one fades out, both ramps add up to the volume
+        if (generator.prevTable && !generator.fading)
+        {
+            generator.fadeVolL = voice.lastVolL;
+            generator.fadeVolR = voice.lastVolR;
+            generator.fading = eTRUE;
+            voice.lastVolL = 0.0f;
+            voice.lastVolR = 0.0f;
+        }
+
+        generator.tickVolL = voice.lastVolL;
+        generator.tickVolR = voice.lastVolR;
+        generator.tickStepL = (vol_left - voice.lastVolL) / frameSize;
+        generator.tickStepR = (vol_right - voice.lastVolR) / frameSize;
+        generator.fadeStepL = generator.prevTable ? -generator.fadeVolL / frameSize : 0.0f;
+        generator.fadeStepR = generator.prevTable ? -generator.fadeVolR / frameSize : 0.0f;
+
+		voice.lastVolL = vol_left;
+		voice.lastVolR = vol_right;
+
+        return eTRUE;
+    }
+
+    return eFALSE;
+}
+
+// renders frameSize samples of the tick set up by
+// eTfGeneratorProcess(), starting offset samples into it
+void eTfGeneratorRender(eTfGenerator &generator, eF32 **signal, eU32 offset, eU32 frameSize)
+{
+    if (!generator.tickActive)
+        return;
+
+    eU32 level = generator.tickLevel;
+    eU32 tableBits = 0;
+    while ((1U << tableBits) < TF_WAVETABLE_MIPLENGTH[level])
+        tableBits++;
+
+    eTfGeneratorBank bank;
+    bank.phase = generator.phase;
+    bank.incs = generator.tickIncs;
+    bank.lanesOn = generator.tickLanesOn;
+    bank.lanes = generator.tickLanes;
+    bank.tableBits = tableBits;
+    bank.drive = generator.tickDrive;
+    bank.offset = offset;
+
+    if (generator.prevTable)
+    {
+        // the previous wavetable reads the same phases
+        eU32 phase[TF_UNISONO_LANES];
+        eMemCopy(phase, generator.phase, sizeof(phase));
+
+        bank.table = generator.prevTable + TF_WAVETABLE_MIPOFFSET[level];
+        bank.volL = generator.fadeVolL;
+        bank.volR = generator.fadeVolR;
+        bank.volStepL = generator.fadeStepL;
+        bank.volStepR = generator.fadeStepR;
+        eTfGeneratorRead(bank, signal, frameSize);
+
+        eMemCopy(generator.phase, phase, sizeof(phase));
+    }
+
+    bank.table = generator.waveTable + TF_WAVETABLE_MIPOFFSET[level];
+    bank.volL = generator.tickVolL;
+    bank.volR = generator.tickVolR;
+    bank.volStepL = generator.tickStepL;
+    bank.volStepR = generator.tickStepR;
+    eTfGeneratorRead(bank, signal, frameSize);
+}
+
+// a tick cut short by an event ends on the volumes its ramps got to,
+// a crossfade which isn't done yet goes on in the next tick
+void eTfGeneratorTickEnd(eTfVoice &voice, eTfGenerator &generator, eU32 done, eU32 frameSize)
+{
+    if (generator.tickActive && done < frameSize)
+    {
+        voice.lastVolL = generator.tickVolL + generator.tickStepL * done;
+        voice.lastVolR = generator.tickVolR + generator.tickStepR * done;
+
+        if (generator.prevTable)
+        {
+            generator.fadeVolL += generator.fadeStepL * done;
+            generator.fadeVolR += generator.fadeStepR * done;
+            return;
+        }
+    }
+
+    eTfGeneratorEndCrossfade(generator);
+}
+
+// ------------------------------------------------------------------------------------
+// WAVETABLE CACHE
+// ------------------------------------------------------------------------------------
+
+void eTfWavetableCacheInit(eTfWavetableCache &cache)
+{
+    for (eU32 i=0; i<TF_WAVETABLE_CACHESIZE; i++)
+    {
+        cache.entries[i].valid = eFALSE;
+        cache.entries[i].refCount = 0;
+        cache.entries[i].lastUse = 0;
+    }
+
+    cache.time = 0;
+    cache.hits = 0;
+    cache.misses = 0;
+}
+
+static eU32 eTfWavetableKeyHash(const eTfWavetableKey &key)
+{
+    eU32 hash = 2166136261U;
+    hash = (hash ^ key.numHarmonics) * 16777619U;
+    hash = (hash ^ eRawCast<eU32>(key.damp)) * 16777619U;
+    hash = (hash ^ eRawCast<eU32>(key.scale)) * 16777619U;
+    hash = (hash ^ eRawCast<eU32>(key.bandwidth)) * 16777619U;
+    hash = (hash ^ (eU32)key.modulated) * 16777619U;
+    return hash;
+}
+
+static eBool eTfWavetableKeyEqual(const eTfWavetableKey &key0, const eTfWavetableKey &key1)
+{
+    return key0.numHarmonics == key1.numHarmonics &&
+           key0.damp == key1.damp &&
+           key0.scale == key1.scale &&
+           key0.bandwidth == key1.bandwidth &&
+           key0.modulated == key1.modulated;
+}
+
+// returns the entry for the given key with its reference count
+// increased. on a miss the least recently used unreferenced entry
+// is recycled and has to be filled by the caller. returns nullptr
+// if all entries are in use.
+eTfWavetableCacheEntry * eTfWavetableCacheAcquire(eTfWavetableCache &cache, const eTfWavetableKey &key, eBool &found)
+{
+    eU32 hash = eTfWavetableKeyHash(key);
+    eTfWavetableCacheEntry *oldest = nullptr;
+
+    cache.time++;
+
+    for (eU32 i=0; i<TF_WAVETABLE_CACHESIZE; i++)
+    {
+        eTfWavetableCacheEntry &entry = cache.entries[i];
+
+        if (entry.valid && entry.hash == hash && eTfWavetableKeyEqual(entry.key, key))
+        {
+            entry.refCount++;
+            entry.lastUse = cache.time;
+            cache.hits++;
+            found = eTRUE;
+            return &entry;
+        }
+
+        if (entry.refCount == 0 && (!oldest || !entry.valid || (oldest->valid && entry.lastUse < oldest->lastUse)))
+            oldest = &entry;
+    }
+
+    cache.misses++;
+    found = eFALSE;
+
+    if (oldest)
+    {
+        oldest->key = key;
+        oldest->hash = hash;
+        oldest->valid = eTRUE;
+        oldest->refCount = 1;
+        oldest->lastUse = cache.time;
+    }
+
+    return oldest;
+}
+
+void eTfWavetableCacheRelease(eTfWavetableCacheEntry *&entry)
+{
+    if (entry)
+    {
+        eASSERT(entry->refCount > 0);
+        entry->refCount--;
+        entry = nullptr;
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// NOISE
+// ------------------------------------------------------------------------------------
+
+void eTfNoiseReset(eTfNoise &state)
+{
+    eRandom rand;
+    rand.SeedRandomly();
+
+    state.offset1 = rand.NextInt(0, TF_NOISETABLESIZE/2);
+    state.offset2 = rand.NextInt(0, TF_NOISETABLESIZE/2);
+    state.filterOn = eFALSE;
+    state.amount = 0.0f;
+}
+
+void eTfNoiseUpdate(eTfInstrument &instr, eTfNoise &state, eTfModMatrix &modMatrix, eF32 velocity)
+{
+    eF32 bw = instr.params[TF_NOISE_BW];
+    eF32 noise = instr.params[TF_NOISE_AMOUNT];
+
+    state.filterOn = bw < 0.99f;
+    state.amount = noise * velocity * eTfModMatrixGet(modMatrix, eTfModMatrix::OUTPUT_NOISE_AMOUNT);
+
+    // the noise filters aren't modulated, all voices share the coefficients
+    if (state.filterOn && state.amount > 0.0f)
+    {
+        state.filterHP->coeffs = instr.control.noiseHP;
+        state.filterLP->coeffs = instr.control.noiseLP;
+    }
+}
+
+eBool eTfNoiseProcess(eTfSynth &synth, eTfNoise &state, eF32 **signal, eU32 frameSize)
+{
+    eF32 *signal1 = signal[0];
+    eF32 *signal2 = signal[1];
+
+    if (state.amount > 0.01f)
+    {
+        eU32 len = frameSize;
+        while(len--)
+        {
+            *signal1++ = synth.whiteNoiseTable[state.offset1++] * state.amount;
+            *signal2++ = synth.whiteNoiseTable[state.offset2++] * state.amount;
+
+            if (state.offset1 >= TF_NOISETABLESIZE) state.offset1 = 0;
+            if (state.offset2 >= TF_NOISETABLESIZE) state.offset2 = 0;
+        }
+
+        if (state.filterOn)
+        {
+            eTfFilter *filters[] = { state.filterLP, state.filterHP, nullptr, nullptr };
+            eTfFilterProcess(filters, eTfFilter::STAGE_LP | eTfFilter::STAGE_HP, signal, frameSize);
+        }
+
+        return eTRUE;
+    }
+    else
+    {
+        eMemSet(signal1, 0, sizeof(eF32) * frameSize);
+        eMemSet(signal2, 0, sizeof(eF32) * frameSize);
+
+        return eFALSE;
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// FILTER
+// ------------------------------------------------------------------------------------
+
+static void eTfFilterTableBuild(eTfFilterTable &table, eU32 sampleRate)
+{
+    const eF32 sr = static_cast<eF32>(sampleRate);
+
+    for (eU32 i=0; i<=TF_FILTERTABLE_CUTOFFS; i++)
+    {
+        const eF32 f = static_cast<eF32>(i) / TF_FILTERTABLE_CUTOFFS;
+
+        // lowpass and notch
+        eF32 fl = f * f * 20000.0f + 30.0f;
+        eF32 fn = 2.0f * fl / sr; //[0 - 1]
+        eF32 k = 3.6f*fn - 1.6f*fn*fn -1.0f; //(Empirical tunning)
+        eF32 p = (k+1.0f)*0.5f;
+
+        table.lp[i][0] = k;
+        table.lp[i][1] = p;
+        table.lp[i][2] = ePow(eEXPONE, ((1.0f-p)*1.386249f));
+        table.nt[i] = eCos(2.0f * ePI * fl / sr);
+
+        // highpass and bandpass
+        eF32 fb = f * f * 10000.0f + 30.0f;
+        eF32 w0 = 2.0f * ePI * fb / sr;
+        eF32 sin_w0 = eSin(w0);
+
+        table.bq[i][0] = eCos(w0);
+        table.bq[i][1] = sin_w0;
+
+        for (eU32 j=0; j<=TF_FILTERTABLE_QS; j++)
+        {
+            eF32 q = 0.85f * static_cast<eF32>(j) / TF_FILTERTABLE_QS;
+            table.alpha[j][i] = sin_w0 * eSinH( eLog10(2.0f)/2.0f * (1.0f - q) * w0/sin_w0 );
+        }
+    }
+
+    table.sampleRate = sampleRate;
+    table.serial++;
+}
+
+// the table follows the synth's sample rate, which
+// the host may change between any two blocks
+static eFORCEINLINE const eTfFilterTable & eTfFilterTableGet(eTfSynth &synth)
+{
+    if (synth.filterTable.sampleRate != synth.sampleRate)
+        eTfFilterTableBuild(synth.filterTable, synth.sampleRate);
+
+    return synth.filterTable;
+}
+
+static eFORCEINLINE void eTfFilterCompute(const eTfFilterTable &table, eTfFilterCoeffs &coeffs, eF32 f, eF32 q, eTfFilter::Type type)
+{
+    f = eClamp<eF32>(0.0f, f, 1.0f);
+    q = eClamp<eF32>(0.0f, q, 0.85f);
+
+    const eF32 x = f * TF_FILTERTABLE_CUTOFFS;
+    const eU32 i = eMin<eU32>(eFtoL(x), TF_FILTERTABLE_CUTOFFS-1);
+    const eF32 t = x - static_cast<eF32>(i);
+
+    if (type == eTfFilter::FILTER_LP)
+    {
+        coeffs.k = eLerp(table.lp[i][0], table.lp[i+1][0], t);
+        coeffs.p = eLerp(table.lp[i][1], table.lp[i+1][1], t);
+        coeffs.r = q * eLerp(table.lp[i][2], table.lp[i+1][2], t);
+    }
+    else if (type == eTfFilter::FILTER_NT)
+    {
+        eF32 z1x = eLerp(table.nt[i], table.nt[i+1], t);
 
-        // calculate octave multiplicator
-        // -------------------------------------------------
-        eU32 ioctave = eFtoL(eRoundNearest(octave * (TF_MAXOCTAVES-1)));
-        eF32 octave_mul = TF_OCTAVES[ioctave];
+        coeffs.b0 = (1.0f-q)*(1.0f-q)/(2.0f*(eAbs(z1x)+1.0f)) + q;
+        coeffs.b2 = coeffs.b0;
+        coeffs.b1 = -2.0f * z1x * coeffs.b0;
+        coeffs.a1 = -2.0f * z1x * q;
+        coeffs.a2 = q*q;
+    }
+    else
+    {
+        const eF32 cos_w0 = eLerp(table.bq[i][0], table.bq[i+1][0], t);
+        const eF32 sin_w0 = eLerp(table.bq[i][1], table.bq[i+1][1], t);
 
-        // calculate final frequency
-        // -------------------------------------------------
-        generator.freq1 = voice.currentFreq * octave_mul + detune;
-        generator.freq2 = voice.currentFreq * octave_mul - detune;
+        const eF32 y = q * (TF_FILTERTABLE_QS / 0.85f);
+        const eU32 j = eMin<eU32>(eFtoL(y), TF_FILTERTABLE_QS-1);
+        const eF32 u = y - static_cast<eF32>(j);
+        eF32 alpha = eLerp(eLerp(table.alpha[j][i], table.alpha[j][i+1], t),
+                           eLerp(table.alpha[j+1][i], table.alpha[j+1][i+1], t), u);
 
-        if (!notefreq)
+        if (type == eTfFilter::FILTER_HP)
         {
-            generator.freq1 = freq;
-            generator.freq2 = freq;
+            coeffs.b0 = (1.0f + cos_w0) / 2.0f;
+            coeffs.b1 = -(1.0f + cos_w0);
+            coeffs.b2 = coeffs.b0;
+        }
+        else // FILTER_BP
+        {
+            coeffs.b0 = sin_w0 / 2.0f;
+            coeffs.b1 = 0.0f;
+            coeffs.b2 = -coeffs.b0;
         }
 
-        generator.freq1 = generator.freq1 * freqMod / synth.sampleRate;
-        generator.freq2 = generator.freq2 * freqMod / synth.sampleRate;
+        const eF32 ia0 = 1.0f / (1.0f + alpha);
+        coeffs.a1 = -2.0f * cos_w0 * ia0;
+        coeffs.a2 = (1.0f - alpha) * ia0;
 
-        // calculate volume & panning
-        // -------------------------------------------------
-        vol *= 0.1f;
-        eF32 vol_left = panning <= 0.5f ? vol : vol * (1.0f - ((panning-0.5f)*2.0f));
-        eF32 vol_right = panning >= 0.5f ? vol : vol * (panning*2.0f);
+        coeffs.b0 *= ia0;
+        coeffs.b1 *= ia0;
+        coeffs.b2 *= ia0;
+    }
+}
 
-        // calculate signal
-        // -------------------------------------------------
-        eF32x2 mdrive = eSimdSetAll(drive);
-        eF32x2 mmin = eSimdSetAll(-1.0f);
-        eF32x2 mmax = eSimdSetAll(1.0f);
+void eTfFilterUpdate(eTfSynth &synth, eTfFilterCoeffs &coeffs, eF32 f, eF32 q, eTfFilter::Type type)
+{
+    const eTfFilterTable &table = eTfFilterTableGet(synth);
 
-        for (eU32 j=0; j<unisono; j++)
-        {
-            eF32 *sig1 = signal[0];
-            eF32 *sig2 = signal[1];
-            eF32 *phase1 = &generator.phase[j*2];
-            eF32 *phase2 = &generator.phase[j*2+1];
+    // nothing to do for the same inputs as last time
+    if (coeffs.serial == table.serial && coeffs.f == f && coeffs.q == q)
+        return;
 
-			eF32x2 mvol = eSimdSet2(voice.lastVolL, voice.lastVolR);
-			eF32x2 mvol_step = eSimdSet2((vol_left - voice.lastVolL) / frameSize,
-				                         (vol_right - voice.lastVolR) / frameSize);
+    coeffs.f = f;
+    coeffs.q = q;
+    coeffs.serial = table.serial;
+    eTfFilterCompute(table, coeffs, f, q, type);
+}
 
-            // make sure we do not get in negative value (for example with LFO modulation) or we crash
-            if (generator.freq1 < 0.0f) generator.freq1 *= -1.0f;
-            if (generator.freq2 < 0.0f) generator.freq2 *= -1.0f;
+// registers of the stages of a filter cascade. the memory is loaded once
+// per block and each sample runs through all enabled stages in turn
+// (lowpass, highpass, bandpass, notch) before it is stored again
+struct eTfLpStage2
+{
+    eF32x2          p, r, k;
+    eF32x2          oldx, y1, y2, y3, y4;
+};
 
-            eU32 len = frameSize;
-            while(len--)
-            {
-                eU32 off1 = eFtoL(*phase1 * (TF_IFFT_FRAMESIZE-1)) * 2;
-                eU32 off2 = eFtoL(*phase2 * (TF_IFFT_FRAMESIZE-1)) * 2;
-
-                eF32 val1 = generator.resultTable[off1];
-                eF32 val2 = generator.resultTable[off2];
-
-                eF32x2 mval = eSimdMul(
-                    eSimdMax(
-                        eSimdMin(
-                            eSimdMul(
-                                eSimdSet2(val1, val2),
-                                mdrive),
-                            mmax),
-                        mmin),
-                    mvol);
-
-                eF32 store_l, store_r;
-                eSimdStore2(mval, store_l, store_r);
-                *sig1++ += store_l;
-                *sig2++ += store_r;
-
-                *phase1 += generator.freq1;
-                while (*phase1 > 1.0f) { *phase1 -= 1.0f; }
-
-                *phase2 += generator.freq2;
-                while (*phase2 > 1.0f) { *phase2 -= 1.0f; }
-
-				mvol = eSimdAdd(mvol, mvol_step);
-            }
+struct eTfBiquadStage2
+{
+    eF32x2          b0, b1, b2, a1, a2;
+    eF32x2          in0, in1, in2, out1, out2;
+};
 
-            generator.freq1 += spread;
-            generator.freq2 -= spread;
-        }
+// the filter bank's stages also ramp their coefficients every four samples
+struct eTfLpStage4
+{
+    eF32x4          p, r, k;
+    eF32x4          tp, tr, tk;     // reached at the end of the tick
+    eF32x4          dp, dr, dk;
+    eF32x4          oldx, y1, y2, y3, y4;
+};
 
-		voice.lastVolL = vol_left;
-		voice.lastVolR = vol_right;
+struct eTfBiquadStage4
+{
+    eF32x4          b0, b1, b2, a1, a2;
+    eF32x4          tb0, tb1, tb2, ta1, ta2;
+    eF32x4          db0, db1, db2, da1, da2;
+    eF32x4          in0, in1, in2, out1, out2;
+};
 
-        return eTRUE;
-    }
+// one instance of a cascade for each combination of stages
+#define eTF_FILTER_CASCADES(fn)                                 \
+{                                                               \
+    fn<0>,  fn<1>,  fn<2>,  fn<3>,  fn<4>,  fn<5>,  fn<6>,  fn<7>,  \
+    fn<8>,  fn<9>,  fn<10>, fn<11>, fn<12>, fn<13>, fn<14>, fn<15>  \
+}
 
-    return eFALSE;
+template <class S, class V>
+static eFORCEINLINE V eTfLpStageTick(S &s, V in, V const_6)
+{
+    // x = in - r * y4
+    V x = eSimdNfma(in, s.r, s.y4);
+
+    // y1 = x*p + oldx*p - k*y1, the same for y2 to y4 from the stage before
+    V y1 = eSimdNfma(eSimdFma(eSimdMul(s.oldx, s.p), x, s.p), s.k, s.y1);
+    V y2 = eSimdNfma(eSimdFma(eSimdMul(s.y1, s.p), y1, s.p), s.k, s.y2);
+    V y3 = eSimdNfma(eSimdFma(eSimdMul(s.y2, s.p), y2, s.p), s.k, s.y3);
+    s.y4 = eSimdNfma(eSimdFma(eSimdMul(s.y3, s.p), y3, s.p), s.k, s.y4);
+
+    s.oldx = x;
+    s.y1 = y1;
+    s.y2 = y2;
+    s.y3 = y3;
+
+    // out = y4 - y4^3/6
+    return eSimdNfma(s.y4, eSimdMul(eSimdMul(s.y4, s.y4), s.y4), const_6);
 }
 
-// ------------------------------------------------------------------------------------
-// NOISE
-// ------------------------------------------------------------------------------------
+// the notch filter runs one sample behind its input
+template <eBool DELAYED, class S, class V>
+static eFORCEINLINE V eTfBiquadStageTick(S &s, V in)
+{
+    V x = (DELAYED ? s.in0 : in);
+    V out = eSimdNfma(eSimdNfma(eSimdFma(eSimdFma(eSimdMul(s.b0, x), s.b1, s.in1), s.b2, s.in2), s.a1, s.out1), s.a2, s.out2);
+
+    s.in2 = s.in1;
+    s.in1 = x;
+    s.in0 = in;
+    s.out2 = s.out1;
+    s.out1 = out;
+    return out;
+}
 
-void eTfNoiseReset(eTfNoise &state)
+static eFORCEINLINE void eTfLpStageLoad(eTfLpStage2 &s, const eTfFilter &state)
 {
-    eRandom rand;
-    rand.SeedRandomly();
+    s.p = eSimdSetAll(state.coeffs.p);
+    s.r = eSimdSetAll(state.coeffs.r);
+    s.k = eSimdSetAll(state.coeffs.k);
+    s.oldx = state.oldx;
+    s.y1 = state.y1;
+    s.y2 = state.y2;
+    s.y3 = state.y3;
+    s.y4 = state.y4;
+}
 
-    state.offset1 = rand.NextInt(0, TF_NOISETABLESIZE/2);
-    state.offset2 = rand.NextInt(0, TF_NOISETABLESIZE/2);
-    state.filterOn = eFALSE;
-    state.amount = 0.0f;
+static eFORCEINLINE void eTfLpStageStore(const eTfLpStage2 &s, eTfFilter &state)
+{
+    state.oldx = s.oldx;
+    state.oldy1 = state.y1 = s.y1;
+    state.oldy2 = state.y2 = s.y2;
+    state.oldy3 = state.y3 = s.y3;
+    state.y4 = s.y4;
 }
 
-void eTfNoiseUpdate(eTfSynth &synth, eTfInstrument &instr, eTfNoise &state, eTfModMatrix &modMatrix, eF32 velocity)
+static eFORCEINLINE void eTfBiquadStageLoad(eTfBiquadStage2 &s, const eTfFilter &state)
 {
-    eF32 bw = instr.params[TF_NOISE_BW];
-    eF32 noise = instr.params[TF_NOISE_AMOUNT];
+    s.b0 = eSimdSetAll(state.coeffs.b0);
+    s.b1 = eSimdSetAll(state.coeffs.b1);
+    s.b2 = eSimdSetAll(state.coeffs.b2);
+    s.a1 = eSimdSetAll(state.coeffs.a1);
+    s.a2 = eSimdSetAll(state.coeffs.a2);
+    s.in0 = state.in0;
+    s.in1 = state.in1;
+    s.in2 = state.in2;
+    s.out1 = state.out1;
+    s.out2 = state.out2;
+}
 
-    state.filterOn = bw < 0.99f;
-    state.amount = noise * velocity * eTfModMatrixGet(modMatrix, eTfModMatrix::OUTPUT_NOISE_AMOUNT);
+static eFORCEINLINE void eTfBiquadStageStore(const eTfBiquadStage2 &s, eTfFilter &state)
+{
+    state.in0 = s.in0;
+    state.in1 = s.in1;
+    state.in2 = s.in2;
+    state.out1 = s.out1;
+    state.out2 = s.out2;
+}
 
-    if (state.filterOn && state.amount > 0.0f)
+// the filters are indexed by eTfFilter::Type, only
+// the ones of enabled stages have to be set
+template <eU32 STAGES>
+static void eTfFilterCascadeBase(eTfFilter *const *filters, eF32 **signal, eU32 frameSize)
+{
+    eF32 *signal1 = signal[0];
+    eF32 *signal2 = signal[1];
+    const eF32x2 const_6 = eSimdSetAll(1.0f / 6.0f);
+
+    eTfLpStage2 lp;
+    eTfBiquadStage2 hp, bp, nt;
+
+    if (STAGES & eTfFilter::STAGE_LP) eTfLpStageLoad(lp, *filters[eTfFilter::FILTER_LP]);
+    if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageLoad(hp, *filters[eTfFilter::FILTER_HP]);
+    if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageLoad(bp, *filters[eTfFilter::FILTER_BP]);
+    if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageLoad(nt, *filters[eTfFilter::FILTER_NT]);
+
+    for (eU32 i=0; i<frameSize; i++)
     {
-        eF32 f = instr.params[TF_NOISE_FREQ];
-        eTfFilterUpdate(synth, *state.filterHP, f - bw, 0.05f, eTfFilter::FILTER_HP);
-        eTfFilterUpdate(synth, *state.filterLP, f + bw, 0.05f, eTfFilter::FILTER_LP);
+        eF32x2 x = eSimdSet2(signal1[i], signal2[i]);
+
+        if (STAGES & eTfFilter::STAGE_LP) x = eTfLpStageTick(lp, x, const_6);
+        if (STAGES & eTfFilter::STAGE_HP) x = eTfBiquadStageTick<eFALSE>(hp, x);
+        if (STAGES & eTfFilter::STAGE_BP) x = eTfBiquadStageTick<eFALSE>(bp, x);
+        if (STAGES & eTfFilter::STAGE_NT) x = eTfBiquadStageTick<eTRUE>(nt, x);
+
+        eSimdStore2(x, signal1[i], signal2[i]);
     }
+
+    if (STAGES & eTfFilter::STAGE_LP) eTfLpStageStore(lp, *filters[eTfFilter::FILTER_LP]);
+    if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageStore(hp, *filters[eTfFilter::FILTER_HP]);
+    if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageStore(bp, *filters[eTfFilter::FILTER_BP]);
+    if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageStore(nt, *filters[eTfFilter::FILTER_NT]);
 }
 
-eBool eTfNoiseProcess(eTfSynth &synth, eTfNoise &state, eF32 **signal, eU32 frameSize)
+static void eTfFilterProcessBase(eTfFilter *const *filters, eU32 stages, eF32 **signal, eU32 frameSize)
+{
+    static void (*const cascades[])(eTfFilter *const *, eF32 **, eU32) = eTF_FILTER_CASCADES(eTfFilterCascadeBase);
+    cascades[stages](filters, signal, frameSize);
+}
+
+#ifdef eSIMD_DISPATCH
+
+// same recursions as the base version with fused multiply-adds
+static eSIMD_TARGET_AVX2 eFORCEINLINE __m128 eTfLpStageTickAvx2(eTfLpStage2 &s, __m128 in, __m128 const_6)
+{
+    const __m128 x = _mm_fnmadd_ps(s.r, s.y4, in);
+    const __m128 y1 = _mm_fnmadd_ps(s.k, s.y1, _mm_fmadd_ps(x, s.p, _mm_mul_ps(s.oldx, s.p)));
+    const __m128 y2 = _mm_fnmadd_ps(s.k, s.y2, _mm_fmadd_ps(y1, s.p, _mm_mul_ps(s.y1, s.p)));
+    const __m128 y3 = _mm_fnmadd_ps(s.k, s.y3, _mm_fmadd_ps(y2, s.p, _mm_mul_ps(s.y2, s.p)));
+    s.y4 = _mm_fnmadd_ps(s.k, s.y4, _mm_fmadd_ps(y3, s.p, _mm_mul_ps(s.y3, s.p)));
+
+    s.oldx = x;
+    s.y1 = y1;
+    s.y2 = y2;
+    s.y3 = y3;
+    return _mm_fnmadd_ps(_mm_mul_ps(_mm_mul_ps(s.y4, s.y4), s.y4), const_6, s.y4);
+}
+
+template <eBool DELAYED>
+static eSIMD_TARGET_AVX2 eFORCEINLINE __m128 eTfBiquadStageTickAvx2(eTfBiquadStage2 &s, __m128 in)
+{
+    const __m128 x = (DELAYED ? s.in0 : in);
+    __m128 out = _mm_fmadd_ps(s.b2, s.in2, _mm_fmadd_ps(s.b1, s.in1, _mm_mul_ps(s.b0, x)));
+    out = _mm_fnmadd_ps(s.a2, s.out2, _mm_fnmadd_ps(s.a1, s.out1, out));
+
+    s.in2 = s.in1;
+    s.in1 = x;
+    s.in0 = in;
+    s.out2 = s.out1;
+    s.out1 = out;
+    return out;
+}
+
+// four samples at a time moved between the buffers and the per sample vectors
+template <eU32 STAGES>
+static eSIMD_TARGET_AVX2 void eTfFilterCascadeAvx2(eTfFilter *const *filters, eF32 **signal, eU32 frameSize)
 {
     eF32 *signal1 = signal[0];
     eF32 *signal2 = signal[1];
+    const __m128 const_6 = _mm_set1_ps(1.0f / 6.0f);
+    __m128 samples[4];
 
-    if (state.amount > 0.01f)
+    eTfLpStage2 lp;
+    eTfBiquadStage2 hp, bp, nt;
+
+    if (STAGES & eTfFilter::STAGE_LP) eTfLpStageLoad(lp, *filters[eTfFilter::FILTER_LP]);
+    if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageLoad(hp, *filters[eTfFilter::FILTER_HP]);
+    if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageLoad(bp, *filters[eTfFilter::FILTER_BP]);
+    if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageLoad(nt, *filters[eTfFilter::FILTER_NT]);
+
+    for (eU32 i=0; i<frameSize; i+=4)
     {
-        eU32 len = frameSize;
-        while(len--)
+        eU32 count = eMin<eU32>(frameSize - i, 4);
+        eSimdLoadStereo(&signal1[i], &signal2[i], count, samples);
+
+        for (eU32 n=0; n<count; n++)
         {
-            *signal1++ = synth.whiteNoiseTable[state.offset1++] * state.amount;
-            *signal2++ = synth.whiteNoiseTable[state.offset2++] * state.amount;
+            __m128 x = samples[n];
 
-            if (state.offset1 >= TF_NOISETABLESIZE) state.offset1 = 0;
-            if (state.offset2 >= TF_NOISETABLESIZE) state.offset2 = 0;
+            if (STAGES & eTfFilter::STAGE_LP) x = eTfLpStageTickAvx2(lp, x, const_6);
+            if (STAGES & eTfFilter::STAGE_HP) x = eTfBiquadStageTickAvx2<eFALSE>(hp, x);
+            if (STAGES & eTfFilter::STAGE_BP) x = eTfBiquadStageTickAvx2<eFALSE>(bp, x);
+            if (STAGES & eTfFilter::STAGE_NT) x = eTfBiquadStageTickAvx2<eTRUE>(nt, x);
+
+            samples[n] = x;
         }
 
-        if (state.filterOn)
+        eSimdStoreStereo(samples, count, &signal1[i], &signal2[i]);
+    }
+
+    if (STAGES & eTfFilter::STAGE_LP) eTfLpStageStore(lp, *filters[eTfFilter::FILTER_LP]);
+    if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageStore(hp, *filters[eTfFilter::FILTER_HP]);
+    if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageStore(bp, *filters[eTfFilter::FILTER_BP]);
+    if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageStore(nt, *filters[eTfFilter::FILTER_NT]);
+}
+
+static void eTfFilterProcessAvx2(eTfFilter *const *filters, eU32 stages, eF32 **signal, eU32 frameSize)
+{
+    static void (*const cascades[])(eTfFilter *const *, eF32 **, eU32) = eTF_FILTER_CASCADES(eTfFilterCascadeAvx2);
+    cascades[stages](filters, signal, frameSize);
+}
+
+#endif
+
+void eTfFilterProcess(eTfFilter *const *filters, eU32 stages, eF32 **signal, eU32 frameSize)
+{
+    if (stages)
+        TF_KERNELS.filterProcess(filters, stages, signal, frameSize);
+}
+
+static eFORCEINLINE void eTfFilterBankRamp(eF32 *values, eF32 *steps, eU32 lane, eF32 target, eF32 invSteps)
+{
+    steps[lane] = (target - values[lane]) * invSteps;
+    values[lane] = target;
+}
+
+// the ramp of the last tick ended on the current coefficients
+static void eTfFilterBankHold(eTfFilterBank &bank, eU32 voice)
+{
+    for (eU32 i=voice*2; i<voice*2+2; i++)
+    {
+        bank.dk[i] = bank.dp[i] = bank.dr[i] = 0.0f;
+        bank.da1[i] = bank.da2[i] = 0.0f;
+        bank.db0[i] = bank.db1[i] = bank.db2[i] = 0.0f;
+    }
+}
+
+static void eTfFilterBankApply(eTfFilterBank &bank, eU32 voice, const eTfFilterCoeffs &coeffs, eTfFilter::Type type, eU32 frameSize, eBool ramp)
+{
+    eF32 invSteps = 0.0f;
+
+    bank.f[voice] = coeffs.f;
+    bank.q[voice] = coeffs.q;
+    bank.serial[voice] = coeffs.serial;
+
+    if (ramp)
+        invSteps = 1.0f / static_cast<eF32>((frameSize+3)/4);
+
+    for (eU32 i=voice*2; i<voice*2+2; i++)
+    {
+        if (type == eTfFilter::FILTER_LP)
+        {
+            eTfFilterBankRamp(bank.k, bank.dk, i, coeffs.k, invSteps);
+            eTfFilterBankRamp(bank.p, bank.dp, i, coeffs.p, invSteps);
+            eTfFilterBankRamp(bank.r, bank.dr, i, coeffs.r, invSteps);
+        }
+        else
         {
-            eTfFilterProcess(*state.filterLP, eTfFilter::FILTER_LP, signal, frameSize);
-            eTfFilterProcess(*state.filterHP, eTfFilter::FILTER_HP, signal, frameSize);
+            eTfFilterBankRamp(bank.a1, bank.da1, i, coeffs.a1, invSteps);
+            eTfFilterBankRamp(bank.a2, bank.da2, i, coeffs.a2, invSteps);
+            eTfFilterBankRamp(bank.b0, bank.db0, i, coeffs.b0, invSteps);
+            eTfFilterBankRamp(bank.b1, bank.db1, i, coeffs.b1, invSteps);
+            eTfFilterBankRamp(bank.b2, bank.db2, i, coeffs.b2, invSteps);
         }
+    }
+}
 
-        return eTRUE;
+// without a ramp the coefficients jump at the start of the tick,
+// which is what a voice starting with a new note wants
+void eTfFilterBankUpdate(eTfSynth &synth, eTfFilterBank &bank, eU32 voice, eF32 f, eF32 q, eTfFilter::Type type, eU32 frameSize, eBool ramp)
+{
+    const eTfFilterTable &table = eTfFilterTableGet(synth);
+    eTfFilterCoeffs coeffs;
+
+    if (bank.serial[voice] == table.serial && bank.f[voice] == f && bank.q[voice] == q)
+    {
+        eTfFilterBankHold(bank, voice);
+        return;
     }
+
+    coeffs.f = f;
+    coeffs.q = q;
+    coeffs.serial = table.serial;
+    eTfFilterCompute(table, coeffs, f, q, type);
+    eTfFilterBankApply(bank, voice, coeffs, type, frameSize, ramp);
+}
+
+// same as above with coefficients computed by eTfFilterUpdate(),
+// used for the filters all voices share
+void eTfFilterBankSet(eTfFilterBank &bank, eU32 voice, const eTfFilterCoeffs &coeffs, eTfFilter::Type type, eU32 frameSize, eBool ramp)
+{
+    if (bank.serial[voice] == coeffs.serial && bank.f[voice] == coeffs.f && bank.q[voice] == coeffs.q)
+        eTfFilterBankHold(bank, voice);
     else
-    {
-        eMemSet(signal1, 0, sizeof(eF32) * frameSize);
-        eMemSet(signal2, 0, sizeof(eF32) * frameSize);
+        eTfFilterBankApply(bank, voice, coeffs, type, frameSize, ramp);
+}
 
-        return eFALSE;
+// a tick cut short by an event leaves the coefficients where its
+// ramp got to, the next tick ramps on from there
+void eTfFilterBankCut(eTfFilterBank &bank, eU32 voice, eU32 done, eU32 frameSize)
+{
+    eF32 back = static_cast<eF32>((frameSize+3)/4 - 1 - (done-1)/4);
+
+    for (eU32 i=voice*2; i<voice*2+2; i++)
+    {
+        bank.k[i] -= bank.dk[i] * back;
+        bank.p[i] -= bank.dp[i] * back;
+        bank.r[i] -= bank.dr[i] * back;
+        bank.a1[i] -= bank.da1[i] * back;
+        bank.a2[i] -= bank.da2[i] * back;
+        bank.b0[i] -= bank.db0[i] * back;
+        bank.b1[i] -= bank.db1[i] * back;
+        bank.b2[i] -= bank.db2[i] * back;
     }
+
+    bank.serial[voice] = 0;
 }
 
-// ------------------------------------------------------------------------------------
-// FILTER
-// ------------------------------------------------------------------------------------
+static eFORCEINLINE eF32x4 eTfFilterBankGather(const eF32 *values, const eU32 *lanes)
+{
+    eALIGN16 eF32 v[4] = { values[lanes[0]], values[lanes[1]], values[lanes[2]], values[lanes[3]] };
+    return eSimdLoad(v);
+}
 
-void eTfFilterUpdate(eTfSynth &synth, eTfFilter &state, eF32 f, eF32 q, eTfFilter::Type type)
+static eFORCEINLINE void eTfFilterBankScatter(eF32x4 v, eF32 *values, const eU32 *lanes)
 {
-    f = eClamp<eF32>(0.0f, f, 1.0f);
-    q = eClamp<eF32>(0.0f, q, 0.85f);
+    eALIGN16 eF32 buf[4];
+    eSimdStore(v, buf);
 
-    if (type == eTfFilter::FILTER_LP)
+    for (eU32 i=0; i<4; i++)
+        values[lanes[i]] = buf[i];
+}
+
+// loads four samples of four lanes and transposes them
+// to one vector per sample holding all lanes
+static eFORCEINLINE void eTfFilterBankLoad(eF32 *const *signals, eU32 offset, eU32 count, eF32x4 *samples)
+{
+    for (eU32 i=0; i<4; i++)
     {
-        f = f * f * 20000.0f + 30.0f;
-        f = 2.0f * f / synth.sampleRate; //[0 - 1]
-        state.k = 3.6f*f - 1.6f*f*f -1.0f; //(Empirical tunning)
-        state.p = (state.k+1.0f)*0.5f;
-        eF32 scale = ePow(eEXPONE, ((1.0f-state.p)*1.386249f));
-        state.r = q*scale;
+        if (count == 4)
+            samples[i] = eSimdLoad(&signals[i][offset]);
+        else
+        {
+            eALIGN16 eF32 buf[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (eU32 j=0; j<count; j++)
+                buf[j] = signals[i][offset+j];
+            samples[i] = eSimdLoad(buf);
+        }
     }
-    else if (type == eTfFilter::FILTER_NT)
-    {
-        f = f * f * 20000.0f + 30.0f;
 
-        eF32 z1x = eCos(2.0f * ePI * f / synth.sampleRate);
+    eSimdTranspose(samples[0], samples[1], samples[2], samples[3]);
+}
 
-        state.b0 = (1.0f-q)*(1.0f-q)/(2.0f*(eAbs(z1x)+1.0f)) + q;
-        state.b2 = state.b0;
-        state.b1 = -2.0f * z1x * state.b0;
-        state.a1 = -2.0f * z1x * q;
-        state.a2 = q*q;
-    }
-    else
+// inverse of eTfFilterBankLoad, only the first lanes are stored
+static eFORCEINLINE void eTfFilterBankStore(eF32x4 *samples, eF32 *const *signals, eU32 offset, eU32 count, eU32 lanes)
+{
+    eSimdTranspose(samples[0], samples[1], samples[2], samples[3]);
+
+    for (eU32 i=0; i<lanes; i++)
     {
-        f = f * f * 10000.0f + 30.0f;
-        eF32 w0 = 2.0f * ePI * f / synth.sampleRate;
+        if (count == 4)
+            eSimdStore(samples[i], &signals[i][offset]);
+        else
+        {
+            eALIGN16 eF32 buf[4];
+            eSimdStore(samples[i], buf);
+            for (eU32 j=0; j<count; j++)
+                signals[i][offset+j] = buf[j];
+        }
+    }
+}
+
+
+static eFORCEINLINE void eTfLpStageGather(eTfLpStage4 &s, const eTfFilterBank &bank, const eU32 *slots)
+{
+    s.dp = eTfFilterBankGather(bank.dp, slots);
+    s.dr = eTfFilterBankGather(bank.dr, slots);
+    s.dk = eTfFilterBankGather(bank.dk, slots);
+    s.tp = eTfFilterBankGather(bank.p, slots);
+    s.tr = eTfFilterBankGather(bank.r, slots);
+    s.tk = eTfFilterBankGather(bank.k, slots);
+    s.oldx = eTfFilterBankGather(bank.oldx, slots);
+    s.y1 = eTfFilterBankGather(bank.y1, slots);
+    s.y2 = eTfFilterBankGather(bank.y2, slots);
+    s.y3 = eTfFilterBankGather(bank.y3, slots);
+    s.y4 = eTfFilterBankGather(bank.y4, slots);
+}
 
-        const eF32 cos_w0 = eCos(w0);
-        const eF32 sin_w0 = eSin(w0);
+// the bank holds the coefficients reached at the end of the tick,
+// a group of four samples back steps before the end uses the ramp's
+// value there. it's computed from the end instead of summed up, so it
+// doesn't depend on how the tick is split up
+static eFORCEINLINE void eTfLpStageRamp(eTfLpStage4 &s, eF32x4 back)
+{
+    s.p = eSimdNfma(s.tp, s.dp, back);
+    s.r = eSimdNfma(s.tr, s.dr, back);
+    s.k = eSimdNfma(s.tk, s.dk, back);
+}
 
-        eF32 alpha = sin_w0 * eSinH( eLog10(2.0f)/2.0f * (1.0f - q) * w0/sin_w0 );
+static eFORCEINLINE void eTfBiquadStageRamp(eTfBiquadStage4 &s, eF32x4 back)
+{
+    s.b0 = eSimdNfma(s.tb0, s.db0, back);
+    s.b1 = eSimdNfma(s.tb1, s.db1, back);
+    s.b2 = eSimdNfma(s.tb2, s.db2, back);
+    s.a1 = eSimdNfma(s.ta1, s.da1, back);
+    s.a2 = eSimdNfma(s.ta2, s.da2, back);
+}
 
-        if (type == eTfFilter::FILTER_HP)
+static eFORCEINLINE void eTfLpStageScatter(const eTfLpStage4 &s, eTfFilterBank &bank, const eU32 *slots)
+{
+    eTfFilterBankScatter(s.oldx, bank.oldx, slots);
+    eTfFilterBankScatter(s.y1, bank.y1, slots);
+    eTfFilterBankScatter(s.y2, bank.y2, slots);
+    eTfFilterBankScatter(s.y3, bank.y3, slots);
+    eTfFilterBankScatter(s.y4, bank.y4, slots);
+}
+
+static eFORCEINLINE void eTfBiquadStageGather(eTfBiquadStage4 &s, const eTfFilterBank &bank, const eU32 *slots)
+{
+    s.db0 = eTfFilterBankGather(bank.db0, slots);
+    s.db1 = eTfFilterBankGather(bank.db1, slots);
+    s.db2 = eTfFilterBankGather(bank.db2, slots);
+    s.da1 = eTfFilterBankGather(bank.da1, slots);
+    s.da2 = eTfFilterBankGather(bank.da2, slots);
+    s.tb0 = eTfFilterBankGather(bank.b0, slots);
+    s.tb1 = eTfFilterBankGather(bank.b1, slots);
+    s.tb2 = eTfFilterBankGather(bank.b2, slots);
+    s.ta1 = eTfFilterBankGather(bank.a1, slots);
+    s.ta2 = eTfFilterBankGather(bank.a2, slots);
+    s.in0 = eTfFilterBankGather(bank.in0, slots);
+    s.in1 = eTfFilterBankGather(bank.in1, slots);
+    s.in2 = eTfFilterBankGather(bank.in2, slots);
+    s.out1 = eTfFilterBankGather(bank.out1, slots);
+    s.out2 = eTfFilterBankGather(bank.out2, slots);
+}
+
+static eFORCEINLINE void eTfBiquadStageScatter(const eTfBiquadStage4 &s, eTfFilterBank &bank, const eU32 *slots)
+{
+    eTfFilterBankScatter(s.in0, bank.in0, slots);
+    eTfFilterBankScatter(s.in1, bank.in1, slots);
+    eTfFilterBankScatter(s.in2, bank.in2, slots);
+    eTfFilterBankScatter(s.out1, bank.out1, slots);
+    eTfFilterBankScatter(s.out2, bank.out2, slots);
+}
+
+// lanes are processed in groups of four, a group not filled up
+// runs the remaining lanes on spare filter memory. the banks are
+// indexed by eTfFilter::Type like the stereo filters
+template <eU32 STAGES>
+static void eTfFilterBankCascadeBase(eTfFilterBank *banks, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize)
+{
+    const eF32x4 const_6 = eSimdSetAll4(1.0f / 6.0f);
+    const eU32 steps = (tickSize+3)/4;
+
+    for (eU32 g=0; g<laneCount; g+=4)
+    {
+        eU32 groupLanes = eMin<eU32>(laneCount - g, 4);
+        eU32 slots[4];
+        eF32 *sigs[4];
+
+        for (eU32 i=0; i<4; i++)
         {
-            state.b0 = (1.0f + cos_w0) / 2.0f;
-            state.b1 = -(1.0f + cos_w0);
-            state.b2 = state.b0;
+            slots[i] = (i < groupLanes ? lanes[g+i] : TF_VOICELANES + i);
+            sigs[i] = signals[i < groupLanes ? g+i : g];
         }
-        else if (type == eTfFilter::FILTER_BP)
+
+        eTfLpStage4 lp;
+        eTfBiquadStage4 hp, bp, nt;
+
+        if (STAGES & eTfFilter::STAGE_LP) eTfLpStageGather(lp, banks[eTfFilter::FILTER_LP], slots);
+        if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageGather(hp, banks[eTfFilter::FILTER_HP], slots);
+        if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageGather(bp, banks[eTfFilter::FILTER_BP], slots);
+        if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageGather(nt, banks[eTfFilter::FILTER_NT], slots);
+
+        eF32x4 samples[4];
+        eU32 count;
+
+        // the chunks follow the groups of four samples
+        // of the tick, which the ramp steps on
+        for (eU32 i=0; i<frameSize; i+=count)
         {
-            state.b0 = sin_w0 / 2.0f;
-            state.b1 = 0.0f;
-            state.b2 = -state.b0;
+            count = eMin<eU32>(frameSize - i, 4 - ((offset + i) & 3));
+            eTfFilterBankLoad(sigs, i, count, samples);
+
+            const eF32x4 back = eSimdSetAll4(static_cast<eF32>(steps - 1 - (offset + i)/4));
+
+            if (STAGES & eTfFilter::STAGE_LP) eTfLpStageRamp(lp, back);
+            if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageRamp(hp, back);
+            if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageRamp(bp, back);
+            if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageRamp(nt, back);
+
+            for (eU32 n=0; n<count; n++)
+            {
+                eF32x4 x = samples[n];
+
+                if (STAGES & eTfFilter::STAGE_LP) x = eTfLpStageTick(lp, x, const_6);
+                if (STAGES & eTfFilter::STAGE_HP) x = eTfBiquadStageTick<eFALSE>(hp, x);
+                if (STAGES & eTfFilter::STAGE_BP) x = eTfBiquadStageTick<eFALSE>(bp, x);
+                if (STAGES & eTfFilter::STAGE_NT) x = eTfBiquadStageTick<eTRUE>(nt, x);
+
+                samples[n] = x;
+            }
+
+            eTfFilterBankStore(samples, sigs, i, count, groupLanes);
         }
 
-        state.a0 =   1.0f + alpha;
-        state.a1 =  -2.0f * cos_w0;
-        state.a2 =   1.0f - alpha;
+        if (STAGES & eTfFilter::STAGE_LP) eTfLpStageScatter(lp, banks[eTfFilter::FILTER_LP], slots);
+        if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageScatter(hp, banks[eTfFilter::FILTER_HP], slots);
+        if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageScatter(bp, banks[eTfFilter::FILTER_BP], slots);
+        if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageScatter(nt, banks[eTfFilter::FILTER_NT], slots);
+    }
+}
+
+static void eTfFilterBankProcessBase(eTfFilterBank *banks, eU32 stages, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize)
+{
+    static void (*const cascades[])(eTfFilterBank *, const eU32 *, eU32, eF32 **, eU32, eU32, eU32) = eTF_FILTER_CASCADES(eTfFilterBankCascadeBase);
+    cascades[stages](banks, lanes, laneCount, signals, offset, frameSize, tickSize);
+}
+
+#ifdef eSIMD_DISPATCH
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfFilterBankLoad8(eF32 *const *signals, eU32 offset, eU32 count, __m256 *samples)
+{
+    __m128 lo[4], hi[4];
+    eTfFilterBankLoad(signals, offset, count, lo);
+    eTfFilterBankLoad(signals + 4, offset, count, hi);
 
-        state.b0 /= state.a0;
-        state.b1 /= state.a0;
-        state.b2 /= state.a0;
-        state.a1 /= state.a0;
-        state.a2 /= state.a0;
+    for (eU32 i=0; i<4; i++)
+        samples[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[i]), hi[i], 1);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfFilterBankStore8(__m256 *samples, eF32 *const *signals, eU32 offset, eU32 count, eU32 lanes)
+{
+    __m128 lo[4], hi[4];
+
+    for (eU32 i=0; i<4; i++)
+    {
+        lo[i] = _mm256_castps256_ps128(samples[i]);
+        hi[i] = _mm256_extractf128_ps(samples[i], 1);
     }
+
+    eTfFilterBankStore(lo, signals, offset, count, eMin<eU32>(lanes, 4));
+    if (lanes > 4)
+        eTfFilterBankStore(hi, signals + 4, offset, count, lanes - 4);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE __m256 eTfFilterBankGather8(const eF32 *values, const eU32 *lanes)
+{
+    return _mm256_i32gather_ps(values, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes)), 4);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfFilterBankScatter8(__m256 v, eF32 *values, const eU32 *lanes)
+{
+    eF32 buf[8];
+    _mm256_storeu_ps(buf, v);
+
+    for (eU32 i=0; i<8; i++)
+        values[lanes[i]] = buf[i];
+}
+
+struct eTfLpStage8
+{
+    __m256          p, r, k;
+    __m256          tp, tr, tk;     // reached at the end of the tick
+    __m256          dp, dr, dk;
+    __m256          oldx, y1, y2, y3, y4;
+};
+
+struct eTfBiquadStage8
+{
+    __m256          b0, b1, b2, a1, a2;
+    __m256          tb0, tb1, tb2, ta1, ta2;
+    __m256          db0, db1, db2, da1, da2;
+    __m256          in0, in1, in2, out1, out2;
+};
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfLpStageGather8(eTfLpStage8 &s, const eTfFilterBank &bank, const eU32 *slots)
+{
+    s.dp = eTfFilterBankGather8(bank.dp, slots);
+    s.dr = eTfFilterBankGather8(bank.dr, slots);
+    s.dk = eTfFilterBankGather8(bank.dk, slots);
+    s.tp = eTfFilterBankGather8(bank.p, slots);
+    s.tr = eTfFilterBankGather8(bank.r, slots);
+    s.tk = eTfFilterBankGather8(bank.k, slots);
+    s.oldx = eTfFilterBankGather8(bank.oldx, slots);
+    s.y1 = eTfFilterBankGather8(bank.y1, slots);
+    s.y2 = eTfFilterBankGather8(bank.y2, slots);
+    s.y3 = eTfFilterBankGather8(bank.y3, slots);
+    s.y4 = eTfFilterBankGather8(bank.y4, slots);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfLpStageRamp8(eTfLpStage8 &s, __m256 back)
+{
+    s.p = _mm256_fnmadd_ps(s.dp, back, s.tp);
+    s.r = _mm256_fnmadd_ps(s.dr, back, s.tr);
+    s.k = _mm256_fnmadd_ps(s.dk, back, s.tk);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfBiquadStageRamp8(eTfBiquadStage8 &s, __m256 back)
+{
+    s.b0 = _mm256_fnmadd_ps(s.db0, back, s.tb0);
+    s.b1 = _mm256_fnmadd_ps(s.db1, back, s.tb1);
+    s.b2 = _mm256_fnmadd_ps(s.db2, back, s.tb2);
+    s.a1 = _mm256_fnmadd_ps(s.da1, back, s.ta1);
+    s.a2 = _mm256_fnmadd_ps(s.da2, back, s.ta2);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfLpStageScatter8(const eTfLpStage8 &s, eTfFilterBank &bank, const eU32 *slots)
+{
+    eTfFilterBankScatter8(s.oldx, bank.oldx, slots);
+    eTfFilterBankScatter8(s.y1, bank.y1, slots);
+    eTfFilterBankScatter8(s.y2, bank.y2, slots);
+    eTfFilterBankScatter8(s.y3, bank.y3, slots);
+    eTfFilterBankScatter8(s.y4, bank.y4, slots);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfBiquadStageGather8(eTfBiquadStage8 &s, const eTfFilterBank &bank, const eU32 *slots)
+{
+    s.db0 = eTfFilterBankGather8(bank.db0, slots);
+    s.db1 = eTfFilterBankGather8(bank.db1, slots);
+    s.db2 = eTfFilterBankGather8(bank.db2, slots);
+    s.da1 = eTfFilterBankGather8(bank.da1, slots);
+    s.da2 = eTfFilterBankGather8(bank.da2, slots);
+    s.tb0 = eTfFilterBankGather8(bank.b0, slots);
+    s.tb1 = eTfFilterBankGather8(bank.b1, slots);
+    s.tb2 = eTfFilterBankGather8(bank.b2, slots);
+    s.ta1 = eTfFilterBankGather8(bank.a1, slots);
+    s.ta2 = eTfFilterBankGather8(bank.a2, slots);
+    s.in0 = eTfFilterBankGather8(bank.in0, slots);
+    s.in1 = eTfFilterBankGather8(bank.in1, slots);
+    s.in2 = eTfFilterBankGather8(bank.in2, slots);
+    s.out1 = eTfFilterBankGather8(bank.out1, slots);
+    s.out2 = eTfFilterBankGather8(bank.out2, slots);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE void eTfBiquadStageScatter8(const eTfBiquadStage8 &s, eTfFilterBank &bank, const eU32 *slots)
+{
+    eTfFilterBankScatter8(s.in0, bank.in0, slots);
+    eTfFilterBankScatter8(s.in1, bank.in1, slots);
+    eTfFilterBankScatter8(s.in2, bank.in2, slots);
+    eTfFilterBankScatter8(s.out1, bank.out1, slots);
+    eTfFilterBankScatter8(s.out2, bank.out2, slots);
+}
+
+static eSIMD_TARGET_AVX2 eFORCEINLINE __m256 eTfLpStageTickAvx2(eTfLpStage8 &s, __m256 in, __m256 const_6)
+{
+    const __m256 x = _mm256_fnmadd_ps(s.r, s.y4, in);
+    const __m256 y1 = _mm256_fnmadd_ps(s.k, s.y1, _mm256_fmadd_ps(x, s.p, _mm256_mul_ps(s.oldx, s.p)));
+    const __m256 y2 = _mm256_fnmadd_ps(s.k, s.y2, _mm256_fmadd_ps(y1, s.p, _mm256_mul_ps(s.y1, s.p)));
+    const __m256 y3 = _mm256_fnmadd_ps(s.k, s.y3, _mm256_fmadd_ps(y2, s.p, _mm256_mul_ps(s.y2, s.p)));
+    s.y4 = _mm256_fnmadd_ps(s.k, s.y4, _mm256_fmadd_ps(y3, s.p, _mm256_mul_ps(s.y3, s.p)));
+
+    s.oldx = x;
+    s.y1 = y1;
+    s.y2 = y2;
+    s.y3 = y3;
+    return _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_mul_ps(s.y4, s.y4), s.y4), const_6, s.y4);
 }
 
-void eTfFilterProcess(eTfFilter &state, eTfFilter::Type type, eF32 **signal, eU32 frameSize)
+template <eBool DELAYED>
+static eSIMD_TARGET_AVX2 eFORCEINLINE __m256 eTfBiquadStageTickAvx2(eTfBiquadStage8 &s, __m256 in)
 {
-    eASSERT_ALIGNED16(&state);
+    const __m256 x = (DELAYED ? s.in0 : in);
+    __m256 out = _mm256_fmadd_ps(s.b2, s.in2, _mm256_fmadd_ps(s.b1, s.in1, _mm256_mul_ps(s.b0, x)));
+    out = _mm256_fnmadd_ps(s.a2, s.out2, _mm256_fnmadd_ps(s.a1, s.out1, out));
+
+    s.in2 = s.in1;
+    s.in1 = x;
+    s.in0 = in;
+    s.out2 = s.out1;
+    s.out1 = out;
+    return out;
+}
 
-    eF32 *signal1 = signal[0];
-    eF32 *signal2 = signal[1];
-    eU32 len = frameSize;
+// eight lanes per group and fused multiply-adds. with all four stages
+// enabled not all of the memory fits into registers, but what spills
+// stays in the stack's cache lines instead of going through the buffers
+template <eU32 STAGES>
+static eSIMD_TARGET_AVX2 void eTfFilterBankCascadeAvx2(eTfFilterBank *banks, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize)
+{
+    const __m256 const_6 = _mm256_set1_ps(1.0f / 6.0f);
+    const eU32 steps = (tickSize+3)/4;
 
-    if (type == eTfFilter::FILTER_LP)
+    for (eU32 g=0; g<laneCount; g+=8)
     {
-        eF32x2 p = eSimdSetAll(state.p);
-        eF32x2 r = eSimdSetAll(state.r);
-        eF32x2 k = eSimdSetAll(state.k);
-
-        eF32x2 x;
-        eF32x2 const_6 = eSimdSetAll(1.0f / 6.0f);
+        eU32 groupLanes = eMin<eU32>(laneCount - g, 8);
+        eU32 slots[8];
+        eF32 *sigs[8];
 
-        while (len--)
+        for (eU32 i=0; i<8; i++)
         {
-            eF32x2 in = eSimdSet2((eF32)*signal1, (eF32)*signal2);
+            slots[i] = (i < groupLanes ? lanes[g+i] : TF_VOICELANES + i);
+            sigs[i] = signals[i < groupLanes ? g+i : g];
+        }
 
-            // x = in - r * y4
-            x = eSimdNfma(in, r, state.y4);
+        eTfLpStage8 lp;
+        eTfBiquadStage8 hp, bp, nt;
 
-            // state->y1_l=x_l*state->p + state->oldx_l*state->p - state->k*state->y1_l;
-            state.y1 = eSimdNfma(eSimdFma(eSimdMul(state.oldx, p), x, p), k, state.y1);
+        if (STAGES & eTfFilter::STAGE_LP) eTfLpStageGather8(lp, banks[eTfFilter::FILTER_LP], slots);
+        if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageGather8(hp, banks[eTfFilter::FILTER_HP], slots);
+        if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageGather8(bp, banks[eTfFilter::FILTER_BP], slots);
+        if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageGather8(nt, banks[eTfFilter::FILTER_NT], slots);
 
-            //state->y2_l=state->y1_l*state->p+state->oldy1_l*state->p - state->k*state->y2_l;
-            state.y2 = eSimdNfma(eSimdFma(eSimdMul(state.oldy1, p), state.y1, p), k, state.y2);
+        __m256 samples[4];
+        eU32 count;
 
-            //state->y3_l=state->y2_l*state->p+state->oldy2_l*state->p - state->k*state->y3_l;
-            state.y3 = eSimdNfma(eSimdFma(eSimdMul(state.oldy2, p), state.y2, p), k, state.y3);
+        for (eU32 i=0; i<frameSize; i+=count)
+        {
+            count = eMin<eU32>(frameSize - i, 4 - ((offset + i) & 3));
+            eTfFilterBankLoad8(sigs, i, count, samples);
 
-            //state->y4_l=state->y3_l*state->p+state->oldy3_l*state->p - state->k*state->y4_l;
-            state.y4 = eSimdNfma(eSimdFma(eSimdMul(state.oldy3, p), state.y3, p), k, state.y4);
+            const __m256 back = _mm256_set1_ps(static_cast<eF32>(steps - 1 - (offset + i)/4));
 
-            //out_l = state->y4_l - (state->y4_l*state->y4_l*state->y4_l)/6;
-            eF32x2 out = eSimdNfma(state.y4, eSimdMul(eSimdMul(state.y4, state.y4), state.y4), const_6);
+            if (STAGES & eTfFilter::STAGE_LP) eTfLpStageRamp8(lp, back);
+            if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageRamp8(hp, back);
+            if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageRamp8(bp, back);
+            if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageRamp8(nt, back);
 
-            state.oldx = x;
-            state.oldy1 = state.y1;
-            state.oldy2 = state.y2;
-            state.oldy3 = state.y3;
+            for (eU32 n=0; n<count; n++)
+            {
+                __m256 x = samples[n];
 
-            eSimdStore2(out, *signal1, *signal2);
-            signal1++;
-            signal2++;
-        }
+                if (STAGES & eTfFilter::STAGE_LP) x = eTfLpStageTickAvx2(lp, x, const_6);
+                if (STAGES & eTfFilter::STAGE_HP) x = eTfBiquadStageTickAvx2<eFALSE>(hp, x);
+                if (STAGES & eTfFilter::STAGE_BP) x = eTfBiquadStageTickAvx2<eFALSE>(bp, x);
+                if (STAGES & eTfFilter::STAGE_NT) x = eTfBiquadStageTickAvx2<eTRUE>(nt, x);
 
-        state.y1 = state.oldy1;
-        state.y2 = state.oldy2;
-        state.y3 = state.oldy3;
-    }
-    else if (type == eTfFilter::FILTER_NT)
-    {
-        eF32x2 b0 = eSimdSetAll(state.b0);
-        eF32x2 b1 = eSimdSetAll(state.b1);
-        eF32x2 b2 = eSimdSetAll(state.b2);
-        eF32x2 a1 = eSimdSetAll(state.a1);
-        eF32x2 a2 = eSimdSetAll(state.a2);
+                samples[n] = x;
+            }
 
-        while(len--)
-        {
-            eF32x2 out  = eSimdSub(
-                            eSimdSub(
-                                eSimdAdd(
-                                    eSimdAdd(
-                                        eSimdMul(b0, state.in0),
-                                        eSimdMul(b1, state.in1)),
-                                    eSimdMul(b2, state.in2)),
-                                eSimdMul(a1, state.out1)),
-                            eSimdMul(a2, state.out2));
-
-            state.out2 = state.out1;
-            state.out1 = out;
-            state.in2 = state.in1;
-            state.in1 = state.in0;
-
-            state.in0 = eSimdSet2(*signal1, *signal2);
-
-            eSimdStore2(out, *signal1, *signal2);
-
-            signal1++;
-            signal2++;
+            eTfFilterBankStore8(samples, sigs, i, count, groupLanes);
         }
-    }
-    else
-    {
-        eF32x2 b0 = eSimdSetAll(state.b0);
-        eF32x2 b1 = eSimdSetAll(state.b1);
-        eF32x2 b2 = eSimdSetAll(state.b2);
-        eF32x2 a1 = eSimdSetAll(state.a1);
-        eF32x2 a2 = eSimdSetAll(state.a2);
 
-        while(len--)
-        {
-            eF32x2 in = eSimdSet2(*signal1, *signal2);
-
-            eF32x2 out = eSimdNfma(
-                            eSimdNfma(
-                                eSimdFma(
-                                    eSimdFma(
-                                        eSimdMul(b0, in),
-                                        b1, state.in1
-                                        ),
-                                    b2, state.in2
-                                    ),
-                                a1, state.out1
-                                ),
-                            a2, state.out2
-                         );
-
-            eSimdStore2(out, *signal1, *signal2);
-
-            signal1++;
-            signal2++;
-
-            state.in2 = state.in1;
-            state.in1 = in;
-            state.out2 = state.out1;
-            state.out1 = out;
-        }
+        if (STAGES & eTfFilter::STAGE_LP) eTfLpStageScatter8(lp, banks[eTfFilter::FILTER_LP], slots);
+        if (STAGES & eTfFilter::STAGE_HP) eTfBiquadStageScatter8(hp, banks[eTfFilter::FILTER_HP], slots);
+        if (STAGES & eTfFilter::STAGE_BP) eTfBiquadStageScatter8(bp, banks[eTfFilter::FILTER_BP], slots);
+        if (STAGES & eTfFilter::STAGE_NT) eTfBiquadStageScatter8(nt, banks[eTfFilter::FILTER_NT], slots);
     }
 }
 
+static void eTfFilterBankProcessAvx2(eTfFilterBank *banks, eU32 stages, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize)
+{
+    static void (*const cascades[])(eTfFilterBank *, const eU32 *, eU32, eF32 **, eU32, eU32, eU32) = eTF_FILTER_CASCADES(eTfFilterBankCascadeAvx2);
+    cascades[stages](banks, lanes, laneCount, signals, offset, frameSize, tickSize);
+}
+
+#endif
+
+// renders frameSize samples of a control tick of tickSize samples,
+// starting offset samples into it
+void eTfFilterBankProcess(eTfFilterBank *banks, eU32 stages, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize)
+{
+    if (stages)
+        TF_KERNELS.filterBankProcess(banks, stages, lanes, laneCount, signals, offset, frameSize, tickSize);
+}
+
 // ------------------------------------------------------------------------------------
 // VOICE
 // ------------------------------------------------------------------------------------
@@ -1192,8 +3443,25 @@ void eTfVoiceReset(eTfVoice &state)
 {
     state.noteIsOn = eFALSE;
     state.playing = eFALSE;
+    state.controlAhead = 0;
 	state.pitchBendSemitones = 0.0f;
 	state.pitchBendCents = 0.0f;
+    state.generator.cacheEntry = nullptr;
+    state.generator.waveTable = state.generator.resultTable;
+    state.generator.prevEntry = nullptr;
+    state.generator.prevTable = nullptr;
+    state.generator.fading = eFALSE;
+    state.generator.tickActive = eFALSE;
+    state.generator.builtModulation = 0.0f;
+    state.generator.spectrumAge = 0;
+    eMemSet(&state.generator.builtKey, 0, sizeof(state.generator.builtKey));
+    state.generator.freqTableDirty = eTRUE;
+#ifdef eTF_ASYNC_SPECTRUM
+    state.generator.serial = 0;
+    state.generator.job.state.store(TF_SPECTRUM_IDLE);
+    state.generator.job.target = nullptr;
+    state.generator.job.entry = nullptr;
+#endif
     eTfModMatrixReset(state.modMatrix);
     eTfGeneratorReset(state.generator);
     eTfNoiseReset(state.noiseGen);
@@ -1209,6 +3477,7 @@ void eTfVoiceNoteOn(eTfVoice &state, eS32 note, eS32 velocity, eF32 lfoPhase1, e
     state.currentSlop = rand.NextFloat(-1.0f, 1.0f);
     state.noteIsOn = eTRUE;
     state.time = 0;
+    state.controlAhead = 0;
 	state.lastVolL = 0.0f;
 	state.lastVolR = 0.0f;
 
@@ -1252,11 +3521,27 @@ void eTfInstrumentInit(eTfInstrument &instr)
 
     instr.lfo1Phase = instr.lfo2Phase = 0.0f;
     instr.modWheel = 0.0f;
+    eMemSet(instr.filterBank, 0, sizeof(instr.filterBank));
+    instr.modPlan.compiled = eFALSE;
+    instr.paramVersion = 0;
+    instr.decoded.version = ~0u;
+    eMemSet(&instr.control, 0, sizeof(instr.control));
+    instr.control.version = ~0u;
+    instr.tickPos = 0;
+    instr.tickLen = 0;
+    instr.tickDone = 0;
+    instr.tickVoiceCount = 0;
 
     for(eU32 i=0; i<TF_MAXEFFECTS; i++)
     {
         instr.effects[i] = nullptr;
         instr.effectIndex[i] = 0;
+        instr.effectRate[i] = 0;
+#ifdef eTF_ASYNC_SPECTRUM
+        instr.effectJobs[i].state.store(TF_SPECTRUM_IDLE);
+        instr.effectJobs[i].created = nullptr;
+        instr.effectJobs[i].retired = nullptr;
+#endif
     }
 
     for(eU32 i=0; i<TF_MAXVOICES; i++)
@@ -1265,8 +3550,29 @@ void eTfInstrumentInit(eTfInstrument &instr)
 
 void eTfInstrumentFree(eTfInstrument &instr)
 {
+    for (eU32 i = 0; i < TF_MAXVOICES; i++)
+    {
+        eTfGenerator &generator = instr.voice[i].generator;
+
+#ifdef eTF_ASYNC_SPECTRUM
+        // the worker must be done with the voice before it's gone
+        while (generator.job.state.load(std::memory_order_acquire) == TF_SPECTRUM_QUEUED)
+            std::this_thread::yield();
+#endif
+
+        eTfGeneratorRelease(generator);
+    }
+
     for (eU32 i = 0; i < TF_MAXEFFECTS; i++)
     {
+#ifdef eTF_ASYNC_SPECTRUM
+        // same for a pending effect change, its new effect is freed below
+        while (instr.effectJobs[i].state.load(std::memory_order_acquire) == TF_SPECTRUM_QUEUED)
+            std::this_thread::yield();
+
+        eTfEffectCollect(instr, i);
+#endif
+
         eTfEffect *fx = instr.effects[i];
         eU32 fxIndex = instr.effectIndex[i];
 
@@ -1281,14 +3587,164 @@ void eTfInstrumentFree(eTfInstrument &instr)
 	eTfDumpClose();
 }
 
-eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs, eU32 frameSize)
+// effects are made again when the sample rate changed, as
+// their delay lines only fit the rate they were created at
+static eBool eTfEffectStale(const eTfSynth &synth, const eTfInstrument &instr, eU32 slot)
 {
-    eSimdSetArithmeticFlags(eSAF_FTZ);
-    eASSERT(frameSize <= TF_MAXFRAMESIZE);
+    return instr.effects[slot] && instr.effectRate[slot] != synth.sampleRate;
+}
+
+void eTfInstrumentParamsChanged(eTfInstrument &instr)
+{
+    instr.paramVersion++;
+}
+
+// all float to integer conversions of the parameters happen here,
+// the values are clamped so a parameter outside 0..1 can't index
+// outside of the tables
+const eTfInstrumentParams & eTfInstrumentDecode(eTfInstrument &instr)
+{
+    eTfInstrumentParams &dp = instr.decoded;
+
+    if (dp.version == instr.paramVersion)
+        return dp;
+
+    const eF32 *params = instr.params;
+
+    dp.unisono = eTfParamToIndex(params[TF_GEN_UNISONO], TF_MAXUNISONO) + 1;
+    dp.octave = eTfParamToIndex(params[TF_GEN_OCTAVE], TF_MAXOCTAVES);
+    dp.lfoShape[0] = eTfParamToIndex(params[TF_LFO1_SHAPE], TF_LFOSHAPECOUNT);
+    dp.lfoShape[1] = eTfParamToIndex(params[TF_LFO2_SHAPE], TF_LFOSHAPECOUNT);
+    dp.lfoSync[0] = (params[TF_LFO1_SYNC] >= 0.5f);
+    dp.lfoSync[1] = (params[TF_LFO2_SYNC] >= 0.5f);
+    dp.polyphony = eFtoL(eClamp(0.0f, params[TF_GEN_POLYPHONY], 1.0f) * (TF_MAXVOICES-1) + 1);
+    dp.pitchWheelUp = eFtoL(eClamp(0.0f, params[TF_PITCHWHEEL_UP], 1.0f) * 12.0f + 1.0f);
+    dp.pitchWheelDown = eFtoL(eClamp(0.0f, params[TF_PITCHWHEEL_DOWN], 1.0f) * 12.0f + 1.0f);
+
+    dp.filterStages = 0;
+#ifndef eCFG_NO_TF_LOWPASS_FILTER
+    if (params[TF_LP_FILTER_ON] > 0.5f)
+        dp.filterStages |= eTfFilter::STAGE_LP;
+#endif
+#ifndef eCFG_NO_TF_HIGHPASS_FILTER
+    if (params[TF_HP_FILTER_ON] > 0.5f)
+        dp.filterStages |= eTfFilter::STAGE_HP;
+#endif
+#ifndef eCFG_NO_TF_BANDPASS_FILTER
+    if (params[TF_BP_FILTER_ON] > 0.5f)
+        dp.filterStages |= eTfFilter::STAGE_BP;
+#endif
+#ifndef eCFG_NO_TF_NOTCH_FILTER
+    if (params[TF_NT_FILTER_ON] > 0.5f)
+        dp.filterStages |= eTfFilter::STAGE_NT;
+#endif
+
+    for (eU32 i=0; i<TF_MAXEFFECTS; i++)
+        dp.effect[i] = eTfParamToIndex(params[TF_EFFECT_1 + i], FX_COUNT);
+
+    eTfModMatrixCompile(instr);
+
+    dp.version = instr.paramVersion;
+    return dp;
+}
 
-    eF32 *tempBuffers[2];
-    tempBuffers[0] = instr.tempBuffers[0];
-    tempBuffers[1] = instr.tempBuffers[1];
+// computes what all voices share, only redone when the parameters
+// or the sample rate changed since the last block
+static void eTfInstrumentControlUpdate(eTfSynth &synth, eTfInstrument &instr)
+{
+    static const struct
+    {
+        eU32                    cutoff;
+        eU32                    resonance;
+        eTfModMatrix::Output    cutoffMod;
+        eTfModMatrix::Output    resonanceMod;
+    }
+    filterParams[] =
+    {
+        { TF_LP_FILTER_CUTOFF, TF_LP_FILTER_RESONANCE, eTfModMatrix::OUTPUT_LP_FILTER_CUTOFF, eTfModMatrix::OUTPUT_LP_FILTER_RESONANCE },
+        { TF_HP_FILTER_CUTOFF, TF_HP_FILTER_RESONANCE, eTfModMatrix::OUTPUT_HP_FILTER_CUTOFF, eTfModMatrix::OUTPUT_HP_FILTER_RESONANCE },
+        { TF_BP_FILTER_CUTOFF, TF_BP_FILTER_Q, eTfModMatrix::OUTPUT_BP_FILTER_CUTOFF, eTfModMatrix::OUTPUT_BP_FILTER_Q },
+        { TF_NT_FILTER_CUTOFF, TF_NT_FILTER_Q, eTfModMatrix::OUTPUT_NT_FILTER_CUTOFF, eTfModMatrix::OUTPUT_NT_FILTER_Q },
+    };
+
+    eTfInstrumentControl &control = instr.control;
+    const eTfModMatrixPlan &plan = instr.modPlan;
+    const eF32 *params = instr.params;
+
+    if (control.version == instr.paramVersion && control.sampleRate == synth.sampleRate)
+        return;
+
+    control.version = instr.paramVersion;
+    control.sampleRate = synth.sampleRate;
+
+    // envelopes
+    const eF32 scale = 0.00050f * (synth.sampleRate / 44100.0f);
+    control.envScale = scale;
+
+    for (eU32 i=0; i<2; i++)
+    {
+        const eF32 *env = &params[i == 0 ? TF_ADSR1_ATTACK : TF_ADSR2_ATTACK];
+
+        control.envAttack[i] = -eLog10(eMax(0.000000001f, ePow(env[0], 3)) * .94f) * scale;
+        control.envDecay[i] = eTfEnvelopeDecay(env[1], 1.0f, scale);
+        control.envSustain[i] = eMin(env[2], 0.99f);
+        control.envRelease[i] = eLog10(eMax(ePow(env[3], 3), 0.000000001f) * .94f) * 0.25f * scale;
+    }
+
+    // lfos
+    for (eU32 i=0; i<2; i++)
+    {
+        eF32 freq = params[i == 0 ? TF_LFO1_RATE : TF_LFO2_RATE];
+        control.lfoFreq[i] = (freq * freq) / synth.sampleRate * 50.0f;
+    }
+
+    // generator
+    control.genFreq = ePow(params[TF_GEN_FREQ], 2.0f) * 1000.0f;
+    control.genDetune = ePow(params[TF_GEN_DETUNE], 3.0f) * 10.0f;
+    control.genSpread = ePow(params[TF_GEN_SPREAD], 4.0f) / static_cast<eF32>(synth.sampleRate) * 10.0f;
+    control.slop = ePow(params[TF_GEN_SLOP], 3);
+
+    // glide and spectrum modulation move by a fixed amount per
+    // TF_RATEBLOCK samples
+    control.glide = 1.0f - 1.0f / (params[TF_GEN_GLIDE] * 10.0f + 1.0f);
+    control.modulationStep = ePow(params[TF_GEN_MODULATION], 3) / 400.0f / TF_RATEBLOCK;
+
+    // voice filters without any modulation of cutoff and resonance
+    control.filterShared = 0;
+
+    for (eU32 i=0; i<4; i++)
+    {
+        if (!(instr.decoded.filterStages & (1 << i)) ||
+            plan.entryCount[filterParams[i].cutoffMod] || plan.entryCount[filterParams[i].resonanceMod])
+            continue;
+
+        eTfFilterUpdate(synth, control.filter[i], params[filterParams[i].cutoff], params[filterParams[i].resonance], (eTfFilter::Type)i);
+        control.filterShared |= 1 << i;
+    }
+
+    // noise filters
+    eF32 f = params[TF_NOISE_FREQ];
+    eF32 bw = params[TF_NOISE_BW];
+    eTfFilterUpdate(synth, control.noiseHP, f - bw, 0.05f, eTfFilter::FILTER_HP);
+    eTfFilterUpdate(synth, control.noiseLP, f + bw, 0.05f, eTfFilter::FILTER_LP);
+}
+
+// starts a control tick of frameSize samples. all control values are
+// updated once here and stay for the tick's length, which can span
+// more than one call of eTfInstrumentProcess()
+static void eTfInstrumentTickStart(eTfSynth &synth, eTfInstrument &instr, eU32 frameSize)
+{
+    const eTfInstrumentParams &dp = eTfInstrumentDecode(instr);
+    const eTfInstrumentControl &control = instr.control;
+    eTfInstrumentControlUpdate(synth, instr);
+
+    instr.tickLen = frameSize;
+    instr.tickDone = 0;
+    instr.tickVoiceCount = 0;
+    instr.tickStages = dp.filterStages;
+    instr.tickSilent = eTRUE;
+
+    eF32 velocities[TF_MAXVOICES];
 
     for(eU32 k=0;k<TF_MAXVOICES;k++)
     {
@@ -1296,12 +3752,19 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
 
         if (voice.noteIsOn || voice.playing)
         {
+            instr.tickVoices[instr.tickVoiceCount++] = k;
             instr.effectsInactiveTime = 0.0f;
             voice.time++;
+            voice.tickLevel = 0.0f;
+
+            // after a tick cut short by an event the control state is
+            // ahead of the audio, it only moves on once that caught up
+            eU32 advance = frameSize - voice.controlAhead;
+            voice.controlAhead = frameSize;
 
             //  RUN MOD MATRIX
             // -------------------------------------------------------------------------------
-            eBool has_mm_active = eTfModMatrixProcess(synth, instr, voice.modMatrix, frameSize);
+            eBool has_mm_active = eTfModMatrixProcess(synth, instr, voice.modMatrix, advance);
             instr.lfo1Phase = voice.modMatrix.lfoState[0].phase;
             instr.lfo2Phase = voice.modMatrix.lfoState[1].phase;
 
@@ -1313,15 +3776,10 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
                 velocity = 0.0f;
             }
 
-            //  RUN NOISE GEN
+            //  UPDATE NOISE GEN
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_NOISEGEN
-            eTfNoiseUpdate(synth, instr, voice.noiseGen, voice.modMatrix, velocity);
-            eTfNoiseProcess(synth, voice.noiseGen, tempBuffers, frameSize);
-			eTfDumpToFile("tf_after_noise", instr, tempBuffers, frameSize);
-#else
-			eMemSet(tempBuffers[0], 0, sizeof(eF32) * frameSize);
-			eMemSet(tempBuffers[1], 0, sizeof(eF32) * frameSize);
+            eTfNoiseUpdate(instr, voice.noiseGen, voice.modMatrix, velocity);
 #endif
 
             //  CALCULATE FREQUENCY
@@ -1332,8 +3790,8 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
 
             // Pitch wheel calculation
             // -------------------------------------------------------------------------------
-            eU32 semiTonesUp = eFtoL(instr.params[TF_PITCHWHEEL_UP] * 12.0f + 1.0f);
-            eU32 semiTonesDown = eFtoL(instr.params[TF_PITCHWHEEL_DOWN] * 12.0f + 1.0f);
+            eU32 semiTonesUp = dp.pitchWheelUp;
+            eU32 semiTonesDown = dp.pitchWheelDown;
             while (semiTonesUp--) { nextFreq *= TF_12TH_ROOT_OF_2; }
             while (semiTonesDown--) { prevFreq *= (1.0f / TF_12TH_ROOT_OF_2); }
             baseFreq = eLerp(prevFreq, baseFreq, eClamp<eF32>(0.0f, voice.pitchBendSemitones + 1.0f, 1.0f));
@@ -1341,48 +3799,43 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
 
             // SLOP CALCULATION
             // -------------------------------------------------------------------------------
-            eF32 slop = ePow(instr.params[TF_GEN_SLOP], 3);
-            baseFreq += voice.currentSlop * slop * 8.0f;
+            baseFreq += voice.currentSlop * control.slop * 8.0f;
 
             // GLIDE CALCULATION
             // -------------------------------------------------------------------------------
-            eF32 glide = instr.params[TF_GEN_GLIDE];
-            if (glide > 0.0f && voice.currentFreq > 0.0f)
+            if (control.glide > 0.0f && voice.currentFreq > 0.0f)
             {
                 eF32 freqDiff = baseFreq - voice.currentFreq;
-                freqDiff /= glide * 10.0f + 1.0f;
-                voice.currentFreq += freqDiff;
+                voice.currentFreq += freqDiff * (1.0f - ePow(control.glide, static_cast<eF32>(advance) / TF_RATEBLOCK));
             }
             else
                 voice.currentFreq = baseFreq;
 
-            //  RUN GENERATOR
+            //  UPDATE GENERATOR
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_GENERATOR
-            if (voice.time % 4 == 1) // reduce cpu hit a bit. recalculate not more than every 4th frame
-            {
-                eF32 freqRange = eClamp<eF32>(0.0f, (voice.currentFreq-8.0f) / 2000.0f, 1.0f);
-                eF32 invFreqRange = 1.0f - freqRange;
-                invFreqRange = ePow(invFreqRange, 3.0f);
-                eTfGeneratorUpdate(synth, instr, voice, voice.generator, invFreqRange);
+            eTfGeneratorUpdate(instr, voice, voice.generator);
 
-                if (eTfGeneratorModulate(synth, instr, voice.generator))
-                    eMemCopy(voice.generator.resultTable, voice.generator.freqModTable, TF_IFFT_FRAMESIZE * sizeof(eF32) * 2);
+            // the first wavetable of a note is always built right away
+            if (voice.time == 1)
+                eTfGeneratorRefresh(synth, instr, voice.generator, eFALSE);
+            else if (eTfGeneratorScheduled(synth, instr, voice, k, advance))
+            {
+#ifdef eTF_ASYNC_SPECTRUM
+                if (synth.spectrumWorker)
+                    eTfGeneratorQueue(synth, instr, voice.generator);
                 else
-                    eMemCopy(voice.generator.resultTable, voice.generator.freqTable, TF_IFFT_FRAMESIZE * sizeof(eF32) * 2);
-
-                eTfGeneratorFft(IFFT, TF_IFFT_FRAMESIZE, voice.generator.resultTable);
-                eTfGeneratorNormalize(voice.generator.resultTable, TF_IFFT_FRAMESIZE);
+#endif
+                eTfGeneratorRefresh(synth, instr, voice.generator, eTRUE);
             }
 
-            eTfGeneratorProcess(synth, instr, voice, voice.generator, velocity, tempBuffers, frameSize);
-			eTfDumpToFile("tf_after_generator", instr, tempBuffers, frameSize);
+            velocities[k] = velocity;
 #endif
 
-            //  RUN LOWPASS FILTER
+            //  UPDATE LOWPASS FILTER
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_LOWPASS_FILTER
-            if (instr.params[TF_LP_FILTER_ON] > 0.5f)
+            if (dp.filterStages & eTfFilter::STAGE_LP)
             {
                 eF32 lpCutoff = instr.params[TF_LP_FILTER_CUTOFF];
                 eF32 lpResonance = instr.params[TF_LP_FILTER_RESONANCE];
@@ -1390,17 +3843,17 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
                 lpCutoff *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_LP_FILTER_CUTOFF);
                 lpResonance *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_LP_FILTER_RESONANCE);
 
-                eTfFilterUpdate(synth, *voice.filterLP, lpCutoff, lpResonance, eTfFilter::FILTER_LP);
-                eTfFilterProcess(*voice.filterLP, eTfFilter::FILTER_LP, tempBuffers, frameSize);
-
-				eTfDumpToFile("tf_after_lp", instr, tempBuffers, frameSize);
+                if (control.filterShared & eTfFilter::STAGE_LP)
+                    eTfFilterBankSet(instr.filterBank[eTfFilter::FILTER_LP], k, control.filter[eTfFilter::FILTER_LP], eTfFilter::FILTER_LP, frameSize, voice.time > 1);
+                else
+                    eTfFilterBankUpdate(synth, instr.filterBank[eTfFilter::FILTER_LP], k, lpCutoff, lpResonance, eTfFilter::FILTER_LP, frameSize, voice.time > 1);
             }
 #endif
 
-            //  RUN HIGHPASS FILTER
+            //  UPDATE HIGHPASS FILTER
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_HIGHPASS_FILTER
-            if (instr.params[TF_HP_FILTER_ON] > 0.5f)
+            if (dp.filterStages & eTfFilter::STAGE_HP)
             {
                 eF32 hpCutoff = instr.params[TF_HP_FILTER_CUTOFF];
                 eF32 hpResonance = instr.params[TF_HP_FILTER_RESONANCE];
@@ -1408,17 +3861,17 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
                 hpCutoff *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_HP_FILTER_CUTOFF);
                 hpResonance *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_HP_FILTER_RESONANCE);
 
-                eTfFilterUpdate(synth, *voice.filterHP, hpCutoff, hpResonance, eTfFilter::FILTER_HP);
-                eTfFilterProcess(*voice.filterHP, eTfFilter::FILTER_HP, tempBuffers, frameSize);
-
-				eTfDumpToFile("tf_after_hp", instr, tempBuffers, frameSize);
+                if (control.filterShared & eTfFilter::STAGE_HP)
+                    eTfFilterBankSet(instr.filterBank[eTfFilter::FILTER_HP], k, control.filter[eTfFilter::FILTER_HP], eTfFilter::FILTER_HP, frameSize, voice.time > 1);
+                else
+                    eTfFilterBankUpdate(synth, instr.filterBank[eTfFilter::FILTER_HP], k, hpCutoff, hpResonance, eTfFilter::FILTER_HP, frameSize, voice.time > 1);
             }
 #endif
 
-            //  RUN BANDPASS FILTER
+            //  UPDATE BANDPASS FILTER
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_BANDPASS_FILTER
-            if (instr.params[TF_BP_FILTER_ON] > 0.5f)
+            if (dp.filterStages & eTfFilter::STAGE_BP)
             {
                 eF32 bpCutoff = instr.params[TF_BP_FILTER_CUTOFF];
                 eF32 bpQ = instr.params[TF_BP_FILTER_Q];
@@ -1426,17 +3879,17 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
                 bpCutoff *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_BP_FILTER_CUTOFF);
                 bpQ *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_BP_FILTER_Q);
 
-                eTfFilterUpdate(synth, *voice.filterBP, bpCutoff, bpQ, eTfFilter::FILTER_BP);
-                eTfFilterProcess(*voice.filterBP, eTfFilter::FILTER_BP, tempBuffers, frameSize);
-
-				eTfDumpToFile("tf_after_bp", instr, tempBuffers, frameSize);
+                if (control.filterShared & eTfFilter::STAGE_BP)
+                    eTfFilterBankSet(instr.filterBank[eTfFilter::FILTER_BP], k, control.filter[eTfFilter::FILTER_BP], eTfFilter::FILTER_BP, frameSize, voice.time > 1);
+                else
+                    eTfFilterBankUpdate(synth, instr.filterBank[eTfFilter::FILTER_BP], k, bpCutoff, bpQ, eTfFilter::FILTER_BP, frameSize, voice.time > 1);
             }
 #endif
 
-            //  RUN NOTCH FILTER
+            //  UPDATE NOTCH FILTER
             // -------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_NOTCH_FILTER
-            if (instr.params[TF_NT_FILTER_ON] > 0.5f)
+            if (dp.filterStages & eTfFilter::STAGE_NT)
             {
                 eF32 ntCutoff = instr.params[TF_NT_FILTER_CUTOFF];
                 eF32 ntQ = instr.params[TF_NT_FILTER_Q];
@@ -1444,66 +3897,177 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
                 ntCutoff *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_NT_FILTER_CUTOFF);
                 ntQ *= eTfModMatrixGet(voice.modMatrix, eTfModMatrix::OUTPUT_NT_FILTER_Q);
 
-                eTfFilterUpdate(synth, *voice.filterNT, ntCutoff, ntQ, eTfFilter::FILTER_NT);
-                eTfFilterProcess(*voice.filterNT, eTfFilter::FILTER_NT, tempBuffers, frameSize);
-
-				eTfDumpToFile("tf_after_nt", instr, tempBuffers, frameSize);
+                if (control.filterShared & eTfFilter::STAGE_NT)
+                    eTfFilterBankSet(instr.filterBank[eTfFilter::FILTER_NT], k, control.filter[eTfFilter::FILTER_NT], eTfFilter::FILTER_NT, frameSize, voice.time > 1);
+                else
+                    eTfFilterBankUpdate(synth, instr.filterBank[eTfFilter::FILTER_NT], k, ntCutoff, ntQ, eTfFilter::FILTER_NT, frameSize, voice.time > 1);
             }
 #endif
 
-            // MIX SIGNAL
-            // ------------------------------------------------------------------------------
-            eF32 gain = instr.params[TF_GLOBAL_GAIN];
-            voice.playing = eTfSignalMix(outputs, tempBuffers, frameSize, gain);
+#ifndef eCFG_NO_TF_GENERATOR
+            eTfGeneratorAdvanceModulation(voice.generator, control.modulationStep * advance);
+#endif
         }
     }
 
-	eTfDumpToFile("tf_after_mix", instr, outputs, frameSize);
+    //  SET UP GENERATORS
+    // -------------------------------------------------------------------------------
+    // the wavetables rebuilt above are rendered as one batch
+#ifndef eCFG_NO_TF_GENERATOR
+    eTfGeneratorFlush(synth);
 
-    //    RUN EFFECTS
+    for (eU32 i=0; i<instr.tickVoiceCount; i++)
+    {
+        eU32 k = instr.tickVoices[i];
+        eTfVoice &voice = instr.voice[k];
+
+#ifdef eTF_ASYNC_SPECTRUM
+        eTfGeneratorCollect(voice.generator);
+#endif
+
+        eTfGeneratorProcess(synth, instr, voice, voice.generator, velocities[k], frameSize);
+    }
+#endif
+
+    //    SET UP EFFECTS
     // ------------------------------------------------------------------------------
 #ifndef eCFG_NO_TF_FX
-    if (instr.effectsInactiveTime < TF_EFFECT_SWITCHOFF_TIME)
+    instr.tickEffects = (instr.effectsInactiveTime < TF_EFFECT_SWITCHOFF_TIME);
+
+    if (instr.tickEffects)
     {
         for(eU32 i=0;i<TF_MAXEFFECTS;i++)
         {
-            eTfEffect *fx = instr.effects[i];
-
-            eU32 oldFxIndex = instr.effectIndex[i];
-            eF32 fxVal = instr.params[TF_EFFECT_1 + i];
-            eU32 fxIndex = eFtoL(eRoundNearest(fxVal * (FX_COUNT-1)));
+            eU32 fxIndex = dp.effect[i];
 
-            if (fxIndex != oldFxIndex && oldFxIndex != 0)
+#ifdef eTF_ASYNC_SPECTRUM
+            // with a worker the slot is swapped without allocating here,
+            // a changed slot stays silent for the few ms that takes
+            if (synth.spectrumWorker)
             {
-                s_effectDelete[oldFxIndex](fx);
-                instr.effects[i] = fx = nullptr;
-                instr.effectIndex[i] = 0;
-            }
+                eU32 wanted = s_effectCreate[fxIndex] ? fxIndex : 0;
+                eTfEffectCollect(instr, i);
 
-            if (fxIndex != 0 && fx == nullptr)
+                if (wanted != instr.effectIndex[i] || eTfEffectStale(synth, instr, i))
+                    eTfEffectQueue(synth, instr, i, wanted);
+            }
+            else
+#endif
             {
-				if (s_effectCreate[fxIndex]) {
-					instr.effects[i] = fx = s_effectCreate[fxIndex]();
-					instr.effectIndex[i] = fxIndex;
-				}
+                eU32 oldFxIndex = instr.effectIndex[i];
+
+                if ((fxIndex != oldFxIndex || eTfEffectStale(synth, instr, i)) && oldFxIndex != 0)
+                {
+                    s_effectDelete[oldFxIndex](instr.effects[i]);
+                    instr.effects[i] = nullptr;
+                    instr.effectIndex[i] = 0;
+                }
+
+                if (fxIndex != 0 && instr.effects[i] == nullptr)
+                {
+                    if (s_effectCreate[fxIndex]) {
+                        instr.effects[i] = s_effectCreate[fxIndex](synth.sampleRate);
+                        instr.effectIndex[i] = fxIndex;
+                        instr.effectRate[i] = synth.sampleRate;
+                    }
+                }
             }
+        }
+    }
+#endif
+}
+
+// renders the next frameSize samples of the tick in progress
+static eF32 eTfInstrumentTickRender(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs, eU32 frameSize)
+{
+    // voices are rendered into their own buffers first, then the
+    // filters run over all voices at once and the result is mixed
+    const eU32 activeCount = instr.tickVoiceCount;
+    const eU32 offset = instr.tickDone;
+    eU32 lanes[TF_VOICELANES];
+    eF32 *laneSignals[TF_VOICELANES];
+
+    for (eU32 i=0; i<activeCount; i++)
+    {
+        eU32 k = instr.tickVoices[i];
+        eTfVoice &voice = instr.voice[k];
+        eF32 *tempBuffers[2];
+        tempBuffers[0] = synth.voiceBuffers[k*2];
+        tempBuffers[1] = synth.voiceBuffers[k*2+1];
+
+        lanes[i*2] = k*2;
+        lanes[i*2+1] = k*2+1;
+        laneSignals[i*2] = tempBuffers[0];
+        laneSignals[i*2+1] = tempBuffers[1];
+
+        //  RUN NOISE GEN
+        // -------------------------------------------------------------------------------
+#ifndef eCFG_NO_TF_NOISEGEN
+        eTfNoiseProcess(synth, voice.noiseGen, tempBuffers, frameSize);
+		eTfDumpToFile("tf_after_noise", instr, tempBuffers, frameSize);
+#else
+		eMemSet(tempBuffers[0], 0, sizeof(eF32) * frameSize);
+		eMemSet(tempBuffers[1], 0, sizeof(eF32) * frameSize);
+#endif
+
+        //  RUN GENERATOR
+        // -------------------------------------------------------------------------------
+#ifndef eCFG_NO_TF_GENERATOR
+        eTfGeneratorRender(voice.generator, tempBuffers, offset, frameSize);
+        eTfDumpToFile("tf_after_generator", instr, tempBuffers, frameSize);
+#endif
+    }
+
+    //  RUN FILTERS
+    // -------------------------------------------------------------------------------
+    // the enabled filters run as one cascade over all voices
+    eTfFilterBankProcess(instr.filterBank, instr.tickStages, lanes, activeCount*2, laneSignals, offset, frameSize, instr.tickLen);
+
+    // MIX SIGNAL
+    // ------------------------------------------------------------------------------
+    for (eU32 i=0; i<activeCount; i++)
+    {
+        eU32 k = instr.tickVoices[i];
+        eTfVoice &voice = instr.voice[k];
+        eF32 *tempBuffers[2];
+        tempBuffers[0] = synth.voiceBuffers[k*2];
+        tempBuffers[1] = synth.voiceBuffers[k*2+1];
+
+        eTfDumpToFile("tf_after_filters", instr, tempBuffers, frameSize);
+
+        eF32 gain = instr.params[TF_GLOBAL_GAIN];
+        voice.tickLevel += eTfSignalMixLevel(outputs, tempBuffers, frameSize, gain);
+    }
+
+	eTfDumpToFile("tf_after_mix", instr, outputs, frameSize);
+
+    //    RUN EFFECTS
+    // ------------------------------------------------------------------------------
+#ifndef eCFG_NO_TF_FX
+    if (instr.tickEffects)
+    {
+        for(eU32 i=0;i<TF_MAXEFFECTS;i++)
+        {
+            eTfEffect *fx = instr.effects[i];
 
             if (fx != nullptr)
-                s_effectProcess[fxIndex](fx, synth, instr, outputs, frameSize);
+                s_effectProcess[instr.effectIndex[i]](fx, synth, instr, outputs, frameSize);
         }
     }
 
 	eTfDumpToFile("tf_after_fx", instr, outputs, frameSize);
 #endif
 
+    instr.tickDone += frameSize;
+
 #ifndef eCFG_NO_TF_PEAK
     eF32 peak_left = 0.0f;
     eF32 peak_right = 0.0f;
     eTfSignalToPeak(outputs, &peak_left, &peak_right, frameSize);
     eF32 peak = (peak_left + peak_right) / 2.0f;
 
-    if (eIsFloatZero(peak))
-        instr.effectsInactiveTime += (eF32)frameSize / synth.sampleRate;
+    if (!eIsFloatZero(peak))
+        instr.tickSilent = eFALSE;
 
     return peak;
 #else
@@ -1511,17 +4075,156 @@ eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs,
 #endif
 }
 
+// ends the tick in progress, either on the grid or
+// cut short by an event after tickDone samples
+static void eTfInstrumentTickEnd(eTfSynth &synth, eTfInstrument &instr)
+{
+    const eU32 done = instr.tickDone;
+    const eU32 len = instr.tickLen;
+    const eBool cut = (done < len);
+
+    for (eU32 i=0; i<instr.tickVoiceCount; i++)
+    {
+        eU32 k = instr.tickVoices[i];
+        eTfVoice &voice = instr.voice[k];
+
+        voice.controlAhead = len - done;
+
+#ifndef eCFG_NO_TF_GENERATOR
+        eTfGeneratorTickEnd(voice, voice.generator, done, len);
+#endif
+
+        if (cut)
+        {
+            for (eU32 j=0; j<4; j++)
+            {
+                if (instr.tickStages & (1 << j))
+                    eTfFilterBankCut(instr.filterBank[j], k, done, len);
+            }
+        }
+
+        // ticks cut short by an event can't end a voice. those which
+        // realign to the grid after a cut are shorter than a full one,
+        // so their level is measured against a full tick's
+        const eF32 level = voice.tickLevel * (eF32)synth.controlTick / (eF32)done;
+        voice.playing = level > 1.0f || (voice.playing && cut);
+
+        // hand the voice's shared wavetable back once it went silent
+        if (!voice.playing && !voice.noteIsOn)
+            eTfGeneratorRelease(voice.generator);
+    }
+
+#ifndef eCFG_NO_TF_PEAK
+    if (instr.tickSilent)
+        instr.effectsInactiveTime += (eF32)done / synth.sampleRate;
+#endif
+
+    instr.tickPos += done;
+    if (instr.tickPos >= synth.controlTick)
+        instr.tickPos = 0;
+
+    instr.tickLen = 0;
+    instr.tickDone = 0;
+}
+
+// control ticks run on a fixed grid of synth.controlTick samples. a tick
+// is only cut short where an event is, so every event takes effect at
+// its exact sample. a tick which goes on past the end of the block is
+// carried over into the next call, which renders the rest of it with
+// the control values of its start. the block is rendered straight into
+// the outputs without any buffering in between and the output doesn't
+// depend on how the caller splits it up into blocks
+eF32 eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs, eU32 frameSize, const eTfInstrumentEvent *events, eU32 eventCount)
+{
+    eSimdSetArithmeticFlags(eSAF_FTZ);
+    eASSERT(synth.controlTick >= 4 && synth.controlTick <= TF_MAXCONTROLTICK && synth.controlTick % 4 == 0);
+
+    eF32 peak = 0.0f;
+    eU32 done = 0;
+    eU32 next = 0;
+
+    while (done < frameSize)
+    {
+        if (next < eventCount && events[next].offset <= done)
+        {
+            if (instr.tickLen)
+                eTfInstrumentTickEnd(synth, instr);
+
+            while (next < eventCount && events[next].offset <= done)
+                eTfInstrumentApplyEvent(instr, events[next++]);
+        }
+
+        eU32 end = frameSize;
+        if (next < eventCount)
+        {
+            eASSERT(next == 0 || events[next].offset >= events[next-1].offset);
+            end = eMin(end, events[next].offset);
+        }
+
+        if (!instr.tickLen)
+            eTfInstrumentTickStart(synth, instr, synth.controlTick - instr.tickPos);
+
+        eU32 len = eMin(instr.tickLen - instr.tickDone, end - done);
+        eF32 *tickOutputs[2] = { &outputs[0][done], &outputs[1][done] };
+
+        peak = eMax(peak, eTfInstrumentTickRender(synth, instr, tickOutputs, len));
+        done += len;
+
+        if (instr.tickDone == instr.tickLen)
+            eTfInstrumentTickEnd(synth, instr);
+    }
+
+    // events past the end of the block still count, they just don't get
+    // any samples of their own. they cut the tick like those at offset 0
+    // of the next block would
+    if (next < eventCount && instr.tickLen)
+        eTfInstrumentTickEnd(synth, instr);
+
+    while (next < eventCount)
+        eTfInstrumentApplyEvent(instr, events[next++]);
+
+    return peak;
+}
+
+void eTfInstrumentApplyEvent(eTfInstrument &instr, const eTfInstrumentEvent &event)
+{
+    switch (event.type)
+    {
+    case eTfInstrumentEvent::NOTE_ON:
+        eTfInstrumentNoteOn(instr, event.index, event.velocity);
+        break;
+    case eTfInstrumentEvent::NOTE_OFF:
+        eTfInstrumentNoteOff(instr, event.index);
+        break;
+    case eTfInstrumentEvent::ALL_NOTES_OFF:
+        eTfInstrumentAllNotesOff(instr);
+        break;
+    case eTfInstrumentEvent::PITCH_BEND:
+        eTfInstrumentPitchBend(instr, event.value, event.value2);
+        break;
+    case eTfInstrumentEvent::MOD_WHEEL:
+        eTfInstrumentModWheel(instr, event.value);
+        break;
+    case eTfInstrumentEvent::PARAM:
+        eASSERT(event.index >= 0 && event.index < TF_PARAM_COUNT);
+        instr.params[event.index] = event.value;
+        eTfInstrumentParamsChanged(instr);
+        break;
+    }
+}
+
 void eTfInstrumentNoteOn(eTfInstrument &instr, eS32 note, eS32 velocity)
 {
     eF32 lfoPhase1 = 0.0f;
     eF32 lfoPhase2 = 0.0f;
 
     eU32 voice = eTfInstrumentAllocateVoice(instr);
+    const eTfInstrumentParams &dp = eTfInstrumentDecode(instr);
 
-    if (instr.params[TF_LFO1_SYNC] < 0.5f)
+    if (!dp.lfoSync[0])
         lfoPhase1 = instr.lfo1Phase;
 
-    if (instr.params[TF_LFO2_SYNC] < 0.5f)
+    if (!dp.lfoSync[1])
         lfoPhase2 = instr.lfo2Phase;
 
     eTfVoiceNoteOn(instr.voice[voice], note, velocity, lfoPhase1, lfoPhase2);
@@ -1590,7 +4293,7 @@ eU32 eTfInstrumentGetPolyphony(eTfInstrument &instr)
 
 eU32 eTfInstrumentAllocateVoice(eTfInstrument &instr)
 {
-    eU32 poly = eFtoL(instr.params[TF_GEN_POLYPHONY] * (TF_MAXVOICES-1) + 1);
+    eU32 poly = eTfInstrumentDecode(instr).polyphony;
 
     eU32 time = 0;
     eS32 chosen = -1;
@@ -1709,6 +4412,47 @@ eF32 eTfStepSequencerProcess(eTfStepSequencer &seq, eF32 **outputs, eU32 sampleF
     return 0.0f;
 }
 
+// ------------------------------------------------------------------------------------
+// KERNELS
+// ------------------------------------------------------------------------------------
+
+eTfKernels TF_KERNELS;
+
+// the instruction set is the same for all synths in the process,
+// so initializing another synth rewrites the same pointers
+void eTfKernelsInit(eSimdIsa isa)
+{
+    TF_KERNELS.isa = eSIMD_ISA_BASE;
+    TF_KERNELS.signalMix = eTfSignalMixBase;
+    TF_KERNELS.signalToS16 = eTfSignalToS16Base;
+    TF_KERNELS.filterProcess = eTfFilterProcessBase;
+    TF_KERNELS.filterBankProcess = eTfFilterBankProcessBase;
+    TF_KERNELS.generatorRead = eTfGeneratorReadBase;
+
+#ifdef eSIMD_DISPATCH
+    if (isa >= eSIMD_ISA_AVX2)
+    {
+        TF_KERNELS.isa = eSIMD_ISA_AVX2;
+        TF_KERNELS.signalMix = eTfSignalMixAvx2;
+        TF_KERNELS.signalToS16 = eTfSignalToS16Avx2;
+        TF_KERNELS.filterProcess = eTfFilterProcessAvx2;
+        TF_KERNELS.filterBankProcess = eTfFilterBankProcessAvx2;
+        TF_KERNELS.generatorRead = eTfGeneratorReadAvx2;
+    }
+
+    // the stereo filters and the oscillator bank
+    // don't get any wider than with avx2
+    if (isa >= eSIMD_ISA_AVX512)
+    {
+        TF_KERNELS.isa = eSIMD_ISA_AVX512;
+        TF_KERNELS.signalMix = eTfSignalMixAvx512;
+        TF_KERNELS.signalToS16 = eTfSignalToS16Avx512;
+    }
+#endif
+
+    eTfFxKernelsInit(TF_KERNELS, isa);
+}
+
 // ------------------------------------------------------------------------------------
 // SYNTH
 // ------------------------------------------------------------------------------------
@@ -1718,11 +4462,16 @@ void eTfSynthInit(eTfSynth &synth)
     eRandom rand;
     rand.SeedRandomly();
 
+    synth.controlTick = TF_CONTROLTICK;
+
     for (eU32 i=0; i<TF_MAXFRAMESIZE; i++)
-    {
         synth.randomBuffer[i] = eSin(rand.NextFloat(0.0f, eTWOPI));
-        synth.sinBuffer[i] = eSin(static_cast<eF32>(i) / TF_MAXFRAMESIZE * 2 * ePI);
-        synth.expBuffer[i] = eExp(-(5.0f / TF_MAXFRAMESIZE * i));
+
+    for (eU32 i=0; i<TF_MAX_HARMONICS+4; i++)
+    {
+        synth.harmonicIndex[i] = static_cast<eF32>(i+1);
+        synth.harmonicInv[i] = 1.0f / static_cast<eF32>(i+1);
+        synth.harmonicLog[i] = eLogE(static_cast<eF32>(i+1));
     }
 
     // make frequency (Hz) table
@@ -1753,9 +4502,67 @@ void eTfSynthInit(eTfSynth &synth)
         synth.whiteNoiseTable[i] = (2.f * ((random * c2) + (random * c2) + (random * c2)) - 3.f * (c2 - 1.f)) * c3;
     }
 
+    eTfFftPlanInit(synth.ifftPlan, TF_IFFT_FRAMESIZE);
+    eTfFftPlanInit(synth.mipPlans[0], TF_IFFT_FRAMESIZE/2);
+    eTfFftPlanInit(synth.mipPlans[1], TF_IFFT_FRAMESIZE/4);
+    eTfFftPlanInit(synth.mipPlans[2], TF_IFFT_FRAMESIZE/8);
+    eTfWavetableCacheInit(synth.wavetableCache);
+    eTfKernelsInit(eSimdGetIsa());
+
+    synth.spectrumBatch.count = 0;
+    synth.spectrumBatch.locked = eFALSE;
+    synth.spectrumMinInterval = TF_SPECTRUM_MININTERVAL;
+    synth.spectrumMaxInterval = TF_SPECTRUM_MAXINTERVAL;
+    synth.spectrumThreshold = TF_SPECTRUM_THRESHOLD;
+    synth.filterTable.sampleRate = 0;
+    synth.filterTable.serial = 0;
+
+#ifdef eTF_ASYNC_SPECTRUM
+    synth.spectrumWorker = nullptr;
+#endif
+
     for(eU32 j=0; j<TF_MAX_INSTR; j++)
         synth.instr[j] = nullptr;
 
 }
 
+#ifdef eTF_ASYNC_SPECTRUM
+
+void eTfSynthStartSpectrumWorker(eTfSynth &synth)
+{
+    if (synth.spectrumWorker)
+        return;
+
+    eTfSpectrumWorker *worker = new eTfSpectrumWorker;
+    worker->synth = &synth;
+    worker->running = eTRUE;
+    worker->head = 0;
+    worker->tail = 0;
+    worker->fxHead = 0;
+    worker->fxTail = 0;
+    worker->batch.count = 0;
+    worker->batch.locked = eFALSE;
+
+    synth.spectrumWorker = worker;
+    worker->thread = std::thread(eTfSpectrumWorkerRun, worker);
+}
+
+// must not be called while instruments are processed
+void eTfSynthStopSpectrumWorker(eTfSynth &synth)
+{
+    eTfSpectrumWorker *worker = synth.spectrumWorker;
+
+    if (!worker)
+        return;
+
+    worker->running = eFALSE;
+    worker->wake.notify_one();
+    worker->thread.join();
+
+    synth.spectrumWorker = nullptr;
+    eDelete(worker);
+}
+
+#endif
+
 #endif
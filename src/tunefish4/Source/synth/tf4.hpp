@@ -22,11 +22,21 @@
 #ifndef TF4_HPP
 #define TF4_HPP
 
-const eU32 TF_BUFFERSIZE            = 256;
 const eF32 TF_MASTER_VOLUME			= 2.0f;
 const eU32 TF_FRAMESIZE             = 512;
 const eU32 TF_MAXFRAMESIZE          = 4096;
+const eU32 TF_CONTROLTICK           = 64;       // samples between control updates
+const eU32 TF_MAXCONTROLTICK        = 512;
+const eU32 TF_RATEBLOCK             = 256;      // block size the glide, modulation and flanger speeds are tuned at
 const eU32 TF_IFFT_FRAMESIZE        = 512;
+const eU32 TF_FFT_MAXSIZE           = 2048;
+const eU32 TF_WAVETABLE_CACHESIZE   = 64;
+const eU32 TF_SPECTRUM_MININTERVAL  = 512;     // samples
+const eU32 TF_SPECTRUM_MAXINTERVAL  = 4096;
+const eF32 TF_SPECTRUM_THRESHOLD    = 0.01f;
+const eU32 TF_SPECTRUM_BATCH        = 4;        // wavetables rendered at once, one per simd lane
+const eU32 TF_WAVETABLE_MIPLEVELS   = 9;
+const eU32 TF_WAVETABLE_MIPSIZE     = 1728;
 const eU32 TF_NOISETABLESIZE        = 65536;
 const eU32 TF_NUMFREQS              = 128;
 const eU32 TF_LFONOISETABLESIZE     = 256;
@@ -35,10 +45,15 @@ const eU32 TF_MAX_MODULATIONS       = 4;
 const eF32 TF_MM_MODRANGE           = 10.0f;
 const eU32 TF_MAX_HARMONICS         = 64;
 const eU32 TF_MAXVOICES             = 16;
+const eU32 TF_VOICELANES            = 2*TF_MAXVOICES;   // left and right channel of every voice
+const eU32 TF_FILTERBANK_LANES      = TF_VOICELANES+8;  // plus unused lanes to fill up simd groups
+const eU32 TF_FILTERTABLE_CUTOFFS   = 512;  // grid steps of the filter coefficient table
+const eU32 TF_FILTERTABLE_QS        = 32;
 const eU32 TF_MAX_INSTR             = 32;
 const eU32 TF_MAXEFFECTS            = 10;
 const eU32 TF_MAXOCTAVES            = 9;
 const eU32 TF_MAXUNISONO            = 10;
+const eU32 TF_UNISONO_LANES         = 24;   // L/R oscillators of all unison voices, rounded up to 8 lanes
 const eU32 TF_MAXPITCHBEND          = 24;
 const eU32 TF_NUMGENPROFILES        = 4;
 const eU32 TF_LFOSHAPECOUNT         = 5;
@@ -50,6 +65,13 @@ const eU32 TF_MAX_STEPSEQUENCE_LEN  = 64;
 
 #include "tf4fx.hpp"
 
+// wavetables can be rebuilt on a worker thread, the player
+// always builds them synchronously to stay small
+#ifndef ePLAYER
+#define eTF_ASYNC_SPECTRUM
+#include <atomic>
+#endif
+
 static const eF32 TF_OCTAVES[] =
 {
     1.0f*16.0f,
@@ -63,10 +85,17 @@ static const eF32 TF_OCTAVES[] =
     1.0f/16.0f,
 };
 
-enum eTfFftType
+// octave spaced mip levels of a generator wavetable. level n only
+// contains the harmonics up to (TF_IFFT_FRAMESIZE/2)>>n, levels above
+// the first one are stored 4x oversampled.
+static const eU32 TF_WAVETABLE_MIPLENGTH[TF_WAVETABLE_MIPLEVELS] =
 {
-    IFFT = 1,
-    FFT = -1
+    512, 512, 256, 128, 64, 64, 64, 64, 64
+};
+
+static const eU32 TF_WAVETABLE_MIPOFFSET[TF_WAVETABLE_MIPLEVELS] =
+{
+    0, 512, 1024, 1280, 1408, 1472, 1536, 1600, 1664
 };
 
 enum eTfParam
@@ -370,6 +399,106 @@ struct eTfEnvelope
     Phase           phase;
 };
 
+// precomputed tables for a real-valued inverse FFT of a
+// fixed size. the transform runs as a complex FFT of half
+// the size on split re/im buffers, so all tables are N/2.
+struct eTfFftPlan
+{
+    eU32            size;
+    eU32            bitReverse[TF_FFT_MAXSIZE/2];
+    eF32            postRe[TF_FFT_MAXSIZE/2];
+    eF32            postIm[TF_FFT_MAXSIZE/2];
+    eF32            twiddleRe[TF_FFT_MAXSIZE];
+    eF32            twiddleIm[TF_FFT_MAXSIZE];
+};
+
+// wavetables of voices without spectral randomization only
+// depend on these values, so they're shared between all the
+// voices (and instruments) of a synth in one cache.
+struct eTfWavetableKey
+{
+    eU32            numHarmonics;
+    eF32            damp;
+    eF32            scale;
+    eF32            bandwidth;
+    eBool           modulated;
+};
+
+struct eTfWavetableCacheEntry
+{
+    eTfWavetableKey key;
+    eU32            hash;
+    eU32            lastUse;
+#ifdef eTF_ASYNC_SPECTRUM
+    std::atomic<eU32> refCount;     // released by the audio thread without locking
+#else
+    eU32            refCount;
+#endif
+    eBool           valid;
+    eF32            resultTable[TF_WAVETABLE_MIPSIZE];
+};
+
+struct eTfWavetableCache
+{
+    eTfWavetableCacheEntry entries[TF_WAVETABLE_CACHESIZE];
+    eU32            time;
+    eU32            hits;
+    eU32            misses;
+};
+
+// wavetables waiting to be rendered together, so the inverse
+// FFTs of all of them run at once with one per simd lane.
+struct eTfSpectrumBatch
+{
+    eU32            count;
+    eBool           locked;     // wavetable cache is held until they're rendered
+    eF32 *          targets[TF_SPECTRUM_BATCH];
+    eF32            spectra[TF_SPECTRUM_BATCH][TF_IFFT_FRAMESIZE*2];
+    eF32            lanes[TF_IFFT_FRAMESIZE*2*TF_SPECTRUM_BATCH];       // spectra lane interleaved
+    eF32            levelLanes[TF_IFFT_FRAMESIZE*2*TF_SPECTRUM_BATCH];  // same for one mip level
+};
+
+#ifdef eTF_ASYNC_SPECTRUM
+
+struct eTfSpectrumWorker;
+
+enum eTfSpectrumJobState
+{
+    TF_SPECTRUM_IDLE,
+    TF_SPECTRUM_QUEUED,     // owned by the worker
+    TF_SPECTRUM_READY,      // result waits to be picked up by the audio thread
+};
+
+// wavetable rebuild handed to the spectrum worker. the inputs
+// are a snapshot, the worker never touches the instrument.
+struct eTfSpectrumJob
+{
+    std::atomic<eU32> state;
+    eU32            serial;
+    eTfWavetableKey key;
+    eF32            modulation;
+    eF32            random;
+    eF32 *          target;
+    const eF32 *    result;
+    eTfWavetableCacheEntry * entry;
+};
+
+// effect slot change handed to the spectrum worker. it creates
+// and clears the new effect and frees the one the slot had, so
+// the audio thread never allocates or touches megabytes of delay
+// lines. the slot stays empty until the new effect is picked up.
+struct eTfEffectJob
+{
+    std::atomic<eU32> state;        // same states as the spectrum jobs
+    eU32            fxIndex;        // effect to create, 0 is none
+    eU32            sampleRate;     // delay lines are sized for it
+    eTfEffect *     created;
+    eU32            retiredIndex;
+    eTfEffect *     retired;
+};
+
+#endif
+
 struct eTfGenerator
 {
     enum ModulationType
@@ -382,21 +511,49 @@ struct eTfGenerator
     };
 
     eF32            modulation;
-    eF32            phase[2*TF_MAXUNISONO];
+    eU32            phase[TF_UNISONO_LANES]; // fixed point, L/R oscillators interleaved
     eF32            freq1;
     eF32            freq2;
     eF32            freqTable[TF_IFFT_FRAMESIZE*2];
-    eF32            freqModTable[TF_IFFT_FRAMESIZE*2];
-    eF32            resultTable[TF_IFFT_FRAMESIZE*2];
+    eF32            resultTable[TF_WAVETABLE_MIPSIZE];
+    eF32            backTable[TF_WAVETABLE_MIPSIZE];    // rebuilds go to the table not played right now
+    const eF32 *    waveTable;
+    eTfWavetableCacheEntry * cacheEntry;
+    const eF32 *    prevTable;  // faded out during the tick after a rebuild
+    eTfWavetableCacheEntry * prevEntry;
+    eBool           fading;     // prevTable's fade has started
+    eBool           freqTableDirty;
     eU32            writeOffset;
     eU32            minReadOffset;
     eU32            availableData;
 
-    eU32            activeGenSize;
     eU32            activeNumHarmonics;
     eF32            activeScale;
     eF32            activeDamp;
     eF32            activeBandwidth;
+
+
+    eTfWavetableKey builtKey;       // inputs of the last rebuild
+    eF32            builtModulation;
+    eU32            spectrumAge;    // samples since the last rebuild
+
+    // oscillator bank of the control tick in progress, set up at its
+    // start by eTfGeneratorProcess() and rendered by eTfGeneratorRender()
+    eU32            tickIncs[TF_UNISONO_LANES];
+    eF32            tickLanesOn[TF_UNISONO_LANES];
+    eU32            tickLanes;
+    eU32            tickLevel;      // mip level
+    eF32            tickDrive;
+    eBool           tickActive;     // loud enough to be rendered at all
+    eF32            tickVolL, tickVolR;     // volume ramp of waveTable over the tick
+    eF32            tickStepL, tickStepR;
+    eF32            fadeVolL, fadeVolR;     // and of prevTable
+    eF32            fadeStepL, fadeStepR;
+
+#ifdef eTF_ASYNC_SPECTRUM
+    eU32            serial;     // bumped on note on, results of older jobs are dropped
+    eTfSpectrumJob  job;
+#endif
 };
 
 struct eTfModMatrix
@@ -479,6 +636,13 @@ struct eTfModMatrix
         OUTPUT_COUNT
     };
 
+    // nothing routed until the first eTfModMatrixProcess()
+    eTfModMatrix()
+    {
+        for (eU32 i=0; i<OUTPUT_COUNT; i++)
+            outputs[i] = 1.0f;
+    }
+
     struct Entry
     {
         Input       src;
@@ -493,6 +657,92 @@ struct eTfModMatrix
     eF32            values[INPUT_COUNT];
     Entry           entries[TF_MODMATRIXENTRIES];
     eF32            modulation[TF_MODMATRIXENTRIES];
+    eF32            outputs[OUTPUT_COUNT];  // product of all entries per output, set by eTfModMatrixProcess()
+};
+
+// routing of the mod matrix decoded from the TF_MM* parameters,
+// recompiled by eTfModMatrixCompile() when any of them changes
+struct eTfModMatrixPlan
+{
+    eBool                   compiled;
+    eF32                    params[TF_MODMATRIXENTRIES*3];  // parameters the plan was compiled from
+    eTfModMatrix::Input     src[TF_MODMATRIXENTRIES];
+    eTfModMatrix::Output    dst[TF_MODMATRIXENTRIES];
+    eF32                    mod[TF_MODMATRIXENTRIES];
+    eU8                     entries[eTfModMatrix::OUTPUT_COUNT][TF_MODMATRIXENTRIES];   // contributing entries per output
+    eU8                     entryCount[eTfModMatrix::OUTPUT_COUNT];
+    eU8                     routed[TF_MODMATRIXENTRIES];    // outputs with at least one entry
+    eU32                    routedCount;
+};
+
+// discrete parameters decoded from the float parameters. the decoded
+// values are refreshed when the instrument's paramVersion is bumped,
+// the process functions read them instead of converting every block
+struct eTfInstrumentParams
+{
+    eU32            version;    // paramVersion the values were decoded from
+    eU32            unisono;    // 1..TF_MAXUNISONO
+    eU32            octave;     // index into TF_OCTAVES
+    eU32            lfoShape[2];
+    eBool           lfoSync[2];
+    eU32            polyphony;  // 1..TF_MAXVOICES
+    eU32            pitchWheelUp;   // semitones
+    eU32            pitchWheelDown;
+    eU32            filterStages;   // eTfFilter::STAGE_* of the enabled filters
+    eU32            effect[TF_MAXEFFECTS];  // effect type per slot, 0 is none
+};
+
+struct eTfFilterCoeffs
+{
+    // lowpass coefficients
+    eF32            k, p, r;
+    // highpass coefficients
+    eF32            a1, a2;
+    eF32            b0, b1, b2;
+    // inputs the coefficients were computed from
+    eF32            f, q;
+    eU32            serial;
+};
+
+// control values which only depend on the instrument's parameters and
+// the sample rate. they are computed once for all voices by
+// eTfInstrumentProcess(), voices compute a value themselves only when
+// the mod matrix routes something to it. rates are per sample and get
+// scaled by the length of the control tick where they are used
+struct eTfInstrumentControl
+{
+    eU32            version;    // paramVersion and sample rate
+    eU32            sampleRate; // the values were computed for
+    eF32            envScale;
+    eF32            envAttack[2];
+    eF32            envDecay[2];    // without decay modulation
+    eF32            envSustain[2];
+    eF32            envRelease[2];
+    eF32            lfoFreq[2];
+    eF32            genFreq;
+    eF32            genDetune;
+    eF32            genSpread;
+    eF32            slop;
+    eF32            glide;          // share of the distance to the note frequency kept per TF_RATEBLOCK
+    eF32            modulationStep; // spectrum modulation per sample
+    eU32            filterShared;   // eTfFilter::STAGE_* of filters without modulation
+    eTfFilterCoeffs filter[4];      // their coefficients, indexed by eTfFilter::Type
+    eTfFilterCoeffs noiseLP;
+    eTfFilterCoeffs noiseHP;
+};
+
+// the parts of the filter coefficients which need transcendental functions,
+// sampled over cutoff at the synth's sample rate and interpolated by
+// eTfFilterUpdate(). only the biquads' bandwidth term doesn't factor
+// into a function of the cutoff alone and is sampled over resonance too
+struct eTfFilterTable
+{
+    eU32            sampleRate;
+    eU32            serial;     // bumped on every rebuild
+    eF32            lp[TF_FILTERTABLE_CUTOFFS+1][3];    // k, p, resonance scale
+    eF32            nt[TF_FILTERTABLE_CUTOFFS+1];       // cos(w)
+    eF32            bq[TF_FILTERTABLE_CUTOFFS+1][2];    // cos(w0), sin(w0)
+    eF32            alpha[TF_FILTERTABLE_QS+1][TF_FILTERTABLE_CUTOFFS+1];
 };
 
 struct eTfFilter
@@ -505,6 +755,15 @@ struct eTfFilter
         FILTER_NT
     };
 
+    // bits of the stages a filter cascade runs
+    enum Stage
+    {
+        STAGE_LP = 1 << FILTER_LP,
+        STAGE_HP = 1 << FILTER_HP,
+        STAGE_BP = 1 << FILTER_BP,
+        STAGE_NT = 1 << FILTER_NT
+    };
+
     // lowpass memory
     eF32x2            oldx;
     eF32x2            oldy1, y1;
@@ -514,13 +773,84 @@ struct eTfFilter
     // highpass memory
     eF32x2            in0, in1, in2;
     eF32x2            out1, out2;
+    eTfFilterCoeffs   coeffs;
+};
+
+// filter memory and coefficients of all voices as structure of arrays,
+// indexed by voice channel (voice*2 + channel), so the same filter of
+// several voices advances together in the lanes of one simd register
+struct eTfFilterBank
+{
+    // lowpass memory
+    eF32            oldx[TF_FILTERBANK_LANES];
+    eF32            y1[TF_FILTERBANK_LANES];
+    eF32            y2[TF_FILTERBANK_LANES];
+    eF32            y3[TF_FILTERBANK_LANES];
+    eF32            y4[TF_FILTERBANK_LANES];
+    // highpass memory
+    eF32            in0[TF_FILTERBANK_LANES];
+    eF32            in1[TF_FILTERBANK_LANES];
+    eF32            in2[TF_FILTERBANK_LANES];
+    eF32            out1[TF_FILTERBANK_LANES];
+    eF32            out2[TF_FILTERBANK_LANES];
     // lowpass coefficients
-    eF32            k, p, r;
+    eF32            k[TF_FILTERBANK_LANES];
+    eF32            p[TF_FILTERBANK_LANES];
+    eF32            r[TF_FILTERBANK_LANES];
     // highpass coefficients
-    eF32            a0, a1, a2;
-    eF32            b0, b1, b2;
+    eF32            a1[TF_FILTERBANK_LANES];
+    eF32            a2[TF_FILTERBANK_LANES];
+    eF32            b0[TF_FILTERBANK_LANES];
+    eF32            b1[TF_FILTERBANK_LANES];
+    eF32            b2[TF_FILTERBANK_LANES];
+    // coefficient change per four samples, the coefficients
+    // above are reached at the end of the control tick
+    eF32            dk[TF_FILTERBANK_LANES];
+    eF32            dp[TF_FILTERBANK_LANES];
+    eF32            dr[TF_FILTERBANK_LANES];
+    eF32            da1[TF_FILTERBANK_LANES];
+    eF32            da2[TF_FILTERBANK_LANES];
+    eF32            db0[TF_FILTERBANK_LANES];
+    eF32            db1[TF_FILTERBANK_LANES];
+    eF32            db2[TF_FILTERBANK_LANES];
+    // inputs of the coefficients per voice
+    eF32            f[TF_MAXVOICES];
+    eF32            q[TF_MAXVOICES];
+    eU32            serial[TF_MAXVOICES];
 };
 
+// one block of the unison oscillator bank, set
+// up by eTfGeneratorProcess for eTfGeneratorRead
+struct eTfGeneratorBank
+{
+    eU32 *          phase;
+    const eU32 *    incs;
+    const eF32 *    lanesOn;
+    eU32            lanes;      // active oscillators
+    const eF32 *    table;      // mip level to read from
+    eU32            tableBits;  // log2 of its length
+    eF32            drive;
+    eF32            volL, volR;         // at the start of the tick
+    eF32            volStepL, volStepR;
+    eU32            offset;             // samples of the tick rendered before
+};
+
+// hot loops with one implementation per instruction set,
+// selected by eTfKernelsInit() from what the cpu supports
+struct eTfKernels
+{
+    eSimdIsa        isa;
+    eF32            (*signalMix)(eF32 **master, eF32 **in, eU32 length, eF32 gain);
+    void            (*signalToS16)(eF32 **sig, eS16 *out, const eF32 gain, eU32 length);
+    void            (*filterProcess)(eTfFilter *const *filters, eU32 stages, eF32 **signal, eU32 frameSize);
+    void            (*filterBankProcess)(eTfFilterBank *banks, eU32 stages, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize);
+    void            (*generatorRead)(const eTfGeneratorBank &bank, eF32 **signal, eU32 frameSize);
+    void            (*combBankProcess)(eTfComb *combs, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 *wet, eU32 len);
+    void            (*allpassProcess)(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len);
+};
+
+extern eTfKernels TF_KERNELS;
+
 struct eTfNoise
 {
     eTfNoise()
@@ -548,36 +878,6 @@ struct eTfNoise
 
 struct eTfVoice
 {
-    eTfVoice(eBool allocFilters = eTRUE)
-    {
-        if (allocFilters) 
-        {
-            filterLP = (eTfFilter*)eAllocAligned(sizeof(eTfFilter), 16);
-            filterHP = (eTfFilter*)eAllocAligned(sizeof(eTfFilter), 16);
-            filterBP = (eTfFilter*)eAllocAligned(sizeof(eTfFilter), 16);
-            filterNT = (eTfFilter*)eAllocAligned(sizeof(eTfFilter), 16);
-            eMemSet(filterLP, 0, sizeof(eTfFilter));
-            eMemSet(filterHP, 0, sizeof(eTfFilter));
-            eMemSet(filterBP, 0, sizeof(eTfFilter));
-            eMemSet(filterNT, 0, sizeof(eTfFilter));
-        } 
-        else
-        {
-            filterLP = nullptr;
-            filterHP = nullptr;
-            filterBP = nullptr;
-            filterNT = nullptr;
-        }
-    }
-
-    ~eTfVoice()
-    {
-        eFreeAligned(filterLP);
-        eFreeAligned(filterHP);
-        eFreeAligned(filterBP);
-        eFreeAligned(filterNT);
-    }
-
     eBool           noteIsOn;
     eBool           playing;
     eU32            time;
@@ -593,15 +893,36 @@ struct eTfVoice
 	eF32			lastVolL;
 	eF32			lastVolR;
 
+    eU32            controlAhead;   // samples the control state is ahead of the audio
+    eF32            tickLevel;      // summed magnitude of the tick rendered so far
+
     eTfModMatrix    modMatrix;
     eTfNoise        noiseGen;
-    eTfFilter *     filterLP;
-    eTfFilter *     filterHP;
-    eTfFilter *     filterBP;
-    eTfFilter *     filterNT;
     eTfGenerator    generator;
 };
 
+// timestamped input to eTfInstrumentProcess(). the offset counts samples
+// from the start of the block, lists are sorted by it
+struct eTfInstrumentEvent
+{
+    enum Type
+    {
+        NOTE_ON,
+        NOTE_OFF,
+        ALL_NOTES_OFF,
+        PITCH_BEND,
+        MOD_WHEEL,
+        PARAM
+    };
+
+    eU32            offset;
+    Type            type;
+    eS32            index;      // note or parameter
+    eS32            velocity;
+    eF32            value;      // parameter, mod wheel or bend semitones
+    eF32            value2;     // bend cents
+};
+
 struct eTfInstrument
 {
     eF32            params[TF_PARAM_COUNT];
@@ -611,9 +932,25 @@ struct eTfInstrument
     eF32            modWheel;
     eTfVoice        voice[TF_MAXVOICES];
     eTfVoice *      latestTriggeredVoice;
-    eF32            tempBuffers[2][TF_MAXFRAMESIZE];
+    eTfFilterBank   filterBank[4];  // voice filters, indexed by eTfFilter::Type
+    eTfModMatrixPlan modPlan;
+    eU32            paramVersion;   // bumped by eTfInstrumentParamsChanged()
+    eTfInstrumentParams decoded;
+    eTfInstrumentControl control;
+    eU32            tickPos;    // start of the control tick in progress on the grid
+    eU32            tickLen;    // its length, 0 between two ticks
+    eU32            tickDone;   // samples of it rendered so far
+    eU32            tickVoices[TF_MAXVOICES];   // voices it renders
+    eU32            tickVoiceCount;
+    eU32            tickStages; // filter stages it was set up for
+    eBool           tickEffects;
+    eBool           tickSilent;
     eTfEffect *     effects[TF_MAXEFFECTS];
     eU32            effectIndex[TF_MAXEFFECTS];
+    eU32            effectRate[TF_MAXEFFECTS];  // sample rate the effects were created at
+#ifdef eTF_ASYNC_SPECTRUM
+    eTfEffectJob    effectJobs[TF_MAXEFFECTS];
+#endif
     eF32            effectsInactiveTime;
 };
 
@@ -634,18 +971,38 @@ struct eTfStepSequencer
 struct eTfSynth
 {
     eU32            sampleRate;
+    eU32            controlTick;    // multiple of 4 up to TF_MAXCONTROLTICK
     eF32            randomBuffer[TF_MAXFRAMESIZE];
-    eF32            sinBuffer[TF_MAXFRAMESIZE];
-    eF32            expBuffer[TF_MAXFRAMESIZE];
+    eF32            harmonicIndex[TF_MAX_HARMONICS+4];  // n, padded for simd
+    eF32            harmonicInv[TF_MAX_HARMONICS+4];    // 1/n
+    eF32            harmonicLog[TF_MAX_HARMONICS+4];    // ln(n)
     eF32            freqTable[TF_NUMFREQS];
     eF32            lfoNoiseTable[TF_LFONOISETABLESIZE];
     eF32            whiteNoiseTable[TF_NOISETABLESIZE];
+    eTfFftPlan      ifftPlan;
+    eTfFftPlan      mipPlans[3];    // 256, 128 and 64 points
+    eTfFilterTable  filterTable;
+    eTfWavetableCache wavetableCache;
+    eTfSpectrumBatch spectrumBatch;
+    eU32            spectrumMinInterval;    // voices get a rebuild slot every that many samples
+    eU32            spectrumMaxInterval;    // slightly changed spectra are rebuilt after that many samples
+    eF32            spectrumThreshold;      // changes above are rebuilt in the next slot
+#ifdef eTF_ASYNC_SPECTRUM
+    eTfSpectrumWorker * spectrumWorker; // nullptr builds wavetables on the audio thread
+#endif
+    eF32            voiceBuffers[TF_VOICELANES][TF_MAXFRAMESIZE];   // voice signals while an instrument is processed
     eTfInstrument * instr[TF_MAX_INSTR];
     eTfStepSequencer stepSequencer;
 };
 
 struct eTfEvent
 {
+	eTfEvent()
+	{
+		time = 0.0f;
+		instr = note = velocity = 0;
+	}
+
 	eTfEvent(eF32 time, eU8	instr, eU8 note, eU8 velocity)
 	{
 		this->time = time;
@@ -667,6 +1024,8 @@ struct eTfSong
 	eU32				tempo;
 };
 
+void    eTfKernelsInit(eSimdIsa isa);
+
 void	eTfSignalMix16(eS16 *master, eS16 *in, eU32 length);
 eBool   eTfSignalMix(eF32 **master, eF32 **in, eU32 length, eF32 volume);
 void    eTfSignalToS16(eF32 **sig, eS16 *out, const eF32 gain, eU32 length);
@@ -676,7 +1035,7 @@ void    eTfEnvelopeReset(eTfEnvelope &state);
 eBool   eTfEnvelopeIsEnd(eTfEnvelope &state);
 void    eTfEnvelopeNoteOn(eTfEnvelope &state);
 void    eTfEnvelopeNoteOff(eTfEnvelope &state);
-eF32    eTfEnvelopeProcess(eTfSynth &synth, eTfInstrument &instr, eTfEnvelope &envState, eF32 decayMod, eU32 paramOffset, eU32 frameSize);
+eF32    eTfEnvelopeProcess(eTfInstrument &instr, eTfEnvelope &envState, eF32 decayMod, eU32 paramOffset, eU32 frameSize);
 
 void    eTfLfoReset(eTfLfo &state, eF32 phase);
 eF32    eTfLfoProcess(eTfSynth &synth, eTfInstrument &instr, eTfLfo &lfoState, eF32 depthMod, eU32 paramOffset, eU32 frameSize, eF32 *depthOut = nullptr);
@@ -687,21 +1046,44 @@ void    eTfModMatrixNoteOff(eTfModMatrix &state);
 void    eTfModMatrixPanic(eTfModMatrix &state);
 eBool   eTfModMatrixIsActive(eTfModMatrix &state);
 eBool   eTfModMatrixProcess(eTfSynth &synth, eTfInstrument &instr, eTfModMatrix &state, eU32 frameSize);
+void    eTfModMatrixCompile(eTfInstrument &instr);
 eF32    eTfModMatrixGet(eTfModMatrix &state, eTfModMatrix::Output output, eTfModMatrix::Range range = eTfModMatrix::MMR_ONE_TO_ZERO);
 
 void    eTfGeneratorReset(eTfGenerator &state);
-void    eTfGeneratorFft(eTfFftType type, eU32 frameSize, eF32 *buffer);
-void    eTfGeneratorNormalize(eF32 *buffer, eU32 frameSize);
-void    eTfGeneratorUpdate(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 frequencyRange);
-eBool   eTfGeneratorModulate(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator);
-eBool   eTfGeneratorProcess(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 velocity, eF32 **signal, eU32 frameSize);
+void    eTfFftPlanInit(eTfFftPlan &plan, eU32 size);
+eF32    eTfGeneratorIfft(const eTfFftPlan &plan, const eF32 *spectrum, eF32 *result, eF32 gain);
+void    eTfGeneratorIfftBatch(const eTfFftPlan &plan, const eF32 *spectra, eF32 **results, eF32 *gains);
+void    eTfGeneratorBuildMips(eTfSynth &synth, const eF32 *spectrum, eF32 *mips);
+void    eTfSpectrumBatchRender(eTfSynth &synth, eTfSpectrumBatch &batch);
+void    eTfGeneratorUpdate(eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator);
+const eF32 * eTfGeneratorSpectrum(eTfSynth &synth, eTfGenerator &generator);
+eBool   eTfGeneratorModulate(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator, const eF32 *spectrum, eF32 *modTable);
+void    eTfGeneratorRefresh(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator, eBool crossfade);
+void    eTfGeneratorFlush(eTfSynth &synth);
+void    eTfGeneratorRelease(eTfGenerator &generator);
+#ifdef eTF_ASYNC_SPECTRUM
+eBool   eTfGeneratorQueue(eTfSynth &synth, eTfInstrument &instr, eTfGenerator &generator);
+void    eTfGeneratorCollect(eTfGenerator &generator);
+#endif
+
+void    eTfWavetableCacheInit(eTfWavetableCache &cache);
+eTfWavetableCacheEntry * eTfWavetableCacheAcquire(eTfWavetableCache &cache, const eTfWavetableKey &key, eBool &found);
+void    eTfWavetableCacheRelease(eTfWavetableCacheEntry *&entry);
+void    eTfGeneratorRead(const eTfGeneratorBank &bank, eF32 **signal, eU32 frameSize);
+eBool   eTfGeneratorProcess(eTfSynth &synth, eTfInstrument &instr, eTfVoice &voice, eTfGenerator &generator, eF32 velocity, eU32 frameSize);
+void    eTfGeneratorRender(eTfGenerator &generator, eF32 **signal, eU32 offset, eU32 frameSize);
+void    eTfGeneratorTickEnd(eTfVoice &voice, eTfGenerator &generator, eU32 done, eU32 frameSize);
 
 void    eTfNoiseReset(eTfNoise &state);
-void    eTfNoiseUpdate(eTfSynth &synth, eTfInstrument &instr, eTfNoise &state, eTfModMatrix &modMatrix, eF32 velocity);
+void    eTfNoiseUpdate(eTfInstrument &instr, eTfNoise &state, eTfModMatrix &modMatrix, eF32 velocity);
 eBool   eTfNoiseProcess(eTfSynth &synth, eTfNoise &state, eF32 **signal, eU32 frameSize);
 
-void    eTfFilterUpdate(eTfSynth &synth, eTfFilter &state, eF32 f, eF32 q, eTfFilter::Type type);
-void    eTfFilterProcess(eTfFilter &state, eTfFilter::Type type, eF32 **signal, eU32 frameSize);
+void    eTfFilterUpdate(eTfSynth &synth, eTfFilterCoeffs &coeffs, eF32 f, eF32 q, eTfFilter::Type type);
+void    eTfFilterProcess(eTfFilter *const *filters, eU32 stages, eF32 **signal, eU32 frameSize);
+void    eTfFilterBankUpdate(eTfSynth &synth, eTfFilterBank &bank, eU32 voice, eF32 f, eF32 q, eTfFilter::Type type, eU32 frameSize, eBool ramp);
+void    eTfFilterBankSet(eTfFilterBank &bank, eU32 voice, const eTfFilterCoeffs &coeffs, eTfFilter::Type type, eU32 frameSize, eBool ramp);
+void    eTfFilterBankCut(eTfFilterBank &bank, eU32 voice, eU32 done, eU32 frameSize);
+void    eTfFilterBankProcess(eTfFilterBank *banks, eU32 stages, const eU32 *lanes, eU32 laneCount, eF32 **signals, eU32 offset, eU32 frameSize, eU32 tickSize);
 
 void    eTfVoiceReset(eTfVoice &state);
 void    eTfVoiceNoteOn(eTfVoice &state, eS32 note, eS32 velocity, eF32 lfoPhase1, eF32 lfoPhase2);
@@ -710,8 +1092,11 @@ void    eTfVoicePitchBend(eTfVoice &state, eF32 semitones, eF32 cents);
 void    eTfVoicePanic(eTfVoice &state);
 
 void    eTfInstrumentInit(eTfInstrument &instr);
+void    eTfInstrumentParamsChanged(eTfInstrument &instr);
+const eTfInstrumentParams & eTfInstrumentDecode(eTfInstrument &instr);
 void    eTfInstrumentFree(eTfInstrument &instr);
-eF32    eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs, eU32 sampleFrames);
+eF32    eTfInstrumentProcess(eTfSynth &synth, eTfInstrument &instr, eF32 **outputs, eU32 sampleFrames, const eTfInstrumentEvent *events = nullptr, eU32 eventCount = 0);
+void    eTfInstrumentApplyEvent(eTfInstrument &instr, const eTfInstrumentEvent &event);
 void    eTfInstrumentNoteOn(eTfInstrument &instr, eS32 note, eS32 velocity);
 eBool   eTfInstrumentNoteOff(eTfInstrument &instr, eS32 note);
 void    eTfInstrumentAllNotesOff(eTfInstrument &instr);
@@ -740,5 +1125,9 @@ void    eTfStepSequencerStop(eTfStepSequencer &seq);
 eF32    eTfStepSequencerProcess(eTfStepSequencer &seq, eF32 **outputs, eU32 sampleFrames);
 
 void    eTfSynthInit(eTfSynth &synth);
+#ifdef eTF_ASYNC_SPECTRUM
+void    eTfSynthStartSpectrumWorker(eTfSynth &synth);
+void    eTfSynthStopSpectrumWorker(eTfSynth &synth);
+#endif
 
 #endif
@@ -33,64 +33,90 @@
 //  DELAY
 // ---------------------------------------------------------------------------------------------------------------------------
 
-void eTfDelayInit(eTfDelay &delay, eBool singleDelay)
+// buffers hold the longest delay at the given sample rate,
+// rounded up to a power of two so positions wrap with a mask
+static eU32 eTfDelayBufferSize(eU32 sampleRate, eF32 maxMs)
 {
-    eMemZero(delay);
+    eU32 maxLen = eFtoL((eF32)sampleRate * maxMs / 1000.0f) + 1;
+    eU32 size = 1;
+
+    while (size < maxLen)
+        size <<= 1;
+
+    return size;
+}
+
+void eTfDelayInit(eTfDelay &delay, eBool singleDelay, eU32 sampleRate, eF32 maxMs)
+{
+    eU32 size = eTfDelayBufferSize(sampleRate, maxMs);
+
     delay.singleDelay = singleDelay;
+    delay.delayBuffer = static_cast<eF32 *>(eAllocAligned(size*sizeof(eF32), 16));
+    eMemSet(delay.delayBuffer, 0, size*sizeof(eF32));
+    delay.mask = size-1;
+    delay.delayLen = 1;
+    delay.writeOffset = 0;
+}
+
+void eTfDelayFree(eTfDelay &delay)
+{
+    eFreeAligned(delay.delayBuffer);
+    delay.delayBuffer = nullptr;
 }
 
 void eTfDelayUpdate(eTfDelay &delay, eU32 sampleRate, eF32 ms)
 {
     delay.delayLen = eFtoL((eF32)sampleRate * ms / 1000.0f);
-    delay.delayLen = eClamp<eU32>(1, delay.delayLen, TF_DELAY_MAXLEN);
-    if (delay.singleDelay) {
-        eS32 readOffset = delay.writeOffset - delay.delayLen;
-        if (readOffset < 0) readOffset += TF_DELAY_MAXLEN;
-        delay.readOffset = (eU32)readOffset;
-    } else {
-        delay.writeOffset = eClamp<eU32>(0, delay.writeOffset, delay.delayLen-1);
-        delay.readOffset = eClamp<eU32>(0, delay.readOffset, delay.delayLen-1);
-    }
+    delay.delayLen = eClamp<eU32>(1, delay.delayLen, delay.mask);
 }
 
+// the read tap is delayLen samples behind the write tap. the block
+// is cut where either of them wraps, so the runs in between have no
+// branches. the feedback delay adds what it wrote delayLen samples
+// ago to the input, the chorus taps only store the input.
 void eTfDelayProcess(eTfDelay &delay, eF32 *signal, eU32 len, eF32 decay)
 {
-    eU32 *read_pos      = &delay.readOffset;
-    eU32 *write_pos     = &delay.writeOffset;
-    eF32 *buffer_src    = &delay.delayBuffer[*read_pos];
-    eF32 *buffer_dest   = &delay.delayBuffer[*write_pos];
-    eU32 wrapPosition   = delay.singleDelay ? TF_DELAY_MAXLEN : delay.delayLen;
-    eF32 mulDest        = delay.singleDelay ? 0.0f : 1.0f;
-
-    while (len--) {
-        // fetch one sample
-        eF32 sample = *signal;
-
-        // write it to buffer
-        *buffer_dest = (sample + (*buffer_dest * mulDest)) * decay;
-        eUndenormalise((*buffer_dest));
-        buffer_dest++;
-
-        // read from buffer and add to sample
-        sample += *buffer_src++;
-
-        // increase write position and verify
-        (*write_pos)++;
-        if ((*write_pos) >= wrapPosition) {
-            (*write_pos) = 0;
-            buffer_dest = delay.delayBuffer;
-        }
+    eF32 *buffer = delay.delayBuffer;
+    eU32 size = delay.mask + 1;
+    eU32 writePos = delay.writeOffset;
+    eU32 readPos = (writePos - delay.delayLen) & delay.mask;
+
+    while (len)
+    {
+        eU32 run = eMin(len, eMin(size - writePos, size - readPos));
+        eF32 *dst = &buffer[writePos];
+        const eF32 *src = &buffer[readPos];
 
-        // increase read position and verify
-        (*read_pos)++;
-        if ((*read_pos) >= wrapPosition) {
-            (*read_pos) = 0;
-            buffer_src = delay.delayBuffer;
+        if (delay.singleDelay)
+        {
+            for (eU32 i=0; i<run; i++)
+            {
+                eF32 sample = signal[i];
+                eF32 stored = sample * decay;
+                eUndenormalise(stored);
+                dst[i] = stored;
+                signal[i] = sample + src[i];
+            }
+        }
+        else
+        {
+            for (eU32 i=0; i<run; i++)
+            {
+                eF32 sample = signal[i];
+                eF32 stored = (sample + src[i]) * decay;
+                eUndenormalise(stored);
+                dst[i] = stored;
+                signal[i] = sample + stored;
+            }
         }
 
-        // write to output
-        *signal++ = sample;
+        signal += run;
+        len -= run;
+        writePos = (writePos + run) & delay.mask;
+        readPos = (readPos + run) & delay.mask;
     }
+
+    delay.writeOffset = writePos;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------------
@@ -99,40 +125,255 @@ void eTfDelayProcess(eTfDelay &delay, eF32 *signal, eU32 len, eF32 decay)
 
 void eTfCombInit(eTfComb &comb, eU32 size)
 {
-    eASSERT(size+3 < TF_COMB_MAXLEN);
+    // the bank reads up to eight samples past a run
+    eASSERT(size+7 < TF_COMB_MAXLEN);
     eMemZero(comb);
     comb.bufsize = size;
 }
 
-void eTfCombProcess(eTfComb &comb1, eTfComb &comb2, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 **signals_out, eU32 len)
+// all combs of the bank advance together. the delay lines are longer
+// than the vectors, so within a run that doesn't wrap any comb reads and
+// writes the same slots: the delay line contents are loaded per comb,
+// summed into the wet signal in comb order, then transposed so the
+// damping filters of four combs run side by side per sample.
+static void eTfCombBankProcessBase(eTfComb *combs, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 *wet, eU32 len)
 {
-    eF32 *inputL = signals_in[LEFT];
-    eF32 *inputR = signals_in[RIGHT];
-    eF32 *outputL = signals_out[LEFT];
-    eF32 *outputR = signals_out[RIGHT];
+    const eU32 GROUPS = TF_COMBBANK_COMBS/4;
 
-    eF32x2 damp2x2 = eSimdSetAll(damp2);
-    eF32x2 damp1x2 = eSimdSetAll(damp1);
-    eF32x2 feedbackx2 = eSimdSetAll(feedback);
+    const eF32 *inputL = signals_in[LEFT];
+    const eF32 *inputR = signals_in[RIGHT];
 
-    while(len--)
+    const eF32x4 mdamp1 = eSimdSetAll4(damp1);
+    const eF32x4 mdamp2 = eSimdSetAll4(damp2);
+    const eF32x4 mfeedback = eSimdSetAll4(feedback);
+
+    eF32x4 filterstore[GROUPS];
+    for (eU32 g=0; g<GROUPS; g++)
     {
-        eF32 input = (*inputL++ + *inputR++) * gain;
-        eF32x2 minput = eSimdSetAll(input);
+        eF32 fs[4];
+        for (eU32 k=0; k<4; k++)
+            fs[k] = combs[g*4+k].filterstore;
+        filterstore[g] = eSimdLoad(fs);
+    }
 
-        eF32x2 output = eSimdSet2(comb1.buffer[comb1.bufidx], comb2.buffer[comb2.bufidx]);
-        eF32x2 filterstore = eSimdSet2(comb1.filterstore, comb2.filterstore);
-        filterstore = eSimdAdd(eSimdMul(output, damp2x2), eSimdMul(filterstore, damp1x2));
+    eU32 i = 0;
+    while (i < len)
+    {
+        eU32 run = len - i;
+        for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+            run = eMin<eU32>(run, combs[c].bufsize - combs[c].bufidx);
 
-        eF32x2 buffer = eSimdAdd(minput, eSimdMul(filterstore, feedbackx2));
+        for (eU32 j=0; j<run; j+=4)
+        {
+            eU32 count = eMin<eU32>(run - j, 4);
+            eF32x4 rows[TF_COMBBANK_COMBS];
+            eF32 input[4];
 
-        eSimdStore2(buffer, comb1.buffer[comb1.bufidx], comb2.buffer[comb2.bufidx]);
-        eSimdStore2(filterstore, comb1.filterstore, comb2.filterstore);
-        eSimdStore2(output, *outputL++, *outputR++);
+            for (eU32 n=0; n<count; n++)
+                input[n] = (inputL[i+j+n] + inputR[i+j+n]) * gain;
+
+            eF32x4 sum = eSimdZero();
+
+            for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+            {
+                rows[c] = eSimdLoad(&combs[c].buffer[combs[c].bufidx + j]);
+                sum = eSimdAdd(rows[c], sum);
+            }
+
+            eF32 out[4];
+            eSimdStore(sum, out);
+            for (eU32 n=0; n<count; n++)
+                wet[i+j+n] = out[n];
+
+            // one vector per sample and group of four combs
+            for (eU32 g=0; g<GROUPS; g++)
+            {
+                eSimdTranspose(rows[g*4+0], rows[g*4+1], rows[g*4+2], rows[g*4+3]);
+
+                for (eU32 n=0; n<count; n++)
+                {
+                    eF32x4 &row = rows[g*4+n];
+                    filterstore[g] = eSimdAdd(eSimdMul(row, mdamp2), eSimdMul(filterstore[g], mdamp1));
+                    row = eSimdAdd(eSimdSetAll4(input[n]), eSimdMul(filterstore[g], mfeedback));
+                }
+
+                eSimdTranspose(rows[g*4+0], rows[g*4+1], rows[g*4+2], rows[g*4+3]);
+            }
+
+            for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+            {
+                eF32 *buffer = &combs[c].buffer[combs[c].bufidx + j];
+
+                if (count == 4)
+                    eSimdStore(rows[c], buffer);
+                else
+                {
+                    eF32 values[4];
+                    eSimdStore(rows[c], values);
+                    for (eU32 n=0; n<count; n++)
+                        buffer[n] = values[n];
+                }
+            }
+        }
+
+        for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+        {
+            combs[c].bufidx += run;
+            if (combs[c].bufidx >= combs[c].bufsize)
+                combs[c].bufidx = 0;
+        }
+
+        i += run;
+    }
+
+    for (eU32 g=0; g<GROUPS; g++)
+    {
+        eF32 fs[4];
+        eSimdStore(filterstore[g], fs);
+        for (eU32 k=0; k<4; k++)
+            combs[g*4+k].filterstore = fs[k];
+    }
+}
+
+#ifdef eSIMD_DISPATCH
+
+static eFORCEINLINE eSIMD_TARGET_AVX2 void eTfTranspose8Avx2(__m256 *rows)
+{
+    const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    rows[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    rows[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    rows[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    rows[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    rows[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    rows[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    rows[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    rows[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+// the same with eight samples at a time and all eight combs in one vector
+static eSIMD_TARGET_AVX2 void eTfCombBankProcessAvx2(eTfComb *combs, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 *wet, eU32 len)
+{
+    const eF32 *inputL = signals_in[LEFT];
+    const eF32 *inputR = signals_in[RIGHT];
+
+    const __m256 mdamp1 = _mm256_set1_ps(damp1);
+    const __m256 mdamp2 = _mm256_set1_ps(damp2);
+    const __m256 mfeedback = _mm256_set1_ps(feedback);
+    const __m256 mgain = _mm256_set1_ps(gain);
+
+    eF32 fs[8];
+    for (eU32 k=0; k<8; k++)
+        fs[k] = combs[k].filterstore;
+    __m256 filterstore = _mm256_loadu_ps(fs);
+
+    eU32 i = 0;
+    while (i < len)
+    {
+        eU32 run = len - i;
+        for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+            run = eMin<eU32>(run, combs[c].bufsize - combs[c].bufidx);
+
+        for (eU32 j=0; j<run; j+=8)
+        {
+            eU32 count = eMin<eU32>(run - j, 8);
+            eF32 input[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            __m256 rows[8];
+            __m256 sum = _mm256_setzero_ps();
+
+            for (eU32 n=0; n<count; n++)
+                input[n] = inputL[i+j+n] + inputR[i+j+n];
+            _mm256_storeu_ps(input, _mm256_mul_ps(_mm256_loadu_ps(input), mgain));
+
+            for (eU32 c=0; c<8; c++)
+            {
+                rows[c] = _mm256_loadu_ps(&combs[c].buffer[combs[c].bufidx + j]);
+                sum = _mm256_add_ps(rows[c], sum);
+            }
+
+            if (count == 8)
+                _mm256_storeu_ps(&wet[i+j], sum);
+            else
+            {
+                eF32 values[8];
+                _mm256_storeu_ps(values, sum);
+                for (eU32 n=0; n<count; n++)
+                    wet[i+j+n] = values[n];
+            }
+
+            eTfTranspose8Avx2(rows);
+
+            for (eU32 n=0; n<count; n++)
+            {
+                filterstore = _mm256_fmadd_ps(rows[n], mdamp2, _mm256_mul_ps(filterstore, mdamp1));
+                rows[n] = _mm256_fmadd_ps(filterstore, mfeedback, _mm256_set1_ps(input[n]));
+            }
 
-        if (++comb1.bufidx >= comb1.bufsize) comb1.bufidx = 0;
-        if (++comb2.bufidx >= comb2.bufsize) comb2.bufidx = 0;
+            eTfTranspose8Avx2(rows);
+
+            for (eU32 c=0; c<8; c++)
+            {
+                eF32 *buffer = &combs[c].buffer[combs[c].bufidx + j];
+
+                if (count == 8)
+                    _mm256_storeu_ps(buffer, rows[c]);
+                else
+                {
+                    eF32 values[8];
+                    _mm256_storeu_ps(values, rows[c]);
+                    for (eU32 n=0; n<count; n++)
+                        buffer[n] = values[n];
+                }
+            }
+        }
+
+        for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+        {
+            combs[c].bufidx += run;
+            if (combs[c].bufidx >= combs[c].bufsize)
+                combs[c].bufidx = 0;
+        }
+
+        i += run;
     }
+
+    _mm256_storeu_ps(fs, filterstore);
+    for (eU32 k=0; k<8; k++)
+        combs[k].filterstore = fs[k];
+}
+
+#endif
+
+// writes the sum of all combs' outputs to wet
+void eTfCombBankProcess(eTfComb *combs, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 *wet, eU32 len)
+{
+    TF_KERNELS.combBankProcess(combs, damp1, damp2, feedback, gain, signals_in, wet, len);
+}
+
+// the next sum the bank will write, the combs
+// output what they stored a delay line length ago
+eF32 eTfCombBankPeek(const eTfComb *combs)
+{
+    eF32 sum = 0.0f;
+
+    for (eU32 c=0; c<TF_COMBBANK_COMBS; c++)
+        sum += combs[c].buffer[combs[c].bufidx];
+
+    return sum;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------------
@@ -146,7 +387,7 @@ void eTfAllpassInit(eTfAllpass &allpass, eU32 size)
     allpass.bufsize = size;
 }
 
-void eTfAllpassProcess(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len)
+static void eTfAllpassProcessBase(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len)
 {
     eF32 *inputL = signals_in[0];
     eF32 *inputR = signals_in[1];
@@ -169,22 +410,90 @@ void eTfAllpassProcess(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback
     }
 }
 
+#ifdef eSIMD_DISPATCH
+
+// there is no recursion within a run shorter than the delay,
+// so every channel is processed eight samples at a time
+static eSIMD_TARGET_AVX2 void eTfAllpassChannelAvx2(eTfAllpass &allpass, eF32 feedback, const eF32 *input, eF32 *output, eU32 len)
+{
+    const __m256 feedbackx8 = _mm256_set1_ps(feedback);
+    eU32 i = 0;
+
+    while (i < len)
+    {
+        eU32 run = eMin<eU32>(len - i, allpass.bufsize - allpass.bufidx);
+        eF32 *buffer = &allpass.buffer[allpass.bufidx];
+        eU32 j = 0;
+
+        for (; j+8<=run; j+=8)
+        {
+            const __m256 in = _mm256_loadu_ps(&input[i+j]);
+            const __m256 bufout = _mm256_loadu_ps(&buffer[j]);
+            _mm256_storeu_ps(&buffer[j], _mm256_fmadd_ps(bufout, feedbackx8, in));
+            _mm256_storeu_ps(&output[i+j], _mm256_sub_ps(bufout, in));
+        }
+
+        for (; j<run; j++)
+        {
+            const eF32 in = input[i+j];
+            const eF32 bufout = buffer[j];
+            buffer[j] = in + bufout * feedback;
+            output[i+j] = bufout - in;
+        }
+
+        allpass.bufidx += run;
+        if (allpass.bufidx >= allpass.bufsize) allpass.bufidx = 0;
+        i += run;
+    }
+}
+
+static eSIMD_TARGET_AVX2 void eTfAllpassProcessAvx2(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len)
+{
+    eTfAllpassChannelAvx2(allpass1, feedback, signals_in[0], signals_out[0], len);
+    eTfAllpassChannelAvx2(allpass2, feedback, signals_in[1], signals_out[1], len);
+}
+
+#endif
+
+void eTfAllpassProcess(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len)
+{
+    TF_KERNELS.allpassProcess(allpass1, allpass2, feedback, signals_in, signals_out, len);
+}
+
+void eTfFxKernelsInit(eTfKernels &kernels, eSimdIsa isa)
+{
+    kernels.combBankProcess = eTfCombBankProcessBase;
+    kernels.allpassProcess = eTfAllpassProcessBase;
+
+#ifdef eSIMD_DISPATCH
+    if (isa >= eSIMD_ISA_AVX2)
+    {
+        kernels.combBankProcess = eTfCombBankProcessAvx2;
+        kernels.allpassProcess = eTfAllpassProcessAvx2;
+    }
+#endif
+}
+
 // ---------------------------------------------------------------------------------------------------------------------------
 //  EFFECT DELAY
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectDelayCreate()
+eTfEffect * eTfEffectDelayCreate(eU32 sampleRate)
 {
     eTfEffectDelay *delay = static_cast<eTfEffectDelay *>(eAllocAligned(sizeof(eTfEffectDelay), 16));
     eMemSet(delay, 0, sizeof(eTfEffectDelay));
 
-    eTfDelayInit(delay->delay[LEFT], eFALSE);
-    eTfDelayInit(delay->delay[RIGHT], eFALSE);
+    eTfDelayInit(delay->delay[LEFT], eFALSE, sampleRate, (eF32)TF_FX_DELAY_MAX_MILLISECONDS);
+    eTfDelayInit(delay->delay[RIGHT], eFALSE, sampleRate, (eF32)TF_FX_DELAY_MAX_MILLISECONDS);
     return delay;
 }
 
 void eTfEffectDelayDelete(eTfEffect *fx)
 {
+    eTfEffectDelay *delay = static_cast<eTfEffectDelay *>(fx);
+
+    eTfDelayFree(delay->delay[LEFT]);
+    eTfDelayFree(delay->delay[RIGHT]);
     eFreeAligned(fx);
 }
 
@@ -219,15 +528,14 @@ const eInt STEREOSPREAD = 23;
 const eInt COMBTUNINGS[]    = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
 const eInt ALLPASSTUNINGS[] = { 556, 441, 341, 225 };
 
-eTfEffect * eTfEffectReverbCreate()
+eTfEffect * eTfEffectReverbCreate(eU32)
 {
     eTfEffectReverb *reverb = static_cast<eTfEffectReverb *>(eAllocAligned(sizeof(eTfEffectReverb), 16));
     eMemSet(reverb, 0, sizeof(eTfEffectReverb));
 
     for (int i=0; i<TF_FX_REVERB_NUMCOMBS; i++)
     {
-        eTfCombInit(reverb->comb[LEFT][i], COMBTUNINGS[i]);
-        eTfCombInit(reverb->comb[RIGHT][i], COMBTUNINGS[i]);
+        eTfCombInit(reverb->comb[i], COMBTUNINGS[i]);
     }
 
     for (int i=0; i<TF_FX_REVERB_NUMALLPASSES; i++)
@@ -263,68 +571,249 @@ void eTfEffectReverbProcess(eTfEffect *fx, eTfSynth &, eTfInstrument &instr, eF3
     eF32 gain              = FIXEDGAIN;
     eF32 damp2             = 1.0f - damp;
 
-	//eSwap<eF32*>(signal[LEFT], signal[RIGHT]);
+    eALIGN16 eF32 wetBuffers[2][TF_FX_REVERB_CHUNK];
+    eF32 *wetSignal[2] = { wetBuffers[LEFT], wetBuffers[RIGHT] };
+
+    eF32x2 wet1x2 = eSimdSetAll(wet1);
+    eF32x2 wet2x2 = eSimdSetAll(wet2);
+    eF32x2 dry0x2 = eSimdSetAll(dry0);
+
+    for (eU32 pos=0; pos<len; pos+=TF_FX_REVERB_CHUNK)
+    {
+        eU32 count = eMin<eU32>(len - pos, TF_FX_REVERB_CHUNK);
+        eF32 *drySignal[2] = { signal[LEFT] + pos, signal[RIGHT] + pos };
+
+        eTfCombBankProcess(reverb->comb, damp1, damp2, cmbFeedback, gain, drySignal, wetSignal[LEFT], count);
 
-	if (len > TF_MAXFRAMESIZE)
-		return;
+        // the right channel hears the combs one sample early. the last
+        // sample is peeked from the combs, so it doesn't depend on where
+        // the block ends.
+        for (eU32 i=0; i+1<count; i++)
+            wetSignal[RIGHT][i] = wetSignal[LEFT][i+1];
+
+        wetSignal[RIGHT][count-1] = eTfCombBankPeek(reverb->comb);
+
+        // run allpass filters in serial
+        for (eU32 i=0;i<TF_FX_REVERB_NUMALLPASSES; i++)
+        {
+            eTfAllpassProcess(reverb->allpass[LEFT][i], reverb->allpass[RIGHT][i], apsFeedback, wetSignal, wetSignal, count);
+        }
 
-    // erase mixbuffer
-    eF32 *signals_mix[2];
-    signals_mix[LEFT] = &reverb->mixBuffers[0];
-    signals_mix[RIGHT] = &reverb->mixBuffers[TF_MAXFRAMESIZE];
-    eMemSet(signals_mix[LEFT], 0, sizeof(eF32)*len);
-    eMemSet(signals_mix[RIGHT], 0, sizeof(eF32)*len);
+        // create final signal
+        eF32 *dryL = drySignal[LEFT];
+        eF32 *dryR = drySignal[RIGHT];
+        eF32 *wetL = wetSignal[LEFT];
+        eF32 *wetR = wetSignal[RIGHT];
 
-    // run comb filters in parallel
-    for (eU32 i=0;i<TF_FX_REVERB_NUMCOMBS; i++)
+        for (eU32 i=0; i<count; i++)
+        {
+            eF32x2 in = eSimdSet2(*dryL, *dryR);
+            eF32x2 lwet1 = eSimdSet2(*wetL, *wetR);
+            eF32x2 lwet2 = eSimdSet2(*wetR++, *wetL++);
+
+            eF32x2 out = eSimdAdd(
+                    eSimdAdd(
+                        eSimdMul(lwet1, wet1x2),
+                        eSimdMul(lwet2, wet2x2)),
+                    eSimdMul(in, dry0x2));
+
+            eSimdStore2(out, *dryL++, *dryR++);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------------
+//  EFFECT FDN REVERB
+// ---------------------------------------------------------------------------------------------------------------------------
+
+const eInt FDNLENGTHS[]     = { 1087, 1283, 1433, 1571, 1697, 1811, 1949, 2083 };
+const eF32 FDNREFLENGTH     = 1378.0f;  // mean length of the reverb's combs
+const eF32 FDNINPUTGAIN     = 0.1f;
+const eF32 FDNANTIDENORMAL  = 1e-15f;   // keeps decaying lines away from denormals
+
+eTfEffect * eTfEffectFdnReverbCreate(eU32 sampleRate)
+{
+    eTfEffectFdnReverb *fdn = static_cast<eTfEffectFdnReverb *>(eAllocAligned(sizeof(eTfEffectFdnReverb), 16));
+    eMemSet(fdn, 0, sizeof(eTfEffectFdnReverb));
+
+    eU32 size = 1;
+
+    for (eU32 i=0; i<TF_FX_FDNREVERB_LINES; i++)
     {
-        eF32 *signals_out[2];
-        signals_out[LEFT] = &reverb->combBuffers[TF_MAXFRAMESIZE * 2 * i];
-        signals_out[RIGHT] = &reverb->combBuffers[TF_MAXFRAMESIZE * 2 * i + 1];
-        eTfCombProcess(reverb->comb[LEFT][i], reverb->comb[RIGHT][i], damp1, damp2, cmbFeedback, gain, signal, signals_out, len);
-        eTfSignalMix(signals_mix, signals_out, len, 0.5f);
+        fdn->length[i] = eMax<eU32>(eFtoL(FDNLENGTHS[i] * (eF32)sampleRate / 44100.0f), 4);
+
+        while (size <= fdn->length[i])
+            size <<= 1;
     }
 
-    // run allpass filters in serial
-    for (eU32 i=0;i<TF_FX_REVERB_NUMALLPASSES; i++)
+    // the last line is read up to three samples past its end
+    eU32 count = size*TF_FX_FDNREVERB_LINES + 4;
+    fdn->lines = static_cast<eF32 *>(eAllocAligned(count*sizeof(eF32), 16));
+    eMemSet(fdn->lines, 0, count*sizeof(eF32));
+    fdn->mask = size-1;
+    fdn->lastRoomsize = -1.0f;
+    return fdn;
+}
+
+void eTfEffectFdnReverbDelete(eTfEffect *fx)
+{
+    eTfEffectFdnReverb *fdn = static_cast<eTfEffectFdnReverb *>(fx);
+
+    eFreeAligned(fdn->lines);
+    eFreeAligned(fx);
+}
+
+static void eTfFdnStore(eF32 *dst, eF32x4 v, eU32 count)
+{
+    if (count == 4)
+        eSimdStore(v, dst);
+    else
     {
-        eTfAllpassProcess(reverb->allpass[LEFT][i], reverb->allpass[RIGHT][i], apsFeedback, signals_mix, signals_mix, len);
+        eF32 values[4];
+        eSimdStore(v, values);
+        for (eU32 n=0; n<count; n++)
+            dst[n] = values[n];
     }
+}
 
-    // create final signal
-    eF32x2 wet1x2 = eSimdSetAll(wet1);
-    eF32x2 wet2x2 = eSimdSetAll(wet2);
-    eF32x2 dry0x2 = eSimdSetAll(dry0);
+// the lines are longer than four samples, so four samples of all lines
+// are read before any of them is written. only the damping is computed
+// per sample, with the lines transposed into lanes. the hadamard matrix
+// and the taps work on four samples of a line at a time.
+void eTfEffectFdnReverbProcess(eTfEffect *fx, eTfSynth &, eTfInstrument &instr, eF32 **signal, eU32 len)
+{
+    eASSERT_ALIGNED16(fx);
+    eTfEffectFdnReverb *fdn = static_cast<eTfEffectFdnReverb *>(fx);
+
+    eF32 roomsize          = instr.params[TF_REVERB_ROOMSIZE] * SCALEROOM + OFFSETROOM;
+    eF32 damp              = instr.params[TF_REVERB_DAMP] * SCALEDAMP;
+    eF32 wet               = instr.params[TF_REVERB_WET] * SCALEWET;
+    eF32 dry               = (1.0f - instr.params[TF_REVERB_WET]) * SCALEDRY;
+    eF32 width             = instr.params[TF_REVERB_WIDTH];
+    eF32 wet1              = wet * (width / 2.0f + 0.5f);
+    eF32 wet2              = wet * ((1.0f - width) / 2.0f);
 
-	//eSwap<eF32*>(signal[LEFT], signal[RIGHT]);
+    // every line decays like a comb of the reverb with the same
+    // feedback, the hadamard matrix is scaled to keep the energy
+    if (roomsize != fdn->lastRoomsize)
+    {
+        for (eU32 i=0; i<TF_FX_FDNREVERB_LINES; i++)
+            fdn->gain[i] = ePow(roomsize, FDNLENGTHS[i] / FDNREFLENGTH) / eSqrt((eF32)TF_FX_FDNREVERB_LINES);
+
+        fdn->lastRoomsize = roomsize;
+    }
+
+    const eU32 LINES = TF_FX_FDNREVERB_LINES;
+    const eU32 GROUPS = LINES/4;
+    const eU32 size = fdn->mask + 1;
+
+    const eF32x4 mdamp1 = eSimdSetAll4(damp);
+    const eF32x4 mdamp2 = eSimdSetAll4(1.0f - damp);
+    const eF32x4 mwet1 = eSimdSetAll4(wet1);
+    const eF32x4 mwet2 = eSimdSetAll4(wet2);
+    const eF32x4 mdry = eSimdSetAll4(dry);
+    const eF32x4 minputGain = eSimdSetAll4(FDNINPUTGAIN);
+    const eF32x4 mantiDenormal = eSimdSetAll4(FDNANTIDENORMAL);
+
+    eF32x4 gain[GROUPS];
+    eF32x4 filterstore[GROUPS];
+    for (eU32 g=0; g<GROUPS; g++)
+    {
+        gain[g] = eSimdLoad(&fdn->gain[g*4]);
+        filterstore[g] = eSimdLoad(&fdn->filterstore[g*4]);
+    }
 
     eF32 *dryL = signal[LEFT];
     eF32 *dryR = signal[RIGHT];
-    eF32 *wetL = signals_mix[LEFT];
-    eF32 *wetR = signals_mix[RIGHT];
 
-    while(len--)
+    eU32 i = 0;
+    while (i < len)
     {
-        eF32x2 in = eSimdSet2(*dryL, *dryR);
-        eF32x2 lwet1 = eSimdSet2(*wetL, *wetR);
-		eF32x2 lwet2 = eSimdSet2(*wetR++, *wetL++);
-        eF32x2 out = eSimdSetAll(0.0f);
-
-        out = eSimdAdd(
-                eSimdAdd(
-                    eSimdMul(lwet1, wet1x2),
-                    eSimdMul(lwet2, wet2x2)),
-                eSimdMul(in, dry0x2));
-
-        eSimdStore2(out, *dryL++, *dryR++);
+        eF32 *lines[LINES];
+        const eF32 *taps[LINES];
+        eU32 run = eMin<eU32>(len - i, size - fdn->writePos);
+
+        for (eU32 l=0; l<LINES; l++)
+        {
+            eU32 readPos = (fdn->writePos - fdn->length[l]) & fdn->mask;
+            run = eMin<eU32>(run, size - readPos);
+            lines[l] = &fdn->lines[l*size + fdn->writePos];
+            taps[l] = &fdn->lines[l*size + readPos];
+        }
+
+        for (eU32 j=0; j<run; j+=4)
+        {
+            eU32 count = eMin<eU32>(run - j, 4);
+            eF32x4 out[LINES];
+            eF32x4 rows[LINES];
+
+            for (eU32 l=0; l<LINES; l++)
+                rows[l] = out[l] = eSimdLoad(&taps[l][j]);
+
+            for (eU32 g=0; g<GROUPS; g++)
+            {
+                eSimdTranspose(rows[g*4+0], rows[g*4+1], rows[g*4+2], rows[g*4+3]);
+
+                for (eU32 n=0; n<count; n++)
+                {
+                    filterstore[g] = eSimdAdd(eSimdMul(rows[g*4+n], mdamp2), eSimdMul(filterstore[g], mdamp1));
+                    rows[g*4+n] = eSimdMul(filterstore[g], gain[g]);
+                }
+
+                eSimdTranspose(rows[g*4+0], rows[g*4+1], rows[g*4+2], rows[g*4+3]);
+            }
+
+            for (eU32 h=1; h<LINES; h<<=1)
+            {
+                for (eU32 l=0; l<LINES; l+=2*h)
+                {
+                    for (eU32 k=l; k<l+h; k++)
+                    {
+                        eF32x4 a = rows[k];
+                        eF32x4 b = rows[k+h];
+                        rows[k] = eSimdAdd(a, b);
+                        rows[k+h] = eSimdSub(a, b);
+                    }
+                }
+            }
+
+            eF32 *inL = &dryL[i+j];
+            eF32 *inR = &dryR[i+j];
+            eF32 in[2][4] = {{0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}};
+            for (eU32 n=0; n<count; n++)
+            {
+                in[LEFT][n] = inL[n];
+                in[RIGHT][n] = inR[n];
+            }
+
+            eF32x4 mdryL = eSimdLoad(in[LEFT]);
+            eF32x4 mdryR = eSimdLoad(in[RIGHT]);
+            eF32x4 input = eSimdAdd(eSimdMul(eSimdAdd(mdryL, mdryR), minputGain), mantiDenormal);
+
+            for (eU32 l=0; l<LINES; l++)
+                eTfFdnStore(&lines[l][j], eSimdAdd(rows[l], input), count);
+
+            // even lines make the left channel, odd lines the right one
+            eF32x4 wetL = eSimdAdd(eSimdAdd(out[0], out[2]), eSimdAdd(out[4], out[6]));
+            eF32x4 wetR = eSimdAdd(eSimdAdd(out[1], out[3]), eSimdAdd(out[5], out[7]));
+
+            eTfFdnStore(inL, eSimdAdd(eSimdAdd(eSimdMul(wetL, mwet1), eSimdMul(wetR, mwet2)), eSimdMul(mdryL, mdry)), count);
+            eTfFdnStore(inR, eSimdAdd(eSimdAdd(eSimdMul(wetR, mwet1), eSimdMul(wetL, mwet2)), eSimdMul(mdryR, mdry)), count);
+        }
+
+        fdn->writePos = (fdn->writePos + run) & fdn->mask;
+        i += run;
     }
+
+    for (eU32 g=0; g<GROUPS; g++)
+        eSimdStore(filterstore[g], &fdn->filterstore[g*4]);
 }
 
 // ---------------------------------------------------------------------------------------------------------------------------
 //  EFFECT DISTORTION
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectDistortionCreate()
+eTfEffect * eTfEffectDistortionCreate(eU32)
 {
     eTfEffectDistortion *dist = static_cast<eTfEffectDistortion *>(eAllocAligned(sizeof(eTfEffectDistortion), 16));
     eMemSet(dist, 0, sizeof(eTfEffectDistortion));
@@ -372,10 +861,58 @@ void eTfEffectDistortionProcess(eTfEffect *fx, eTfSynth &, eTfInstrument &instr,
 //  EFFECT FORMANT
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectFormantCreate()
+// the 10th order vowel filters of the original double precision version,
+// factored into five biquads each: { a1, a2, gain }. the sections are
+// ordered by formant frequency, so section n of one vowel morphs into
+// section n of the next. the gains scale the cascade up to a section to
+// a peak of 1, the last one restores the level of the whole filter.
+const eF32 FORMANTSECTIONS[TF_FORMANTCOUNT][TF_FX_FORMANT_SECTIONS][3] =
+{
+    { // A
+        { -1.97579718f, 0.988495648f, 0.00129637425f },
+        { -1.96052146f, 0.987459242f, 0.0143237049f },
+        { -1.81613219f, 0.98300004f, 0.154159665f },
+        { -1.68343306f, 0.981670916f, 0.285525113f },
+        { -1.50778139f, 0.980247498f, 3.80558109f },
+    },
+    { // E
+        { -1.98905122f, 0.991521239f, 0.000420609605f },
+        { -1.90554512f, 0.985744834f, 0.0777748451f },
+        { -1.82743132f, 0.983150721f, 0.153295055f },
+        { -1.68100035f, 0.978823543f, 0.295403153f },
+        { -1.50135505f, 0.971911609f, 2.94468594f },
+    },
+    { // I
+        { -1.99002087f, 0.991473973f, 0.000323598302f },
+        { -1.89546621f, 0.987307727f, 0.0904285163f },
+        { -1.81307721f, 0.98580116f, 0.171310604f },
+        { -1.68460345f, 0.983068347f, 0.297053009f },
+        { -1.50993526f, 0.983045518f, 2.24171925f },
+    },
+    { // O
+        { -1.98623121f, 0.990231931f, 0.000617193058f },
+        { -1.97543156f, 0.98849076f, 0.00911804754f },
+        { -1.82660568f, 0.985889018f, 0.155299008f },
+        { -1.69814706f, 0.981631041f, 0.279505908f },
+        { -1.50831854f, 0.980951965f, 4.64931154f },
+    },
+    { // U
+        { -1.99058723f, 0.992651701f, 0.000333314441f },
+        { -1.98175561f, 0.991761744f, 0.00797144417f },
+        { -1.8314935f, 0.976034284f, 0.142510593f },
+        { -1.69213974f, 0.974694014f, 0.280522466f },
+        { -1.50134683f, 0.971905231f, 3.85455966f },
+    },
+};
+
+const eF32 FORMANTGLIDE        = 0.02f;     // seconds to morph from one vowel to the next
+const eF32 FORMANTANTIDENORMAL = 1e-15f;    // keeps the decaying states away from denormals
+
+eTfEffect * eTfEffectFormantCreate(eU32)
 {
     eTfEffectFormant *formant = static_cast<eTfEffectFormant *>(eAllocAligned(sizeof(eTfEffectFormant), 16));
     eMemSet(formant, 0, sizeof(eTfEffectFormant));
+    formant->position = -1.0f;
     return formant;
 }
 
@@ -384,70 +921,93 @@ void eTfEffectFormantDelete(eTfEffect *fx)
     eFreeAligned(fx);
 }
 
-void eTfEffectFormantProcess(eTfEffect *fx, eTfSynth &, eTfInstrument &instr, eF32 **signal, eU32 len)
+void eTfEffectFormantProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len)
 {
     eASSERT_ALIGNED16(fx);
     eTfEffectFormant *formant = static_cast<eTfEffectFormant *>(fx);
 
-    const eF64 coeff[5][11]= {
-        { 3.11044e-06,
-            8.943665402,    -36.83889529,    92.01697887,    -154.337906,    181.6233289,
-            -151.8651235,   89.09614114,    -35.10298511,    8.388101016,    -0.923313471  ///A
-        },
-        {4.36215e-06,
-        8.90438318,    -36.55179099,    91.05750846,    -152.422234,    179.1170248,  ///E
-        -149.6496211,87.78352223,    -34.60687431,    8.282228154,    -0.914150747
-        },
-        { 3.33819e-06,
-        8.893102966,    -36.49532826,    90.96543286,    -152.4545478,    179.4835618,
-        -150.315433,    88.43409371,    -34.98612086,    8.407803364,    -0.932568035  ///I
-        },
-        {1.13572e-06,
-        8.994734087,    -37.2084849,    93.22900521,    -156.6929844,    184.596544,   ///O
-        -154.3755513,    90.49663749,    -35.58964535,    8.478996281,    -0.929252233
-        },
-        {4.09431e-07,
-        8.997322763,    -37.20218544,    93.11385476,    -156.2530937,    183.7080141,  ///U
-        -153.2631681,    89.59539726,    -35.12454591,    8.338655623,    -0.910251753
-        }
-    };
-
-    eU32 mode          = eFtoL(instr.params[TF_FORMANT_MODE] * 4.0f);
+    eF32 target        = instr.params[TF_FORMANT_MODE] * (TF_FORMANTCOUNT - 1);
     eF32 wet           = instr.params[TF_FORMANT_WET];
-    eF32 wet_inv    = 1.0f - wet;
+    eF32 wet_inv       = 1.0f - wet;
 
-    const eF64 *co_vow = coeff[mode];
-    eF64 res = 0.0f;
+    // a new mode glides to its vowel instead of switching the filter.
+    // stable biquads stay stable when their a1 and a2 are interpolated.
+    // the glide moves on every TF_CONTROLTICK samples, wherever the
+    // blocks end
+    eF32 step = (eF32)TF_CONTROLTICK / (FORMANTGLIDE * synth.sampleRate);
 
-    for(eU32 i=0;i<2;i++)
+    eF32x2 a1[TF_FX_FORMANT_SECTIONS];
+    eF32x2 a2[TF_FX_FORMANT_SECTIONS];
+    eF32x2 gain[TF_FX_FORMANT_SECTIONS];
+    eF32x2 state1[TF_FX_FORMANT_SECTIONS];
+    eF32x2 state2[TF_FX_FORMANT_SECTIONS];
+
+    for (eU32 j=0; j<TF_FX_FORMANT_SECTIONS; j++)
     {
-        eF32 *in = signal[i];
-        eF64 *mem = i==0 ? formant->memoryL : formant->memoryR;
+        state1[j] = formant->state1[j];
+        state2[j] = formant->state2[j];
+    }
 
-        eU32 len2 = len;
-        while (len2--)
+    const eF32x2 wetx2 = eSimdSetAll(wet);
+    const eF32x2 dryx2 = eSimdSetAll(wet_inv);
+    const eF32x2 zero = eSimdSetAll(0.0f);
+    const eF32x2 antiDenormal = eSimdSetAll(FORMANTANTIDENORMAL);
+    eF32 *signal1 = signal[0];
+    eF32 *signal2 = signal[1];
+
+    for (eU32 pos=0; pos<len; )
+    {
+        if (formant->position < 0.0f)
+            formant->position = target;
+        else if (formant->glidePos == 0)
+            formant->position = eClamp(formant->position - step, target, formant->position + step);
+
+        eU32 end = pos + eMin<eU32>(len - pos, TF_CONTROLTICK - formant->glidePos);
+        formant->glidePos = (formant->glidePos + end - pos) % TF_CONTROLTICK;
+
+        eU32 vowel = eMin<eU32>(eFtoL(formant->position), TF_FORMANTCOUNT - 2);
+        eF32 t = formant->position - (eF32)vowel;
+
+        for (eU32 j=0; j<TF_FX_FORMANT_SECTIONS; j++)
         {
-            res = co_vow[0] * (eF64)*in;
+            const eF32 *from = FORMANTSECTIONS[vowel][j];
+            const eF32 *to = FORMANTSECTIONS[vowel+1][j];
 
-            for (eU32 j=0;j<TF_FX_FORMANT_MEMSIZE;j++)
-                res += co_vow[j+1] * mem[j];
+            a1[j] = eSimdSetAll(from[0] * (1.0f - t) + to[0] * t);
+            a2[j] = eSimdSetAll(from[1] * (1.0f - t) + to[1] * t);
+            gain[j] = eSimdSetAll(from[2] * (1.0f - t) + to[2] * t);
+        }
 
-            for(eU32 j=TF_FX_FORMANT_MEMSIZE-1;j>0;j--)
-                mem[j] = mem[j-1];
+        for (; pos<end; pos++)
+        {
+            eF32x2 x = eSimdSet2(signal1[pos], signal2[pos]);
+            eF32x2 y = eSimdAdd(x, antiDenormal);
 
-            mem[0] = res;
+            for (eU32 j=0; j<TF_FX_FORMANT_SECTIONS; j++)
+            {
+                // y = gain*in + s1, s1 = s2 - a1*y, s2 = -a2*y
+                y = eSimdFma(state1[j], gain[j], y);
+                state1[j] = eSimdNfma(state2[j], a1[j], y);
+                state2[j] = eSimdNfma(zero, a2[j], y);
+            }
 
-            *in *= wet_inv;
-            *in++ += (eF32)res * wet;
+            x = eSimdFma(eSimdMul(x, dryx2), y, wetx2);
+            eSimdStore2(x, signal1[pos], signal2[pos]);
         }
     }
+
+    for (eU32 j=0; j<TF_FX_FORMANT_SECTIONS; j++)
+    {
+        formant->state1[j] = state1[j];
+        formant->state2[j] = state2[j];
+    }
 }
 
 // ---------------------------------------------------------------------------------------------------------------------------
 //  EFFECT EQ
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectEqCreate()
+eTfEffect * eTfEffectEqCreate(eU32)
 {
     eTfEffectEq *eq = static_cast<eTfEffectEq *>(eAllocAligned(sizeof(eTfEffectEq), 16));
     eMemSet(eq, 0, sizeof(eTfEffectEq));
@@ -541,7 +1101,7 @@ void eTfEffectEqProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF
 //  EFFECT CHORUS
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectChorusCreate()
+eTfEffect * eTfEffectChorusCreate(eU32 sampleRate)
 {
     eTfEffectChorus *chorus = static_cast<eTfEffectChorus *>(eAllocAligned(sizeof(eTfEffectChorus), 16));
     eMemSet(chorus, 0, sizeof(eTfEffectChorus));
@@ -552,7 +1112,7 @@ eTfEffect * eTfEffectChorusCreate()
 
     for(eU32 i=0; i<2*TF_FX_CHORUS_DELAYCOUNT; i++)
     {
-        eTfDelayInit(chorus->delay[i], eTRUE);
+        eTfDelayInit(chorus->delay[i], eTRUE, sampleRate, TF_FX_CHORUS_DELAY_MAX);
         chorus->lfoPhase[i] = rand.NextFloat();
     }
 
@@ -561,6 +1121,11 @@ eTfEffect * eTfEffectChorusCreate()
 
 void eTfEffectChorusDelete(eTfEffect *fx)
 {
+    eTfEffectChorus *chorus = static_cast<eTfEffectChorus *>(fx);
+
+    for(eU32 i=0; i<2*TF_FX_CHORUS_DELAYCOUNT; i++)
+        eTfDelayFree(chorus->delay[i]);
+
     eFreeAligned(fx);
 }
 
@@ -572,18 +1137,34 @@ void eTfEffectChorusProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr
     eF32 gain = instr.params[TF_CHORUS_GAIN];
     eF32 freq = instr.params[TF_CHORUS_RATE];
 
+    // the lfos move on every TF_CONTROLTICK samples, wherever the blocks end
     const eF32 range = TF_FX_CHORUS_DELAY_MAX - TF_FX_CHORUS_DELAY_MIN;
-    freq = (freq * freq) / synth.sampleRate * len * 50.0f;
+    freq = (freq * freq) / synth.sampleRate * TF_CONTROLTICK * 50.0f;
     gain *= 0.7f;
 
-    for(eU32 i=0; i<2 * TF_FX_CHORUS_DELAYCOUNT; i++)
+    for (eU32 pos=0; pos<len; )
     {
-        eF32 sine = eSin(chorus->lfoPhase[i])+1.0f/2.0f;
-        eF32 delay = (sine * depth * range) + TF_FX_CHORUS_DELAY_MIN;
-        delay = eClamp<eF32>(TF_FX_CHORUS_DELAY_MIN, delay, TF_FX_CHORUS_DELAY_MAX);
-        eTfDelayUpdate(chorus->delay[i], synth.sampleRate, delay);
-        eTfDelayProcess(chorus->delay[i], signal[i%2], len, gain);
-        chorus->lfoPhase[i] += freq;
+        eU32 count = eMin<eU32>(len - pos, TF_CONTROLTICK - chorus->lfoPos);
+
+        for(eU32 i=0; i<2 * TF_FX_CHORUS_DELAYCOUNT; i++)
+        {
+            eF32 sine = eSin(chorus->lfoPhase[i])+1.0f/2.0f;
+            eF32 delay = (sine * depth * range) + TF_FX_CHORUS_DELAY_MIN;
+            delay = eClamp<eF32>(TF_FX_CHORUS_DELAY_MIN, delay, TF_FX_CHORUS_DELAY_MAX);
+            eTfDelayUpdate(chorus->delay[i], synth.sampleRate, delay);
+            eTfDelayProcess(chorus->delay[i], signal[i%2] + pos, count, gain);
+        }
+
+        pos += count;
+        chorus->lfoPos += count;
+
+        if (chorus->lfoPos == TF_CONTROLTICK)
+        {
+            for(eU32 i=0; i<2 * TF_FX_CHORUS_DELAYCOUNT; i++)
+                chorus->lfoPhase[i] += freq;
+
+            chorus->lfoPos = 0;
+        }
     }
 }
 
@@ -591,15 +1172,26 @@ void eTfEffectChorusProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr
 //  EFFECT FLANGER
 // ---------------------------------------------------------------------------------------------------------------------------
 
-eTfEffect * eTfEffectFlangerCreate()
+eTfEffect * eTfEffectFlangerCreate(eU32 sampleRate)
 {
     eTfEffectFlanger *flanger = static_cast<eTfEffectFlanger *>(eAllocAligned(sizeof(eTfEffectFlanger), 16));
     eMemSet(flanger, 0, sizeof(eTfEffectFlanger));
+
+    eU32 size = eTfDelayBufferSize(sampleRate, TF_FX_FLANGER_DELAY_MAX);
+    flanger->buffleft = static_cast<eF32 *>(eAllocAligned(size*sizeof(eF32), 16));
+    flanger->buffright = static_cast<eF32 *>(eAllocAligned(size*sizeof(eF32), 16));
+    eMemSet(flanger->buffleft, 0, size*sizeof(eF32));
+    eMemSet(flanger->buffright, 0, size*sizeof(eF32));
+    flanger->buffmask = size-1;
     return flanger;
 }
 
 void eTfEffectFlangerDelete(eTfEffect *fx)
 {
+    eTfEffectFlanger *flanger = static_cast<eTfEffectFlanger *>(fx);
+
+    eFreeAligned(flanger->buffleft);
+    eFreeAligned(flanger->buffright);
     eFreeAligned(fx);
 }
 
@@ -616,8 +1208,8 @@ void eTfEffectFlangerProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &inst
     eF32 wet = instr.params[TF_FLANGER_WET];
 
     const eF32 DELAYMIN = (eF32)synth.sampleRate * 0.1f / 1000.0f;    // 0.1 ms delay min
-    const eF32 DELAYMAX = (eF32)synth.sampleRate *12.1f / 1000.0f;    // 12.1 ms delay max
-    eF32 inc = 0.1f*(eF32)len;
+    const eF32 DELAYMAX = (eF32)synth.sampleRate * TF_FX_FLANGER_DELAY_MAX / 1000.0f;
+    eF32 inc = 0.1f*(eF32)TF_RATEBLOCK;   // per sample, tuned at that block size
 
     while(len--)
     {
@@ -660,14 +1252,8 @@ void eTfEffectFlangerProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &inst
 
         flanger->angle++;
 
-        eInt ppleft = flanger->buffpos - deltaleft;
-        eInt ppright = flanger->buffpos - deltaright;
-
-        if(ppleft<0)
-            ppleft += TF_FX_FLANGERBUFFSIZE;
-
-        if(ppright<0)
-            ppright += TF_FX_FLANGERBUFFSIZE;
+        eInt ppleft = (flanger->buffpos - deltaleft) & flanger->buffmask;
+        eInt ppright = (flanger->buffpos - deltaright) & flanger->buffmask;
 
         eF32 l = *pcmleft - wet * flanger->buffleft[ppleft];
 
@@ -694,9 +1280,6 @@ void eTfEffectFlangerProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &inst
 
         pcmleft++;
         pcmright++;
-        flanger->buffpos++;
-
-        if (flanger->buffpos >= TF_FX_FLANGERBUFFSIZE)
-            flanger->buffpos = 0;
+        flanger->buffpos = (flanger->buffpos + 1) & flanger->buffmask;
     }
 }
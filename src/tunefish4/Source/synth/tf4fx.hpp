@@ -30,16 +30,18 @@ struct eTfInstrument;
 //  EFFECT COMPONENTS
 // ---------------------------------------------------------------------------------------------------------------------------
 
-const eU32 TF_DELAY_MAXLEN   = 192000;
 const eU32 TF_COMB_MAXLEN    = 4096;
+const eU32 TF_COMBBANK_COMBS = 8;
 const eU32 TF_ALLPASS_MAXLEN = 4096;
 
+// the buffer is sized when the effect is created, for the longest
+// delay at the sample rate of then, rounded up to a power of two
 struct eTfDelay
 {
-    eBool    singleDelay;
-    eF32     delayBuffer[TF_DELAY_MAXLEN];
+    eBool    singleDelay;   // no feedback, the chorus taps
+    eF32 *   delayBuffer;
+    eU32     mask;          // buffer size - 1
     eU32     delayLen;
-    eU32     readOffset;
     eU32     writeOffset;
 };
 
@@ -58,16 +60,21 @@ struct eTfAllpass
     eInt    bufidx;
 };
 
-void eTfDelayInit(eTfDelay &delay, eBool singleDelay);
+void eTfDelayInit(eTfDelay &delay, eBool singleDelay, eU32 sampleRate, eF32 maxMs);
+void eTfDelayFree(eTfDelay &delay);
 void eTfDelayUpdate(eTfDelay &delay, eU32 sampleRate, eF32 ms);
 void eTfDelayProcess(eTfDelay &delay, eF32 *signal, eU32 len, eF32 decay);
 
 void eTfCombInit(eTfComb &comb, eU32 size);
-void eTfCombProcess(eTfComb &comb1, eTfComb &comb2, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 **signals_out, eU32 len);
+void eTfCombBankProcess(eTfComb *combs, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 *wet, eU32 len);
+eF32 eTfCombBankPeek(const eTfComb *combs);
 
 void eTfAllpassInit(eTfAllpass &allpass, eU32 size);
 void eTfAllpassProcess(eTfAllpass &allpass1, eTfAllpass &allpass2, eF32 feedback, eF32 **signals_in, eF32 **signals_out, eU32 len);
 
+struct eTfKernels;
+void eTfFxKernelsInit(eTfKernels &kernels, eSimdIsa isa);
+
 // ---------------------------------------------------------------------------------------------------------------------------
 //  EFFECT INTERFACE
 // ---------------------------------------------------------------------------------------------------------------------------
@@ -82,7 +89,7 @@ enum eTfFxMode
     FX_REVERB,
     FX_FORMANT,
     FX_EQ,
-    FX_RESERVED6,
+    FX_FDNREVERB,
     FX_RESERVED7,
     FX_RESERVED8,
 
@@ -90,7 +97,7 @@ enum eTfFxMode
 };
 
 typedef void        eTfEffect;
-typedef eTfEffect * (*eTfEffectCreateProc)();
+typedef eTfEffect * (*eTfEffectCreateProc)(eU32 sampleRate);
 typedef void        (*eTfEffectDeleteProc)(eTfEffect *fx);
 typedef void        (*eTfEffectProcessProc)(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -105,7 +112,7 @@ struct eTfEffectDelay
     eTfDelay    delay[2];
 };
 
-eTfEffect *     eTfEffectDelayCreate();
+eTfEffect *     eTfEffectDelayCreate(eU32 sampleRate);
 void            eTfEffectDelayDelete(eTfEffect *fx);
 void            eTfEffectDelayProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -113,21 +120,44 @@ void            eTfEffectDelayProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrum
 //  EFFECT REVERB
 // ---------------------------------------------------------------------------------------------------------------------------
 
-const eU32      TF_FX_REVERB_NUMCOMBS     = 8;
+const eU32      TF_FX_REVERB_NUMCOMBS     = TF_COMBBANK_COMBS;
 const eU32      TF_FX_REVERB_NUMALLPASSES = 4;
+const eU32      TF_FX_REVERB_CHUNK        = 256;    // samples of wet signal on the stack
 
 struct eTfEffectReverb
 {
-    eTfComb     comb[2][TF_FX_REVERB_NUMCOMBS];
+    eTfComb     comb[TF_FX_REVERB_NUMCOMBS];
     eTfAllpass  allpass[2][TF_FX_REVERB_NUMALLPASSES];
-    eF32        combBuffers[TF_FX_REVERB_NUMCOMBS*2*TF_MAXFRAMESIZE];
-    eF32        mixBuffers[TF_MAXFRAMESIZE*2];
 };
 
-eTfEffect *     eTfEffectReverbCreate();
+eTfEffect *     eTfEffectReverbCreate(eU32 sampleRate);
 void            eTfEffectReverbDelete(eTfEffect *fx);
 void            eTfEffectReverbProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
+// ---------------------------------------------------------------------------------------------------------------------------
+//  EFFECT FDN REVERB
+// ---------------------------------------------------------------------------------------------------------------------------
+
+const eU32      TF_FX_FDNREVERB_LINES = 8;
+
+// a cheaper reverb with the same parameters. eight delay lines are fed
+// back through a hadamard matrix, the lines share one allocation and
+// are all sized like the longest one.
+struct eTfEffectFdnReverb
+{
+    eF32 *      lines;
+    eU32        mask;           // line size - 1
+    eU32        writePos;
+    eU32        length[TF_FX_FDNREVERB_LINES];
+    eF32        gain[TF_FX_FDNREVERB_LINES];        // feedback for the room size
+    eF32        filterstore[TF_FX_FDNREVERB_LINES];
+    eF32        lastRoomsize;
+};
+
+eTfEffect *     eTfEffectFdnReverbCreate(eU32 sampleRate);
+void            eTfEffectFdnReverbDelete(eTfEffect *fx);
+void            eTfEffectFdnReverbProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
+
 // ---------------------------------------------------------------------------------------------------------------------------
 //  EFFECT DISTORTION
 // ---------------------------------------------------------------------------------------------------------------------------
@@ -140,7 +170,7 @@ struct eTfEffectDistortion
     eF32        powTable[TF_FX_DISTORTION_TABLESIZE];
 };
 
-eTfEffect *     eTfEffectDistortionCreate();
+eTfEffect *     eTfEffectDistortionCreate(eU32 sampleRate);
 void            eTfEffectDistortionDelete(eTfEffect *fx);
 void            eTfEffectDistortionProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -148,15 +178,19 @@ void            eTfEffectDistortionProcess(eTfEffect *fx, eTfSynth &synth, eTfIn
 //  EFFECT FORMANT
 // ---------------------------------------------------------------------------------------------------------------------------
 
-const eU32      TF_FX_FORMANT_MEMSIZE = 10;
+const eU32      TF_FX_FORMANT_SECTIONS = 5;
 
+// the vowel filters run as a cascade of all-pole biquads in transposed
+// direct form II, with the left and right channel in one vector
 struct eTfEffectFormant
 {
-    eF64        memoryL[TF_FX_FORMANT_MEMSIZE];
-    eF64        memoryR[TF_FX_FORMANT_MEMSIZE];
+    eF32x2      state1[TF_FX_FORMANT_SECTIONS];
+    eF32x2      state2[TF_FX_FORMANT_SECTIONS];
+    eF32        position;       // vowel the filter is at, glides to the mode
+    eU32        glidePos;       // samples since the position last moved on
 };
 
-eTfEffect *     eTfEffectFormantCreate();
+eTfEffect *     eTfEffectFormantCreate(eU32 sampleRate);
 void            eTfEffectFormantDelete(eTfEffect *fx);
 void            eTfEffectFormantProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -184,7 +218,7 @@ struct eTfEffectEq
     eF32x2      m_sdm3;     //                   3
 };
 
-eTfEffect *     eTfEffectEqCreate();
+eTfEffect *     eTfEffectEqCreate(eU32 sampleRate);
 void            eTfEffectEqDelete(eTfEffect *fx);
 void            eTfEffectEqProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -200,9 +234,10 @@ struct eTfEffectChorus
 {
     eTfDelay    delay[2*TF_FX_CHORUS_DELAYCOUNT];
     eF32        lfoPhase[2*TF_FX_CHORUS_DELAYCOUNT];
+    eU32        lfoPos;         // samples since the phases last moved on
 };
 
-eTfEffect *     eTfEffectChorusCreate();
+eTfEffect *     eTfEffectChorusCreate(eU32 sampleRate);
 void            eTfEffectChorusDelete(eTfEffect *fx);
 void            eTfEffectChorusProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -210,14 +245,15 @@ void            eTfEffectChorusProcess(eTfEffect *fx, eTfSynth &synth, eTfInstru
 //  EFFECT FLANGER
 // ---------------------------------------------------------------------------------------------------------------------------
 
-const eU32  TF_FX_FLANGERBUFFSIZE      = 4096;
+const eF32  TF_FX_FLANGER_DELAY_MAX    = 12.1f;    // ms
 
 struct eTfEffectFlanger
 {
     eInt        buffpos;
     eInt        bidi;
-    eF32        buffleft[TF_FX_FLANGERBUFFSIZE*2];
-    eF32        buffright[TF_FX_FLANGERBUFFSIZE*2];
+    eF32 *      buffleft;       // both sized like an eTfDelay
+    eF32 *      buffright;
+    eInt        buffmask;
     eInt        depth;
     eInt        targetDepth;
     eInt        volume;
@@ -229,7 +265,7 @@ struct eTfEffectFlanger
     eF32        lastBpm;
 };
 
-eTfEffect *     eTfEffectFlangerCreate();
+eTfEffect *     eTfEffectFlangerCreate(eU32 sampleRate);
 void            eTfEffectFlangerDelete(eTfEffect *fx);
 void            eTfEffectFlangerProcess(eTfEffect *fx, eTfSynth &synth, eTfInstrument &instr, eF32 **signal, eU32 len);
 
@@ -275,7 +311,11 @@ static eTfEffectCreateProc s_effectCreate[] =
 #else
     nullptr,
 #endif
-    nullptr,   // FX_RESERVED6
+#ifndef eCFG_NO_TF_FX_FDNREVERB
+    eTfEffectFdnReverbCreate,
+#else
+    nullptr,
+#endif
     nullptr,   // FX_RESERVED7
     nullptr,   // FX_RESERVED8
 };
@@ -318,7 +358,11 @@ static eTfEffectDeleteProc s_effectDelete[] =
 #else
     nullptr,
 #endif
-    nullptr,   // FX_RESERVED6
+#ifndef eCFG_NO_TF_FX_FDNREVERB
+    eTfEffectFdnReverbDelete,
+#else
+    nullptr,
+#endif
     nullptr,   // FX_RESERVED7
     nullptr,   // FX_RESERVED8
 };
@@ -361,7 +405,11 @@ static eTfEffectProcessProc s_effectProcess[] =
 #else
     nullptr,
 #endif
-    nullptr,   // FX_RESERVED6
+#ifndef eCFG_NO_TF_FX_FDNREVERB
+    eTfEffectFdnReverbProcess,
+#else
+    nullptr,
+#endif
     nullptr,   // FX_RESERVED7
     nullptr,   // FX_RESERVED8
 };
@@ -113,8 +113,8 @@ static void optimizeParams(eF32 *params)
 eTfRecorder::eTfRecorder()
 {
 	eMemSet(m_synths, 0, sizeof(Tunefish4AudioProcessor*) * TF_MAX_INSTR);
-	m_isRecording = eFALSE;
-	m_tempo = 0;
+	m_isRecording.set(eFALSE);
+	m_tempo.set(0);
 }
 
 eTfRecorder::~eTfRecorder()
@@ -130,27 +130,78 @@ eTfRecorder & eTfRecorder::getInstance()
 void eTfRecorder::reset()
 {
 	m_cs.enter();
+
+	// drop whatever the audio threads pushed in the meantime. they
+	// may still be writing, so the rings are only ever emptied from
+	// the reading side
+	collect();
 	m_events.clear();
 	m_cs.exit();
 }
 
 void eTfRecorder::startRecording()
 {
-	if (!m_isRecording)
+	if (!m_isRecording.get())
 	{
 		reset();
-		m_isRecording = eTRUE;
+		m_isRecording.set(eTRUE);
+		startTimer(50);
 	}
 }
 
 void eTfRecorder::stopRecording()
 {
-	m_isRecording = eFALSE;
+	m_isRecording.set(eFALSE);
+	stopTimer();
+	collect();
 }
 
 eBool eTfRecorder::isRecording() const
 {
-	return m_isRecording;
+	return m_isRecording.get() != 0;
+}
+
+void eTfRecorder::timerCallback()
+{
+	collect();
+}
+
+// moves the events from the rings to the recording and merges them
+// by time. events with the same time stay in the order they arrived,
+// so per synth they stay in the order they were played
+void eTfRecorder::collect()
+{
+	m_cs.enter();
+
+	for (eU32 i=0; i<TF_MAX_INSTR; i++)
+	{
+		Ring &ring = m_rings[i];
+		int start1, size1, start2, size2;
+
+		ring.fifo.prepareToRead(ring.fifo.getNumReady(), start1, size1, start2, size2);
+
+		for (int j=0; j<size1; j++)
+			insertEvent(ring.events[start1 + j]);
+
+		for (int j=0; j<size2; j++)
+			insertEvent(ring.events[start2 + j]);
+
+		ring.fifo.finishedRead(size1 + size2);
+	}
+
+	m_cs.exit();
+}
+
+// the rings are collected about in time already, so the
+// position is searched from the end of the recording
+void eTfRecorder::insertEvent(const eTfEvent &e)
+{
+	eU32 pos = m_events.size();
+
+	while (pos > 0 && m_events[pos-1].time > e.time)
+		pos--;
+
+	m_events.insert(pos, e);
 }
 
 eBool eTfRecorder::saveToFile(File &fileBin)
@@ -184,6 +235,7 @@ eBool eTfRecorder::saveToFile(File &fileBin)
     m_cs.enter();
 
 	// count stuff
+	eU16 tempo = static_cast<eU16>(m_tempo.get());
 	eU16 synthCount = 0;
 	eU16 eventCount[TF_MAX_INSTR];
 
@@ -201,14 +253,14 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 
 	// write header values
     outBin->write(reinterpret_cast<const char *>(&synthCount), sizeof(eU16));
-    outBin->write(reinterpret_cast<const char *>(&m_tempo), sizeof(eU16));
+    outBin->write(reinterpret_cast<const char *>(&tempo), sizeof(eU16));
 
     outJSON->writeText("var tf_synthcount = ", false, false, nullptr);
     outJSON->writeText(String(synthCount), false, false, nullptr);
     outJSON->writeText(";\r\n", false, false, nullptr);
 
     outJSON->writeText("var tf_tempo = ", false, false, nullptr);
-    outJSON->writeText(String(m_tempo), false, false, nullptr);
+    outJSON->writeText(String(tempo), false, false, nullptr);
     outJSON->writeText(";\r\n", false, false, nullptr);
 
 	outLog->writeText("Instruments: ", false, false, nullptr);
@@ -216,7 +268,7 @@ eBool eTfRecorder::saveToFile(File &fileBin)
     outLog->writeText("\r\n", false, false, nullptr);
 
     outLog->writeText("Tempo: ", false, false, nullptr);
-    outLog->writeText(String(m_tempo), false, false, nullptr);
+    outLog->writeText(String(tempo), false, false, nullptr);
     outLog->writeText("\r\n", false, false, nullptr);
 
 	for(eU32 i=0;i<TF_MAX_INSTR; i++) 
@@ -238,14 +290,19 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 
 	outBin->writeText("INST", false, false, nullptr);
 
-	// optimize instruments
+	// optimize instruments. the synths' own parameters belong to the
+	// audio thread, so the optimized ones are a copy
+	eF32 params[TF_MAX_INSTR][TF_PARAM_COUNT];
+
 	for(eU32 i=0;i<TF_MAX_INSTR; i++) 
 	{
         Tunefish4AudioProcessor *synth = m_synths[i];
 		if (synth != nullptr)
 		{
-            eTfSynth *tf = synth->getSynth();
-			optimizeParams(tf->instr[0]->params);
+			for(eU32 j=0; j<TF_PARAM_COUNT; j++)
+				params[i][j] = synth->getParameter(j);
+
+			optimizeParams(params[i]);
 		}
 	}
 
@@ -257,8 +314,6 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 
 		if (synth != nullptr)
 		{
-			eTfSynth *tf = synth->getSynth();
-
 			outLog->writeText("Params for instr ", false, false, nullptr);
             outLog->writeText(String(i), false, false, nullptr);
             outLog->writeText("\r\n", false, false, nullptr);
@@ -268,7 +323,7 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 
 			for(eU32 j=0; j<TF_PARAM_COUNT; j++)
 			{
-				eF32 value = tf->instr[0]->params[j];
+				eF32 value = params[i][j];
 				eU8 ivalue = static_cast<eU8>(value * 100.0f);
 
                 outLog->writeText(TF_NAMES[j], false, false, nullptr);
@@ -316,7 +371,7 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 
 	// calculate speed values
     const eU32 rows_per_beat = 4;
-	const eU32 rows_per_min = m_tempo * rows_per_beat;
+	const eU32 rows_per_min = tempo * rows_per_beat;
     const eF32 rows_per_sec = static_cast<eF32>(rows_per_min) / 60.0f;
 
     // write events
@@ -458,19 +513,28 @@ eBool eTfRecorder::saveToFile(File &fileBin)
 	return eTRUE;
 }
 
+// called on the audio thread, never waits or allocates. events that
+// don't fit into the ring anymore are lost
 void eTfRecorder::recordEvent(eTfEvent e)
 {
-	if (m_isRecording)
+	if (m_isRecording.get() && e.instr < TF_MAX_INSTR)
 	{
-		m_cs.enter();
-		m_events.push(e);
-		m_cs.exit();
+		Ring &ring = m_rings[e.instr];
+		int start1, size1, start2, size2;
+
+		ring.fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+		if (size1 > 0)
+		{
+			ring.events[start1] = e;
+			ring.fifo.finishedWrite(1);
+		}
 	}
 }
 
 void eTfRecorder::setTempo(eU16 tempo)
 {
-	m_tempo = tempo;
+	m_tempo.set(tempo);
 }
 
 eS32 eTfRecorder::addSynth(Tunefish4AudioProcessor *synth)
@@ -24,7 +24,11 @@ along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../PluginProcessor.h"
 
-class eTfRecorder 
+const eU32 TF_RECORDER_RINGSIZE = 4096;  // events per synth between two collects
+
+// the audio threads only push events into a ring per synth, the
+// message thread moves them over to the recording on a timer
+class eTfRecorder : private Timer
 {
 public:
 	eTfRecorder();
@@ -45,11 +49,24 @@ public:
 	void				        removeSynth(Tunefish4AudioProcessor *synth);
 
 private:
+    struct Ring
+    {
+        Ring() : fifo(TF_RECORDER_RINGSIZE) {}
+
+        AbstractFifo            fifo;
+        eTfEvent                events[TF_RECORDER_RINGSIZE];
+    };
+
+    void                        timerCallback() override;
+    void                        collect();
+    void                        insertEvent(const eTfEvent &e);
+
     CriticalSection             m_cs;
 	eArray<eTfEvent>	        m_events;
-	eU16				        m_tempo;
+	Atomic<int>			        m_tempo;
     Tunefish4AudioProcessor	*	m_synths[TF_MAX_INSTR];
-	eBool				        m_isRecording;
+	Atomic<int>			        m_isRecording;
+    Ring                        m_rings[TF_MAX_INSTR];
 
 	static eTfRecorder          m_recorder;
 };
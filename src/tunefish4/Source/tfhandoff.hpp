@@ -0,0 +1,83 @@
+/*
+ ---------------------------------------------------------------------
+ Tunefish 4  -  http://tunefish-synth.com
+ ---------------------------------------------------------------------
+ This file is part of Tunefish.
+
+ Tunefish is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Tunefish is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
+ ---------------------------------------------------------------------
+ */
+
+
+#ifndef TF_HANDOFF_HPP
+#define TF_HANDOFF_HPP
+
+#include "synth/tf4.hpp"
+
+#include <atomic>
+
+// hands the latest T from one writer thread to one reader thread
+// without either of them ever waiting. the writer fills getWrite()
+// and calls publish(), the reader calls update() and reads getRead()
+template <class T>
+class eTfTripleBuffer
+{
+public:
+    eTfTripleBuffer() : writeIndex(0), readIndex(1), middle(2)
+    {
+    }
+
+    T &                     getWrite()      { return slots[writeIndex]; }
+    T &                     getRead()       { return slots[readIndex]; }
+
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | FRESH) & INDEX;
+    }
+
+    // true if something new was published since the last call
+    bool update()
+    {
+        if (!(middle.load() & FRESH))
+            return false;
+
+        readIndex = middle.exchange(readIndex) & INDEX;
+        return true;
+    }
+
+private:
+    enum { INDEX = 3, FRESH = 4 };
+
+    T                       slots[3];
+    int                     writeIndex;
+    int                     readIndex;
+    std::atomic<int>        middle;
+};
+
+// a whole set of parameters, switched in at once
+struct eTfProgramParams
+{
+    eF32                    params[TF_PARAM_COUNT];
+};
+
+// the last triggered voice as of the end of the last block
+struct eTfVoiceSnapshot
+{
+    eBool                   valid;
+    eBool                   playing;
+    eTfModMatrix            modMatrix;
+    eF32                    modulation;
+};
+
+#endif
@@ -88,4 +88,6 @@ void eTfSynthProgram::applyToSynth(eTfInstrument* tf) const
 {
     for (int i = 0; i < TF_PARAM_COUNT; i++)
         tf->params[i] = getParam(i);
+
+    eTfInstrumentParamsChanged(*tf);
 }
@@ -0,0 +1,19 @@
+#!/bin/sh
+# builds the synth's micro benchmarks and the stress test of the
+# plugin's thread hand-offs on linux, next to the player. extra
+# compiler flags can be passed, the binaries end up in build/
+cd "$(dirname "$0")"
+
+SRC=../tunefish4/Source
+JUCE=../tunefish4/JuceLibraryCode
+FLAGS="-std=c++17 -O2 -DLINUX=1 -DNDEBUG $*"
+SYNTH="$SRC/runtime/runtime.cpp $SRC/runtime/random.cpp $SRC/runtime/array.cpp $SRC/runtime/simd.cpp $SRC/synth/tf4.cpp $SRC/synth/tf4fx.cpp"
+
+mkdir -p build
+
+g++ $FLAGS -I$SRC fftbench.cpp $SYNTH -lpthread -o build/fftbench || exit 1
+g++ $FLAGS -I$SRC unibench.cpp $SYNTH -lpthread -o build/unibench || exit 1
+g++ $FLAGS -I$SRC reverbbench.cpp $SYNTH -lpthread -o build/reverbbench || exit 1
+
+g++ $FLAGS -c -DJUCE_GLOBAL_MODULE_SETTINGS_INCLUDED=1 -DJUCE_USE_CURL=0 -I$JUCE/modules $JUCE/include_juce_core.cpp -o build/juce_core.o || exit 1
+g++ $FLAGS -DJUCE_GLOBAL_MODULE_SETTINGS_INCLUDED=1 -I$SRC -I$JUCE/modules stress.cpp $SYNTH build/juce_core.o -lpthread -ldl -lrt -o build/stress || exit 1
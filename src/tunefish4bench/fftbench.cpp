@@ -0,0 +1,223 @@
+/*
+---------------------------------------------------------------------
+Tunefish 4  -  http://tunefish-synth.com
+---------------------------------------------------------------------
+This file is part of Tunefish.
+
+Tunefish is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Tunefish is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
+---------------------------------------------------------------------
+*/
+
+// times eTfGeneratorIfft against the transform it replaced, the in-place
+// complex eTfGeneratorFft followed by eTfGeneratorNormalize, and checks
+// both outputs against a double precision dft of the same spectrum. the
+// old routine truncated log10(n)/log10(2) into its stage count, so it
+// skips the last stage at some sizes and deviates a lot there.
+
+#include "runtime/system.hpp"
+#include "synth/tf4.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+const eU32 SIZES[]      = { 256, 512, 1024, 2048 };
+const eU32 RUNS         = 5;
+const eU32 ITERATIONS   = 20000;
+
+static eTfFftPlan       plan;
+static eF32             spectrum[TF_FFT_MAXSIZE*2];
+static eF32             buffer[TF_FFT_MAXSIZE*2];
+static eF32             result[TF_FFT_MAXSIZE];
+static eF64             reference[TF_FFT_MAXSIZE];
+
+static eF64 now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// the old transform and normalization, as they were in tf4.cpp
+static void oldNormalize(eF32 *buffer, eU32 frameSize)
+{
+    eF32 max = 0.0;
+    eF32 *smp = buffer;
+    eU32 len = frameSize;
+
+    while(len--)
+    {
+        eF32 abs_smp = eAbs(*smp);
+        if (abs_smp > max) max = abs_smp;
+        smp += 2;
+    }
+
+    if (max<1e-5f) max=1e-5f;
+    max = 1.0f/max;
+    smp = buffer;
+    len = frameSize;
+
+    eF32 avg = 0.0f;
+    while(len--)
+    {
+        *smp *= max;
+        avg += *smp;
+        smp += 2;
+    }
+
+    avg /= frameSize;
+    smp = buffer;
+    len = frameSize;
+
+    while(len--)
+    {
+        *smp -= avg;
+        smp += 2;
+    }
+}
+
+static void oldFft(eInt sign, eU32 frameSize, eF32 *fftBuffer)
+{
+    eF32 wr, wi, arg, *p1, *p2, temp;
+    eF32 tr, ti, ur, ui, *p1r, *p1i, *p2r, *p2i;
+    eInt i, bitm, j, le, le2, k;
+    eF32 fsign = (eF32)sign;
+    eF32 sine, cosine;
+    eInt count = eFtoL(eLog10((eF32)frameSize)/eLog10(2.0f));
+
+    for (i = 2; i < (eInt)(2*frameSize-2); i += 2)
+    {
+        for (bitm = 2, j = 0; bitm < (eInt)(2*frameSize); bitm <<= 1)
+        {
+            if (i & bitm) j++;
+            j <<= 1;
+        }
+
+        if (i < j)
+        {
+            p1 = fftBuffer+i; p2 = fftBuffer+j;
+            temp = *p1; *(p1++) = *p2;
+            *(p2++) = temp; temp = *p1;
+            *p1 = *p2; *p2 = temp;
+        }
+    }
+    for (k = 0, le = 2; k < count; k++)
+    {
+        le <<= 1;
+        le2 = le>>1;
+        ur = 1.0;
+        ui = 0.0;
+        arg = ePI / (le2>>1);
+
+        eSinCos(arg, sine, cosine);
+        wr = cosine;
+        wi = fsign * sine;
+
+        for (j = 0; j < le2; j += 2)
+        {
+            p1r = fftBuffer+j; p1i = p1r+1;
+            p2r = p1r+le2; p2i = p2r+1;
+
+            for (i = j; i < (eInt)(2*frameSize); i += le)
+            {
+                tr = *p2r * ur - *p2i * ui;
+                ti = *p2r * ui + *p2i * ur;
+                *p2r = *p1r - tr; *p2i = *p1i - ti;
+                *p1r += tr; *p1i += ti;
+                p1r += le; p1i += le;
+                p2r += le; p2i += le;
+            }
+
+            tr = ur*wr - ui*wi;
+            ui = ur*wi + ui*wr;
+            ur = tr;
+        }
+    }
+}
+
+// real part of the inverse dft, normalized and centered like the generator does
+static void referenceIdft(eU32 size)
+{
+    eF64 max = 0.0;
+    for (eU32 n=0; n<size; n++)
+    {
+        eF64 sum = 0.0;
+        for (eU32 k=0; k<size; k++)
+        {
+            eF64 arg = 2.0 * 3.14159265358979323846 * (eF64)((k * n) % size) / size;
+            sum += spectrum[k*2] * cos(arg) - spectrum[k*2+1] * sin(arg);
+        }
+        reference[n] = sum;
+        max = eMax(max, fabs(sum));
+    }
+
+    eF64 avg = 0.0;
+    for (eU32 n=0; n<size; n++)
+    {
+        reference[n] /= max;
+        avg += reference[n];
+    }
+
+    avg /= size;
+    for (eU32 n=0; n<size; n++)
+        reference[n] -= avg;
+}
+
+int main()
+{
+    eRandom rand(1);
+
+    for (eU32 s=0; s<sizeof(SIZES)/sizeof(SIZES[0]); s++)
+    {
+        const eU32 size = SIZES[s];
+        eTfFftPlanInit(plan, size);
+
+        // a band limited spectrum falling off like the generator's
+        for (eU32 i=0; i<size*2; i++)
+            spectrum[i] = rand.NextFloat(-1.0f, 1.0f) / (1 + i/16);
+
+        eF64 oldTime = 1e30, newTime = 1e30;
+        for (eU32 r=0; r<RUNS; r++)
+        {
+            // the old transform worked in place, so it pays for the copy
+            eF64 start = now();
+            for (eU32 i=0; i<ITERATIONS; i++)
+            {
+                eMemCopy(buffer, spectrum, size*2*sizeof(eF32));
+                oldFft(1, size, buffer);
+                oldNormalize(buffer, size);
+            }
+            oldTime = eMin(oldTime, (now() - start) / ITERATIONS);
+
+            start = now();
+            for (eU32 i=0; i<ITERATIONS; i++)
+                eTfGeneratorIfft(plan, spectrum, result, 0.0f);
+            newTime = eMin(newTime, (now() - start) / ITERATIONS);
+        }
+
+        referenceIdft(size);
+
+        eF64 oldError = 0.0, newError = 0.0;
+        for (eU32 n=0; n<size; n++)
+        {
+            oldError = eMax(oldError, fabs(buffer[n*2] - reference[n]));
+            newError = eMax(newError, fabs(result[n] - reference[n]));
+        }
+
+        printf("%4u points: old %6.2f us (max error %.2g), new %6.2f us (max error %.2g)\n",
+               size, oldTime * 1e6, oldError, newTime * 1e6, newError);
+    }
+
+    return 0;
+}
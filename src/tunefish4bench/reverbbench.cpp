@@ -0,0 +1,404 @@
+/*
+---------------------------------------------------------------------
+Tunefish 4  -  http://tunefish-synth.com
+---------------------------------------------------------------------
+This file is part of Tunefish.
+
+Tunefish is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Tunefish is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
+---------------------------------------------------------------------
+*/
+
+// benchmarks the reverb against the serial comb filters it used to run,
+// kept here as the reference: eight calls of the pairwise comb kernel
+// into per comb output buffers, each mixed into the wet signal with
+// eTfSignalMix(). both are fed the same noise bursts in random block
+// sizes with the parameters changing now and then, and their outputs
+// have to be bit-identical. then both are timed in 64 sample blocks
+// like eTfInstrumentProcess() renders them and in 256 sample blocks.
+// all of it is done with the base kernels and with the ones picked
+// for this cpu.
+
+#include "runtime/system.hpp"
+#include "synth/tf4.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LEFT 0
+#define RIGHT 1
+
+const eU32 SAMPLES      = 20000 * 64;
+const eU32 RUNS         = 5;
+const eU32 BLOCKSIZES[] = { 64, 256 };
+const eU32 CHECK_BLOCKS = 3000;
+const eU32 CHECK_MAXLEN = 1500;
+
+// the reverb's tunings, see tf4fx.cpp
+const eF32 FIXEDGAIN    = 0.015f;
+const eF32 SCALEWET     = 3.0f;
+const eF32 SCALEDRY     = 2.0f;
+const eF32 SCALEDAMP    = 0.4f;
+const eF32 SCALEROOM    = 0.28f;
+const eF32 OFFSETROOM   = 0.7f;
+const eInt STEREOSPREAD = 23;
+
+const eInt COMBTUNINGS[]    = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+const eInt ALLPASSTUNINGS[] = { 556, 441, 341, 225 };
+
+struct OldReverb
+{
+    eTfComb     comb[2][TF_FX_REVERB_NUMCOMBS];
+    eTfAllpass  allpass[2][TF_FX_REVERB_NUMALLPASSES];
+    eF32        combBuffers[TF_FX_REVERB_NUMCOMBS*2*TF_MAXFRAMESIZE];
+    eF32        mixBuffers[TF_MAXFRAMESIZE*2];
+};
+
+static eTfSynth         synth;
+static eTfInstrument    instr;
+static OldReverb        oldReverb;
+static eF32             left[CHECK_MAXLEN];
+static eF32             right[CHECK_MAXLEN];
+static eF32             refLeft[CHECK_MAXLEN];
+static eF32             refRight[CHECK_MAXLEN];
+
+static eF64 now()
+{
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void fillNoise(eRandom &rand, eU32 len, eF32 level)
+{
+    for (eU32 i=0; i<len; i++)
+    {
+        left[i] = rand.NextFloat(-level, level);
+        right[i] = rand.NextFloat(-level, level);
+    }
+}
+
+static void oldCombProcessBase(eTfComb &comb1, eTfComb &comb2, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 **signals_out, eU32 len)
+{
+    eF32 *inputL = signals_in[LEFT];
+    eF32 *inputR = signals_in[RIGHT];
+    eF32 *outputL = signals_out[LEFT];
+    eF32 *outputR = signals_out[RIGHT];
+
+    eF32x2 damp2x2 = eSimdSetAll(damp2);
+    eF32x2 damp1x2 = eSimdSetAll(damp1);
+    eF32x2 feedbackx2 = eSimdSetAll(feedback);
+
+    while(len--)
+    {
+        eF32 input = (*inputL++ + *inputR++) * gain;
+        eF32x2 minput = eSimdSetAll(input);
+
+        eF32x2 output = eSimdSet2(comb1.buffer[comb1.bufidx], comb2.buffer[comb2.bufidx]);
+        eF32x2 filterstore = eSimdSet2(comb1.filterstore, comb2.filterstore);
+        filterstore = eSimdAdd(eSimdMul(output, damp2x2), eSimdMul(filterstore, damp1x2));
+
+        eF32x2 buffer = eSimdAdd(minput, eSimdMul(filterstore, feedbackx2));
+
+        eSimdStore2(buffer, comb1.buffer[comb1.bufidx], comb2.buffer[comb2.bufidx]);
+        eSimdStore2(filterstore, comb1.filterstore, comb2.filterstore);
+        eSimdStore2(output, *outputL++, *outputR++);
+
+        if (++comb1.bufidx >= comb1.bufsize) comb1.bufidx = 0;
+        if (++comb2.bufidx >= comb2.bufsize) comb2.bufidx = 0;
+    }
+}
+
+#ifdef eSIMD_DISPATCH
+
+static eSIMD_TARGET_AVX2 void oldCombProcessAvx2(eTfComb &comb1, eTfComb &comb2, eF32 damp1, eF32 damp2, eF32 feedback, eF32 gain, eF32 **signals_in, eF32 **signals_out, eU32 len)
+{
+    const eF32 *inputL = signals_in[LEFT];
+    const eF32 *inputR = signals_in[RIGHT];
+    eF32 *outputL = signals_out[LEFT];
+    eF32 *outputR = signals_out[RIGHT];
+
+    const __m128 damp1x2 = _mm_set1_ps(damp1);
+    const __m128 damp2x2 = _mm_set1_ps(damp2);
+    const __m128 feedbackx2 = _mm_set1_ps(feedback);
+    const __m128 gainx4 = _mm_set1_ps(gain);
+    __m128 filterstore = eSimdSet2(comb1.filterstore, comb2.filterstore);
+
+    eU32 i = 0;
+    while (i < len)
+    {
+        eU32 run = eMin<eU32>(len - i, eMin<eU32>(comb1.bufsize - comb1.bufidx, comb2.bufsize - comb2.bufidx));
+        eF32 *buffer1 = &comb1.buffer[comb1.bufidx];
+        eF32 *buffer2 = &comb2.buffer[comb2.bufidx];
+
+        for (eU32 j=0; j<run; j+=4)
+        {
+            eU32 count = eMin<eU32>(run - j, 4);
+            __m128 output[4];
+            __m128 buffer[4];
+            eF32 input[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+            for (eU32 n=0; n<count; n++)
+                input[n] = inputL[i+j+n] + inputR[i+j+n];
+            _mm_storeu_ps(input, _mm_mul_ps(_mm_loadu_ps(input), gainx4));
+
+            eSimdLoadStereo(&buffer1[j], &buffer2[j], count, output);
+
+            for (eU32 n=0; n<count; n++)
+                outputR[i+j+n] = buffer2[j+n];
+            for (eU32 n=0; n<count; n++)
+                outputL[i+j+n] = buffer1[j+n];
+
+            for (eU32 n=0; n<count; n++)
+            {
+                filterstore = _mm_fmadd_ps(output[n], damp2x2, _mm_mul_ps(filterstore, damp1x2));
+                buffer[n] = _mm_fmadd_ps(filterstore, feedbackx2, _mm_set1_ps(input[n]));
+            }
+
+            eSimdStoreStereo(buffer, count, &buffer1[j], &buffer2[j]);
+        }
+
+        comb1.bufidx += run;
+        comb2.bufidx += run;
+        if (comb1.bufidx >= comb1.bufsize) comb1.bufidx = 0;
+        if (comb2.bufidx >= comb2.bufsize) comb2.bufidx = 0;
+        i += run;
+    }
+
+    eSimdStore2(filterstore, comb1.filterstore, comb2.filterstore);
+}
+
+#endif
+
+static void oldReverbInit(OldReverb &reverb)
+{
+    eMemSet(&reverb, 0, sizeof(OldReverb));
+
+    for (eU32 i=0; i<TF_FX_REVERB_NUMCOMBS; i++)
+    {
+        eTfCombInit(reverb.comb[LEFT][i], COMBTUNINGS[i]);
+        eTfCombInit(reverb.comb[RIGHT][i], COMBTUNINGS[i]);
+    }
+
+    for (eU32 i=0; i<TF_FX_REVERB_NUMALLPASSES; i++)
+    {
+        eTfAllpassInit(reverb.allpass[LEFT][i], ALLPASSTUNINGS[i]);
+        eTfAllpassInit(reverb.allpass[RIGHT][i], ALLPASSTUNINGS[i] + STEREOSPREAD);
+    }
+}
+
+// the reverb as eTfEffectReverbProcess() used to run it, with the comb
+// kernel the old dispatch picked for the isa
+static void oldReverbProcess(OldReverb &reverb, eSimdIsa isa, eF32 **signal, eU32 len)
+{
+    eF32 roomsize          = instr.params[TF_REVERB_ROOMSIZE] * SCALEROOM + OFFSETROOM;
+    eF32 damp              = instr.params[TF_REVERB_DAMP] * SCALEDAMP;
+    eF32 wet               = instr.params[TF_REVERB_WET] * SCALEWET;
+    eF32 dry               = (1.0f - instr.params[TF_REVERB_WET]) * SCALEDRY;
+    eF32 width             = instr.params[TF_REVERB_WIDTH];
+    eF32 wet1              = wet * (width / 2.0f + 0.5f);
+    eF32 wet2              = wet * ((1.0f - width) / 2.0f);
+    eF32 dry0              = dry;
+    eF32 cmbFeedback       = roomsize;
+    eF32 apsFeedback       = 0.5f;
+    eF32 damp1             = damp;
+    eF32 gain              = FIXEDGAIN;
+    eF32 damp2             = 1.0f - damp;
+
+    if (len == 0 || len > TF_MAXFRAMESIZE)
+        return;
+
+    void (*combProcess)(eTfComb &, eTfComb &, eF32, eF32, eF32, eF32, eF32 **, eF32 **, eU32) = oldCombProcessBase;
+#ifdef eSIMD_DISPATCH
+    if (isa >= eSIMD_ISA_AVX2)
+        combProcess = oldCombProcessAvx2;
+#endif
+
+    eF32 *signals_mix[2];
+    signals_mix[LEFT] = &reverb.mixBuffers[0];
+    signals_mix[RIGHT] = &reverb.mixBuffers[TF_MAXFRAMESIZE];
+    eMemSet(signals_mix[LEFT], 0, sizeof(eF32)*len);
+    eMemSet(signals_mix[RIGHT], 0, sizeof(eF32)*len);
+
+    for (eU32 i=0; i<TF_FX_REVERB_NUMCOMBS; i++)
+    {
+        eF32 *signals_out[2];
+        signals_out[LEFT] = &reverb.combBuffers[TF_MAXFRAMESIZE * 2 * i];
+        signals_out[RIGHT] = &reverb.combBuffers[TF_MAXFRAMESIZE * 2 * i + 1];
+        combProcess(reverb.comb[LEFT][i], reverb.comb[RIGHT][i], damp1, damp2, cmbFeedback, gain, signal, signals_out, len);
+
+        const eTfComb &comb = reverb.comb[LEFT][i];
+        signals_out[RIGHT][len-1] = comb.buffer[comb.bufidx];
+
+        eTfSignalMix(signals_mix, signals_out, len, 0.5f);
+    }
+
+    for (eU32 i=0; i<TF_FX_REVERB_NUMALLPASSES; i++)
+        eTfAllpassProcess(reverb.allpass[LEFT][i], reverb.allpass[RIGHT][i], apsFeedback, signals_mix, signals_mix, len);
+
+    eF32x2 wet1x2 = eSimdSetAll(wet1);
+    eF32x2 wet2x2 = eSimdSetAll(wet2);
+    eF32x2 dry0x2 = eSimdSetAll(dry0);
+
+    eF32 *dryL = signal[LEFT];
+    eF32 *dryR = signal[RIGHT];
+    eF32 *wetL = signals_mix[LEFT];
+    eF32 *wetR = signals_mix[RIGHT];
+
+    while(len--)
+    {
+        eF32x2 in = eSimdSet2(*dryL, *dryR);
+        eF32x2 lwet1 = eSimdSet2(*wetL, *wetR);
+        eF32x2 lwet2 = eSimdSet2(*wetR++, *wetL++);
+
+        eF32x2 out = eSimdAdd(
+                eSimdAdd(
+                    eSimdMul(lwet1, wet1x2),
+                    eSimdMul(lwet2, wet2x2)),
+                eSimdMul(in, dry0x2));
+
+        eSimdStore2(out, *dryL++, *dryR++);
+    }
+}
+
+static void setParams(eRandom &rand)
+{
+    instr.params[TF_REVERB_ROOMSIZE] = rand.NextFloat(0.0f, 1.0f);
+    instr.params[TF_REVERB_DAMP] = rand.NextFloat(0.0f, 1.0f);
+    instr.params[TF_REVERB_WET] = rand.NextFloat(0.0f, 1.0f);
+    instr.params[TF_REVERB_WIDTH] = rand.NextFloat(0.0f, 1.0f);
+}
+
+// short noise bursts followed by the tails in blocks of random size,
+// returns false if any output sample differs from the reference
+static eBool compare(eSimdIsa isa)
+{
+    eTfEffect *fx = eTfEffectReverbCreate(44100);
+    oldReverbInit(oldReverb);
+    eRandom rand(7);
+
+    eF32 *signal[2] = { left, right };
+    eF32 *refSignal[2] = { refLeft, refRight };
+
+    for (eU32 b=0; b<CHECK_BLOCKS; b++)
+    {
+        if (b % 100 == 0)
+            setParams(rand);
+
+        const eU32 len = 1 + rand.NextInt(0, CHECK_MAXLEN-1);
+        fillNoise(rand, len, (b % 50 < 8) ? 1.0f : 0.0f);
+        eMemCopy(refLeft, left, len*sizeof(eF32));
+        eMemCopy(refRight, right, len*sizeof(eF32));
+
+        eTfEffectReverbProcess(fx, synth, instr, signal, len);
+        oldReverbProcess(oldReverb, isa, refSignal, len);
+
+        if (memcmp(left, refLeft, len*sizeof(eF32)) != 0 || memcmp(right, refRight, len*sizeof(eF32)) != 0)
+        {
+            printf("output differs from the serial combs in block %u\n", b);
+            eTfEffectReverbDelete(fx);
+            return eFALSE;
+        }
+    }
+
+    eTfEffectReverbDelete(fx);
+    return eTRUE;
+}
+
+static eF64 timeNew(eU32 blockSize)
+{
+    eTfEffect *fx = eTfEffectReverbCreate(44100);
+    eF32 *signal[2] = { left, right };
+    eRandom rand(3);
+    eF64 best = 1e30;
+
+    for (eU32 r=0; r<RUNS; r++)
+    {
+        eF64 start = now();
+        for (eU32 b=0; b<SAMPLES/blockSize; b++)
+        {
+            fillNoise(rand, blockSize, 0.1f);
+            eTfEffectReverbProcess(fx, synth, instr, signal, blockSize);
+        }
+        best = eMin(best, (now() - start) / SAMPLES);
+    }
+
+    eTfEffectReverbDelete(fx);
+    return best;
+}
+
+static eF64 timeOld(eSimdIsa isa, eU32 blockSize)
+{
+    eF32 *signal[2] = { left, right };
+    eRandom rand(3);
+    eF64 best = 1e30;
+
+    oldReverbInit(oldReverb);
+
+    for (eU32 r=0; r<RUNS; r++)
+    {
+        eF64 start = now();
+        for (eU32 b=0; b<SAMPLES/blockSize; b++)
+        {
+            fillNoise(rand, blockSize, 0.1f);
+            oldReverbProcess(oldReverb, isa, signal, blockSize);
+        }
+        best = eMin(best, (now() - start) / SAMPLES);
+    }
+
+    return best;
+}
+
+static eBool benchmark(eSimdIsa isa, const char *name)
+{
+    eTfKernelsInit(isa);
+
+    if (!compare(isa))
+        return eFALSE;
+
+    printf("%-6s bit-identical to the serial combs\n", name);
+
+    instr.params[TF_REVERB_ROOMSIZE] = 0.8f;
+    instr.params[TF_REVERB_DAMP] = 0.5f;
+    instr.params[TF_REVERB_WET] = 0.5f;
+    instr.params[TF_REVERB_WIDTH] = 1.0f;
+
+    for (eU32 k=0; k<sizeof(BLOCKSIZES)/sizeof(BLOCKSIZES[0]); k++)
+    {
+        const eU32 blockSize = BLOCKSIZES[k];
+        const eF64 oldTime = timeOld(isa, blockSize);
+        const eF64 newTime = timeNew(blockSize);
+
+        printf("%-6s blocks of %3u: serial combs %.2f ns, comb bank %.2f ns per sample (%.2fx)\n",
+               name, blockSize, oldTime * 1e9, newTime * 1e9, oldTime / newTime);
+    }
+
+    return eTRUE;
+}
+
+int main()
+{
+    eTfSynthInit(synth);
+    synth.sampleRate = 44100;
+    eTfInstrumentInit(instr);
+
+    const eSimdIsa isa = eSimdGetIsa();
+    eBool ok = benchmark(eSIMD_ISA_BASE, "base");
+
+    if (ok && isa != eSIMD_ISA_BASE)
+        ok = benchmark(isa, (isa == eSIMD_ISA_AVX2) ? "avx2" : "avx512");
+
+    eTfInstrumentFree(instr);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+/*
+---------------------------------------------------------------------
+Tunefish 4  -  http://tunefish-synth.com
+---------------------------------------------------------------------
+This file is part of Tunefish.
+
+Tunefish is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Tunefish is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
+---------------------------------------------------------------------
+*/
+
+// stress test of the plugin's hand-offs between threads. an audio thread
+// renders 256 sample blocks at the host's pace, the way processBlock()
+// does, while other threads switch programs, change parameters, copy
+// the voice snapshot like the editor and drain the recorder's ring.
+// the audio thread never waits for any of them, so the block times
+// under stress should stay close to the ones of the audio thread alone.
+
+#include <juce_core/juce_core.h>
+#include "runtime/system.hpp"
+#include "tfhandoff.hpp"
+#include "factorypatches.hpp"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+using namespace juce;
+
+const eU32 BLOCKSIZE        = 256;
+const eU32 BLOCKS           = 5000;
+const eU32 WARMUP_BLOCKS    = 200;
+const eU32 RINGSIZE         = 4096;
+const long BLOCK_NS         = 5804988;  // 256 samples at 44.1 kHz
+
+static eTfSynth                             synth;
+static eTfInstrument *                      instr;
+static std::atomic<bool>                    quit(false);
+
+// the processor's parameter and program state
+static Atomic<float>                        paramValues[TF_PARAM_COUNT];
+static Atomic<int>                          paramPending[TF_PARAM_COUNT];
+static Atomic<int>                          paramsPending;
+static eTfTripleBuffer<eTfProgramParams>    programSwap;
+static eTfTripleBuffer<eTfVoiceSnapshot>    voiceSnapshot;
+
+// the recorder's ring and what it collects on the message thread
+static AbstractFifo                         recorderFifo(RINGSIZE);
+static eTfEvent                             recorderRing[RINGSIZE];
+static CriticalSection                      recorderCs;
+static eArray<eTfEvent>                     recorderEvents;
+
+static std::vector<double>                  blockTimes;
+
+static double now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void applyParameterChanges()
+{
+    eBool changed = eFALSE;
+
+    if (programSwap.update())
+    {
+        eMemCopy(instr->params, programSwap.getRead().params, sizeof(instr->params));
+        changed = eTRUE;
+    }
+
+    if (paramsPending.exchange(0))
+    {
+        for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+        {
+            if (paramPending[i].exchange(0))
+            {
+                instr->params[i] = paramValues[i].get();
+                changed = eTRUE;
+            }
+        }
+    }
+
+    if (changed)
+        eTfInstrumentParamsChanged(*instr);
+}
+
+static void recordEvent(const eTfEvent &event)
+{
+    int start1, size1, start2, size2;
+    recorderFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+    {
+        recorderRing[start1] = event;
+        recorderFifo.finishedWrite(1);
+    }
+}
+
+static void publishVoiceSnapshot()
+{
+    eTfVoiceSnapshot &snapshot = voiceSnapshot.getWrite();
+    const eTfVoice *voice = instr->latestTriggeredVoice;
+
+    snapshot.valid = (voice != nullptr);
+    if (voice)
+    {
+        snapshot.playing = voice->playing;
+        snapshot.modMatrix = voice->modMatrix;
+        snapshot.modulation = voice->generator.modulation;
+    }
+
+    voiceSnapshot.publish();
+}
+
+static void audioThread(eU32 blocks, double &mean, double &worst)
+{
+    static eF32 left[BLOCKSIZE], right[BLOCKSIZE];
+    eF32 *outputs[2] = { left, right };
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    double sum = 0.0;
+    worst = 0.0;
+
+    for (eU32 b=0; b<blocks; b++)
+    {
+        next.tv_nsec += BLOCK_NS;
+        if (next.tv_nsec >= 1000000000)
+        {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        double start = now();
+
+        applyParameterChanges();
+
+        // four notes per block, every 64 samples
+        eTfInstrumentEvent events[4];
+        for (eU32 k=0; k<4; k++)
+        {
+            eTfInstrumentEvent &event = events[k];
+            event.offset = k * 64;
+            event.type = ((b + k) % 2) ? eTfInstrumentEvent::NOTE_ON : eTfInstrumentEvent::NOTE_OFF;
+            event.index = 40 + (b * 7 + k * 5) % 40;
+            event.velocity = 100;
+            event.value = event.value2 = 0.0f;
+
+            eU8 velocity = (event.type == eTfInstrumentEvent::NOTE_ON) ? 100 : 0;
+            recordEvent(eTfEvent(b * 0.0058f, 0, static_cast<eU8>(event.index), velocity));
+        }
+
+        eMemSet(left, 0, sizeof(left));
+        eMemSet(right, 0, sizeof(right));
+        eTfInstrumentProcess(synth, *instr, outputs, BLOCKSIZE, events, 4);
+        publishVoiceSnapshot();
+
+        double time = now() - start;
+        blockTimes.push_back(time);
+        sum += time;
+        worst = eMax(worst, time);
+    }
+
+    mean = sum / blocks;
+}
+
+// program switches and storms of parameter changes, as
+// they come from the host and the editor
+static void programThread()
+{
+    eU32 program = 0;
+
+    while (!quit)
+    {
+        program = (program + 1) % TF_FACTORY_PATCH_COUNT;
+
+        eTfProgramParams &params = programSwap.getWrite();
+        for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+        {
+            params.params[i] = static_cast<eF32>(TF_FACTORY_PATCHES[program][i]);
+            paramValues[i].set(params.params[i]);
+        }
+        programSwap.publish();
+
+        for (eU32 k=0; k<50; k++)
+        {
+            eU32 i = (program * 13 + k) % TF_PARAM_COUNT;
+            paramValues[i].set(static_cast<eF32>(TF_FACTORY_PATCHES[program][i]));
+            paramPending[i].set(1);
+            paramsPending.set(1);
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+// editor repaints copying the voice
+static void editorThread()
+{
+    static eTfVoice voice;
+
+    while (!quit)
+    {
+        voiceSnapshot.update();
+        if (voiceSnapshot.getRead().valid)
+            voice.modMatrix = voiceSnapshot.getRead().modMatrix;
+
+        for (volatile eU32 k=0; k<20000; k++);
+        std::this_thread::yield();
+    }
+}
+
+// the recorder collecting the rings and saving
+static void recorderThread()
+{
+    while (!quit)
+    {
+        int start1, size1, start2, size2;
+        recorderFifo.prepareToRead(recorderFifo.getNumReady(), start1, size1, start2, size2);
+
+        {
+            const ScopedLock lock(recorderCs);
+
+            for (int i=0; i<size1; i++)
+                recorderEvents.push(recorderRing[start1 + i]);
+            for (int i=0; i<size2; i++)
+                recorderEvents.push(recorderRing[start2 + i]);
+
+            recorderFifo.finishedRead(size1 + size2);
+
+            for (volatile eU32 k=0; k<200000; k++);
+            if (recorderEvents.size() > 100000)
+                recorderEvents.clear();
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+int main()
+{
+    eTfSynthInit(synth);
+    synth.sampleRate = 44100;
+
+    instr = new eTfInstrument();
+    eTfInstrumentInit(*instr);
+
+    for (eU32 i=0; i<TF_PARAM_COUNT; i++)
+        instr->params[i] = static_cast<eF32>(TF_FACTORY_PATCHES[3][i]);
+    eTfInstrumentParamsChanged(*instr);
+
+    double mean, worst;
+    audioThread(WARMUP_BLOCKS, mean, worst);
+    printf("alone:    mean %.1f us, worst %.1f us\n", mean * 1e6, worst * 1e6);
+    blockTimes.clear();
+
+    std::thread program(programThread);
+    std::thread editor(editorThread);
+    std::thread recorder(recorderThread);
+
+    std::thread audio([&]
+    {
+        sched_param sp;
+        sp.sched_priority = 80;
+        int realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0);
+
+        audioThread(BLOCKS, mean, worst);
+
+        std::sort(blockTimes.begin(), blockTimes.end());
+        eU32 late = 0;
+        for (double time : blockTimes)
+            late += (time > 0.002);
+
+        printf("stressed: mean %.1f us, p99 %.1f us, p99.9 %.1f us, worst %.1f us, %u blocks over 2 ms (realtime %d)\n",
+               mean * 1e6, blockTimes[blockTimes.size()*99/100] * 1e6, blockTimes[blockTimes.size()*999/1000] * 1e6,
+               worst * 1e6, late, realtime);
+    });
+
+    audio.join();
+    quit = true;
+    program.join();
+    editor.join();
+    recorder.join();
+
+    eTfInstrumentFree(*instr);
+    eDelete(instr);
+    return 0;
+}
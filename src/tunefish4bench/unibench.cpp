@@ -0,0 +1,341 @@
+/*
+---------------------------------------------------------------------
+Tunefish 4  -  http://tunefish-synth.com
+---------------------------------------------------------------------
+This file is part of Tunefish.
+
+Tunefish is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Tunefish is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
+---------------------------------------------------------------------
+*/
+
+// benchmarks the unison oscillators with the first 100 factory patches
+// which have six or more unison voices, four notes held for two seconds
+// in 512 sample blocks. the oscillators alone are timed with the scalar
+// loop eTfGeneratorProcess() used to run once per unison voice, kept
+// here as the reference, and with the bank of eTfGeneratorRead(). then
+// the whole instrument is timed with the same patches and notes.
+
+#include "runtime/system.hpp"
+#include "synth/tf4.hpp"
+#include "factorypatches.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+const eU32 BLOCKSIZE    = 512;
+const eU32 BLOCKS       = 172;  // 2 s at 44.1 kHz
+const eU32 MIN_UNISONO  = 6;
+const eU32 MAX_PATCHES  = 100;
+const eU32 NOTES[]      = { 48, 55, 60, 64 };
+const eU32 NOTE_COUNT   = sizeof(NOTES) / sizeof(NOTES[0]);
+const eF32 VOLUME       = 0.1f;
+
+static eALIGN16 const eF32 LANEINDEX[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+static eTfSynth         synth;
+static eF32             waveTable[TF_WAVETABLE_MIPSIZE];
+static eALIGN16 eF32    left[BLOCKSIZE];
+static eALIGN16 eF32    right[BLOCKSIZE];
+static eALIGN16 eF32    refLeft[BLOCKSIZE];
+static eALIGN16 eF32    refRight[BLOCKSIZE];
+
+static eF64 now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// band limited saws, one per mip level
+static void makeWaveTable()
+{
+    for (eU32 level=0; level<TF_WAVETABLE_MIPLEVELS; level++)
+    {
+        eF32 *table = waveTable + TF_WAVETABLE_MIPOFFSET[level];
+        const eU32 len = TF_WAVETABLE_MIPLENGTH[level];
+
+        for (eU32 i=0; i<len; i++)
+        {
+            eF64 sum = 0.0;
+            for (eU32 h=1; h<len/2; h++)
+                sum += sin(2.0 * 3.14159265358979323846 * (eF64)((h * i) % len) / len) / h;
+            table[i] = static_cast<eF32>(sum * 0.55);
+        }
+    }
+}
+
+static eU32 phaseToFixed(eF32 phase)
+{
+    phase -= (eF32)eFtoL(phase);
+    return (eU32)eFtoL(phase * 2147483648.0f) << 1;
+}
+
+// the oscillators of one voice as eTfGeneratorProcess() used to run
+// them, one pass over the block per unison voice with float phases
+static void oldUnisonProcess(eF32 *phases, eF32 freq1, eF32 freq2, eF32 spread, eU32 unisono, eF32 drive, eF32 **signal, eU32 frameSize)
+{
+    eF32x4 mdrive = eSimdSetAll4(drive);
+    eF32x4 mmin = eSimdSetAll4(-1.0f);
+    eF32x4 mmax = eSimdSetAll4(1.0f);
+    eF32x4 mlane = eSimdLoad(LANEINDEX);
+    eF32x4 mvol = eSimdSetAll4(VOLUME);
+
+    for (eU32 j=0; j<unisono; j++)
+    {
+        eF32 *sig1 = signal[0];
+        eF32 *sig2 = signal[1];
+        eF32 *phase1 = &phases[j*2];
+        eF32 *phase2 = &phases[j*2+1];
+
+        if (freq1 < 0.0f) freq1 *= -1.0f;
+        if (freq2 < 0.0f) freq2 *= -1.0f;
+
+        eF32 maxFreq = eMax(freq1, freq2);
+        eU32 level = 0;
+        while (level < TF_WAVETABLE_MIPLEVELS-1 && (eF32)((TF_IFFT_FRAMESIZE/2) >> level) * maxFreq > 0.5f)
+            level++;
+
+        const eF32 *table = waveTable + TF_WAVETABLE_MIPOFFSET[level];
+        eU32 tableMask = TF_WAVETABLE_MIPLENGTH[level] - 1;
+        eF32 tableSize = (eF32)TF_WAVETABLE_MIPLENGTH[level];
+
+        eF32x4 mtableSize = eSimdSetAll4(tableSize);
+        eF32x4 mfreq1 = eSimdSetAll4(freq1);
+        eF32x4 mfreq2 = eSimdSetAll4(freq2);
+
+        eU32 len = frameSize;
+        for (; len>=4; len-=4)
+        {
+            eF32x4 p1 = eSimdFma(eSimdSetAll4(*phase1), mlane, mfreq1);
+            eF32x4 p2 = eSimdFma(eSimdSetAll4(*phase2), mlane, mfreq2);
+            eF32x4 pos1 = eSimdMul(eSimdSub(p1, eSimdFloor(p1)), mtableSize);
+            eF32x4 pos2 = eSimdMul(eSimdSub(p2, eSimdFloor(p2)), mtableSize);
+            eF32x4 off1 = eSimdFloor(pos1);
+            eF32x4 off2 = eSimdFloor(pos2);
+
+            eALIGN16 eF32 offs[8];
+            eALIGN16 eF32 vals[16];
+            eSimdStore(off1, &offs[0]);
+            eSimdStore(off2, &offs[4]);
+
+            for (eU32 k=0; k<8; k++)
+            {
+                eU32 off = eFtoL(offs[k]) & tableMask;
+                vals[k] = table[off];
+                vals[k+8] = table[(off+1) & tableMask];
+            }
+
+            eF32x4 val1 = eSimdLoad(&vals[0]);
+            eF32x4 val2 = eSimdLoad(&vals[4]);
+            val1 = eSimdFma(val1, eSimdSub(eSimdLoad(&vals[8]), val1), eSimdSub(pos1, off1));
+            val2 = eSimdFma(val2, eSimdSub(eSimdLoad(&vals[12]), val2), eSimdSub(pos2, off2));
+
+            val1 = eSimdMul(eSimdMax(eSimdMin(eSimdMul(val1, mdrive), mmax), mmin), mvol);
+            val2 = eSimdMul(eSimdMax(eSimdMin(eSimdMul(val2, mdrive), mmax), mmin), mvol);
+
+            eSimdStore(eSimdAdd(eSimdLoad(sig1), val1), sig1);
+            eSimdStore(eSimdAdd(eSimdLoad(sig2), val2), sig2);
+            sig1 += 4;
+            sig2 += 4;
+
+            *phase1 += freq1 * 4.0f;
+            while (*phase1 >= 1.0f) { *phase1 -= 1.0f; }
+
+            *phase2 += freq2 * 4.0f;
+            while (*phase2 >= 1.0f) { *phase2 -= 1.0f; }
+        }
+
+        while (len--)
+        {
+            eF32 pos1 = *phase1 * tableSize;
+            eF32 pos2 = *phase2 * tableSize;
+            eU32 off1 = eFtoL(pos1);
+            eU32 off2 = eFtoL(pos2);
+            eF32 frac1 = pos1 - (eF32)off1;
+            eF32 frac2 = pos2 - (eF32)off2;
+
+            off1 &= tableMask;
+            off2 &= tableMask;
+
+            eF32 val1 = eLerp(table[off1], table[(off1+1) & tableMask], frac1);
+            eF32 val2 = eLerp(table[off2], table[(off2+1) & tableMask], frac2);
+
+            *sig1++ += eClamp(-1.0f, val1 * drive, 1.0f) * VOLUME;
+            *sig2++ += eClamp(-1.0f, val2 * drive, 1.0f) * VOLUME;
+
+            *phase1 += freq1;
+            while (*phase1 >= 1.0f) { *phase1 -= 1.0f; }
+
+            *phase2 += freq2;
+            while (*phase2 >= 1.0f) { *phase2 -= 1.0f; }
+        }
+
+        freq1 += spread;
+        freq2 -= spread;
+    }
+}
+
+// the oscillators of one voice set up like eTfGeneratorProcess() does
+struct Voice
+{
+    eF32                freq1;
+    eF32                freq2;
+    eF32                phases[2*TF_MAXUNISONO];
+    eALIGN16 eU32       phase[TF_UNISONO_LANES];
+    eALIGN16 eU32       incs[TF_UNISONO_LANES];
+    eALIGN16 eF32       lanesOn[TF_UNISONO_LANES];
+    eTfGeneratorBank    bank;
+};
+
+static void voiceInit(Voice &voice, eRandom &rand, eF32 freq, eF32 detune, eF32 spread, eU32 unisono, eF32 drive)
+{
+    voice.freq1 = (freq + detune) / synth.sampleRate;
+    voice.freq2 = (freq - detune) / synth.sampleRate;
+    eF32 maxFreq = 0.0f;
+
+    for (eU32 j=2*TF_MAXUNISONO; j<TF_UNISONO_LANES; j++)
+    {
+        voice.phase[j] = voice.incs[j] = 0;
+        voice.lanesOn[j] = 0.0f;
+    }
+
+    for (eU32 j=0; j<TF_MAXUNISONO; j++)
+    {
+        eF32 base = rand.NextFloat();
+        eF32 off = rand.NextFloat()*0.1f;
+        voice.phases[j*2] = base;
+        voice.phases[j*2+1] = base+off;
+        voice.phase[j*2] = phaseToFixed(base);
+        voice.phase[j*2+1] = phaseToFixed(base+off);
+
+        eF32 freq1 = eAbs(voice.freq1 + spread * (eF32)j);
+        eF32 freq2 = eAbs(voice.freq2 - spread * (eF32)j);
+        eBool on = (j < unisono);
+
+        if (on)
+            maxFreq = eMax(maxFreq, eMax(freq1, freq2));
+
+        voice.incs[j*2] = on ? phaseToFixed(freq1) : 0;
+        voice.incs[j*2+1] = on ? phaseToFixed(freq2) : 0;
+        voice.lanesOn[j*2] = voice.lanesOn[j*2+1] = on ? 1.0f : 0.0f;
+    }
+
+    eU32 level = 0;
+    while (level < TF_WAVETABLE_MIPLEVELS-1 && (eF32)((TF_IFFT_FRAMESIZE/2) >> level) * maxFreq > 0.5f)
+        level++;
+
+    eU32 tableBits = 0;
+    while ((1U << tableBits) < TF_WAVETABLE_MIPLENGTH[level])
+        tableBits++;
+
+    eTfGeneratorBank &bank = voice.bank;
+    bank.phase = voice.phase;
+    bank.incs = voice.incs;
+    bank.lanesOn = voice.lanesOn;
+    bank.lanes = unisono*2;
+    bank.table = waveTable + TF_WAVETABLE_MIPOFFSET[level];
+    bank.tableBits = tableBits;
+    bank.drive = drive;
+    bank.volL = bank.volR = VOLUME;
+    bank.volStepL = bank.volStepR = 0.0f;
+}
+
+int main()
+{
+    eTfSynthInit(synth);
+    synth.sampleRate = 44100;
+    makeWaveTable();
+
+    eF32 *outputs[2] = { left, right };
+    eF32 *refOutputs[2] = { refLeft, refRight };
+    eF64 oldTime = 0.0, newTime = 0.0, instrTime = 0.0;
+    eF64 signal = 0.0, noise = 0.0;
+    eU32 patches = 0;
+    eRandom rand(1);
+
+    static Voice voices[NOTE_COUNT];
+
+    for (eU32 p=0; p<TF_FACTORY_PATCH_COUNT && patches<MAX_PATCHES; p++)
+    {
+        const double *patch = TF_FACTORY_PATCHES[p];
+        eU32 unisono = eFtoL(eRoundNearest((eF32)patch[TF_GEN_UNISONO] * (TF_MAXUNISONO-1))) + 1;
+
+        if (unisono < MIN_UNISONO || patch[TF_GEN_VOLUME] <= 0.0)
+            continue;
+
+        // the oscillators alone, scaled like eTfGeneratorProcess() does
+        eF32 detune = ePow((eF32)patch[TF_GEN_DETUNE], 3.0f) * 10.0f;
+        eF32 spread = ePow((eF32)patch[TF_GEN_SPREAD], 4.0f) / static_cast<eF32>(synth.sampleRate) * 10.0f;
+        eF32 drive = (eF32)patch[TF_GEN_DRIVE] * 32.0f + 1.0f;
+
+        for (eU32 n=0; n<NOTE_COUNT; n++)
+            voiceInit(voices[n], rand, synth.freqTable[NOTES[n]], detune, spread, unisono, drive);
+
+        for (eU32 b=0; b<BLOCKS; b++)
+        {
+            eMemSet(refLeft, 0, sizeof(refLeft));
+            eMemSet(refRight, 0, sizeof(refRight));
+            eMemSet(left, 0, sizeof(left));
+            eMemSet(right, 0, sizeof(right));
+
+            eF64 start = now();
+            for (eU32 n=0; n<NOTE_COUNT; n++)
+                oldUnisonProcess(voices[n].phases, voices[n].freq1, voices[n].freq2, spread, unisono, drive, refOutputs, BLOCKSIZE);
+            oldTime += now() - start;
+
+            start = now();
+            for (eU32 n=0; n<NOTE_COUNT; n++)
+                eTfGeneratorRead(voices[n].bank, outputs, BLOCKSIZE);
+            newTime += now() - start;
+
+            for (eU32 i=0; i<BLOCKSIZE; i++)
+            {
+                signal += refLeft[i] * refLeft[i] + refRight[i] * refRight[i];
+                noise += (left[i] - refLeft[i]) * (left[i] - refLeft[i]) + (right[i] - refRight[i]) * (right[i] - refRight[i]);
+            }
+        }
+
+        // the whole instrument
+        eTfInstrument *instr = new eTfInstrument();
+        eTfInstrumentInit(*instr);
+
+        for (eU32 i=0; i<TF_PARAM_COUNT && i<TF_FACTORY_PATCH_PARAMCOUNT; i++)
+            instr->params[i] = static_cast<eF32>(patch[i]);
+        eTfInstrumentParamsChanged(*instr);
+
+        for (eU32 n=0; n<NOTE_COUNT; n++)
+            eTfInstrumentNoteOn(*instr, NOTES[n], 100);
+
+        eF64 start = now();
+        for (eU32 b=0; b<BLOCKS; b++)
+        {
+            eMemSet(left, 0, sizeof(left));
+            eMemSet(right, 0, sizeof(right));
+            eTfInstrumentProcess(synth, *instr, outputs, BLOCKSIZE);
+        }
+        instrTime += now() - start;
+        patches++;
+
+        eTfInstrumentFree(*instr);
+        eDelete(instr);
+    }
+
+    printf("%u patches with %u+ unison voices, 4 notes for 2 s each, per patch:\n", patches, MIN_UNISONO);
+    printf("  oscillators: scalar loop %.2f ms, bank %.2f ms (%.2fx), %.1f dB snr\n",
+           oldTime * 1e3 / patches, newTime * 1e3 / patches, oldTime / newTime, 10.0 * log10(signal / noise));
+    printf("  instrument:  %.2f ms\n", instrTime * 1e3 / patches);
+
+    return 0;
+}
@@ -101,6 +101,8 @@ void eTfPlayerLoadSong(eTfPlayer &player, const eU8 *data, eU32 len, eF32 delay)
 			eF32 p = (eF32)stream.ReadU8() / 100.0f;
 			synth.instr[j]->params[i] = p;
 		}
+
+		eTfInstrumentParamsChanged(*synth.instr[j]);
 	}
 
 	//  read song
@@ -144,6 +146,10 @@ void eTfPlayerUnloadSong(eTfPlayer &player)
 	{
 		player.song.events[i].clear();
 		player.song.instrCount = 0;
+
+		if (player.synth.instr[i])
+			eTfInstrumentFree(*player.synth.instr[i]);
+
 		eDelete(player.synth.instr[i]);
 	}
 }
@@ -169,57 +175,86 @@ void eTfPlayerProcess(eTfPlayer &player, const eS16 **output)
 	eTfSong &song = player.song;
 	eTfSynth &synth = player.synth;
 
-	for (eU32 j = 0; j < song.instrCount; j++)
+	eF32 *tempSignals[2];
+	tempSignals[0] = &player.tempSignal[0];
+	tempSignals[1] = &player.tempSignal[TF_FRAMESIZE];
+
+	eF32 *signals[2];
+	signals[0] = &player.outputSignal[0];
+	signals[1] = &player.outputSignal[TF_FRAMESIZE];
+
+	eMemSet(player.outputSignal, 0, sizeof(eF32)*TF_FRAMESIZE * 2);
+
+	//eU32 polyPhony = 0;
+	for (eU32 j = 0; j < TF_MAX_INSTR; j++)
 	{
-		if (player.instrumentMuted[j])
+		eTfInstrument *instr = synth.instr[j];
+
+		if (!instr)
 			continue;
 
-		eArray<eTfEvent> &events = song.events[j];
+		// the song's events go to the instrument with their sample offset
+		// into the frame, so notes start exactly where they were played
+		eU32 eventCount = 0;
+		eU32 overflow = 0;
 
-		for (eU32 i = 0; i < events.size(); i++)
+		if (j < song.instrCount && !player.instrumentMuted[j])
 		{
-			eTfEvent &ev = events[i];
+			eArray<eTfEvent> &events = song.events[j];
 
-			if (ev.time >= player.time && ev.time < nextTime)
+			for (eU32 i = 0; i < events.size(); i++)
 			{
-				if (ev.note && ev.instr >= 0)
-				{
-					eTfInstrument *instr = synth.instr[j];
+				eTfEvent &ev = events[i];
 
-					if (instr)
+				if (ev.time >= player.time && ev.time < nextTime && ev.note && ev.instr >= 0)
+				{
+					if (eventCount == TF_PLAYER_MAXEVENTS)
 					{
-						if (!ev.velocity)
-							eTfInstrumentNoteOff(*instr, ev.note);
-						else
-							eTfInstrumentNoteOn(*instr, ev.note, ev.velocity);
+						// out of room, it's played after the frame
+						if (!overflow)
+							overflow = i;
+						continue;
 					}
+
+					eU32 offset = eMin<eU32>(eFtoL((ev.time - player.time) * synth.sampleRate), TF_FRAMESIZE - 1);
+
+					if (eventCount > 0)
+						offset = eMax(offset, player.frameEvents[eventCount - 1].offset);
+
+					eTfInstrumentEvent &event = player.frameEvents[eventCount++];
+					event.offset = offset;
+					event.type = (ev.velocity ? eTfInstrumentEvent::NOTE_ON : eTfInstrumentEvent::NOTE_OFF);
+					event.index = ev.note;
+					event.velocity = ev.velocity;
+					event.value = event.value2 = 0.0f;
 				}
 			}
 		}
-	}
 
-	eF32 *tempSignals[2];
-	tempSignals[0] = &player.tempSignal[0];
-	tempSignals[1] = &player.tempSignal[TF_FRAMESIZE];
+		eMemSet(player.tempSignal, 0, sizeof(eF32)*TF_FRAMESIZE * 2);
+		eTfInstrumentProcess(synth, *instr, tempSignals, TF_FRAMESIZE, player.frameEvents, eventCount);
 
-	eF32 *signals[2];
-	signals[0] = &player.outputSignal[0];
-	signals[1] = &player.outputSignal[TF_FRAMESIZE];
-
-	eMemSet(player.outputSignal, 0, sizeof(eF32)*TF_FRAMESIZE * 2);
+		// events which didn't fit come after all queued ones,
+		// so they're played once the frame is rendered
+		if (overflow)
+		{
+			eArray<eTfEvent> &events = song.events[j];
 
-	//eU32 polyPhony = 0;
-	for (eU32 i = 0; i < TF_MAX_INSTR; i++)
-	{
-		eTfInstrument *instr = player.synth.instr[i];
+			for (eU32 i = overflow; i < events.size(); i++)
+			{
+				eTfEvent &ev = events[i];
 
-		if (instr)
-		{
-			eMemSet(player.tempSignal, 0, sizeof(eF32)*TF_FRAMESIZE * 2);
-			eTfInstrumentProcess(player.synth, *instr, tempSignals, TF_FRAMESIZE);
-			//polyPhony += eTfInstrumentGetPolyphony(*instr);
-			eTfSignalMix(signals, tempSignals, TF_FRAMESIZE, 1.0f);
+				if (ev.time >= player.time && ev.time < nextTime && ev.note && ev.instr >= 0)
+				{
+					if (!ev.velocity)
+						eTfInstrumentNoteOff(*instr, ev.note);
+					else
+						eTfInstrumentNoteOn(*instr, ev.note, ev.velocity);
+				}
+			}
 		}
+		//polyPhony += eTfInstrumentGetPolyphony(*instr);
+		eTfSignalMix(signals, tempSignals, TF_FRAMESIZE, 1.0f);
 	}
 
 	eTfSignalToS16(signals, player.outputFinal, 1000.0f * TF_MASTER_VOLUME * player.volume, TF_FRAMESIZE);
@@ -30,6 +30,8 @@ along with Tunefish.  If not, see <http://www.gnu.org/licenses/>.
 #include "../tunefish4/Source/synth/tf4.hpp"
 #endif
 
+const eU32 TF_PLAYER_MAXEVENTS = 256;   // per instrument and frame
+
 struct eTfPlayer
 {
 	eTfSong		song;
@@ -47,6 +49,7 @@ struct eTfPlayer
 	eF32		outputSignal[sizeof(eF32)*TF_FRAMESIZE * 2];
 	eF32		tempSignal[sizeof(eF32)*TF_FRAMESIZE * 2];
 	eS16		outputFinal[sizeof(eF32)*TF_FRAMESIZE];
+	eTfInstrumentEvent frameEvents[TF_PLAYER_MAXEVENTS];
 };
 
 void		eTfPlayerInit(eTfPlayer &player);